@@ -0,0 +1,367 @@
+/** @file bench.c */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "../include/asm2010.h"
+
+#define BENCH_NS_PER_SECOND 1000000000ull
+/** @brief Time each measurement runs for, at least */
+#define BENCH_MIN_NS (BENCH_NS_PER_SECOND / 4)
+/** @brief Instructions run between clock reads */
+#define BENCH_BATCH 65536ull
+/** @brief Instructions of a blockstep, at most */
+#define BENCH_BLOCK_INSTRUCTIONS 64
+/** @brief Clock cycles of a cs_run call */
+#define BENCH_RUN_CYCLES 4096
+/** @brief Lines of the generated assembly sources */
+#define BENCH_SOURCE_LINES 50000
+
+#define BENCH_ENGINE_MICROSTEP 0
+#define BENCH_ENGINE_FULLSTEP  1
+#define BENCH_ENGINE_BLOCKSTEP 2
+#define BENCH_ENGINE_RUN       3
+#define BENCH_ENGINES          4
+
+static char const *const bench_engine_names[BENCH_ENGINES] = {"microstep", "fullstep", "blockstep", "run"};
+
+/** @brief Synthetic program with a controlled instruction mix */
+struct bench_mix {
+    char const *name;
+    /** @brief Sources for CS2010 and CS3, which address memory differently */
+    char const *cs2010_source;
+    char const *cs3_source;
+};
+typedef struct bench_mix bench_mix;
+
+static bench_mix const bench_mixes[] = {
+    {
+        "mix-alu",
+        "loop: ADD R0, R1\nSUB R2, R0\nMOV R3, R2\nSUBI R4, 1\nCP R0, R3\nLDI R5, 7\nJMP loop\n",
+        "loop: ADD R0, R1\nSUB R2, R0\nMOV R3, R2\nSUBI R4, 1\nCP R0, R3\nLDI R5, 7\nJMP loop\n",
+    },
+    {
+        "mix-memory",
+        "LDI R1, 0x40\nloop: LD R0, (R1)\nST (R1), R0\nLDS R2, 0x41\nSTS 0x42, R2\nJMP loop\n",
+        "LDI R7, 0x40\nloop: LD R0, Z\nST Z, R0\nLDS R2, 0x41\nSTS 0x42, R2\nJMP loop\n",
+    },
+    {
+        "mix-branch",
+        "loop: SUBI R0, 1\nBRZS zero\nCP R0, R1\nBRLT less\nJMP loop\nless: JMP loop\nzero: LDI R0, 200\nJMP loop\n",
+        "loop: SUBI R0, 1\nBRZS zero\nCP R0, R1\nBRLT less\nJMP loop\nless: JMP loop\nzero: LDI R0, 200\nJMP loop\n",
+    },
+    {
+        "mix-call",
+        "loop: CALL f\nJMP loop\nf: CALL g\nRET\ng: RET\n",
+        "loop: CALL f\nJMP loop\nf: CALL g\nRET\ng: RET\n",
+    },
+};
+
+#define BENCH_MIXES (sizeof bench_mixes / sizeof *bench_mixes)
+
+/* Instructions the generated assembly sources cycle through */
+static char const *const bench_source_lines[] = {
+    "        LDI R1, 0x2A        ; load a constant\n",
+    "        ADD R0, R1\n",
+    "        SUBI R2, 1\n",
+    "        CP R0, R2\n",
+    "        BRZS label_%lu\n",
+    "        MOV R3, R0\n",
+    "        STS 0x10, R3\n",
+    "        JMP label_%lu\n",
+};
+
+#define BENCH_SOURCE_PATTERN (sizeof bench_source_lines / sizeof *bench_source_lines)
+
+/** @brief Whether a JSON record has been written to the current array */
+static int bench_has_records;
+
+/**
+ * @brief Reads the host monotonic clock
+ * @return Current time, in nanoseconds
+ */
+static unsigned long long bench_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long)counter.QuadPart / frequency.QuadPart * BENCH_NS_PER_SECOND +
+           (unsigned long long)counter.QuadPart % frequency.QuadPart * BENCH_NS_PER_SECOND / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * BENCH_NS_PER_SECOND + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+static char *bench_read_file(char const *path) {
+    FILE *file = fopen(path, "rb");
+    char *contents;
+    long  length;
+
+    if (!file) {
+        return 0;
+    }
+    if (fseek(file, 0, SEEK_END) || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET)) {
+        fclose(file);
+        return 0;
+    }
+    contents = malloc((size_t)length + 1);
+    if (contents && fread(contents, 1, (size_t)length, file) != (size_t)length) {
+        free(contents);
+        contents = 0;
+    }
+    if (contents) {
+        contents[length] = '\0';
+    }
+    fclose(file);
+    return contents;
+}
+
+static void bench_put_string(char const *text) {
+    putchar('"');
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            putchar('\\');
+        }
+        putchar(*text);
+    }
+    putchar('"');
+}
+
+static void bench_begin_record(void) {
+    printf(bench_has_records ? ",\n    {" : "\n    {");
+    bench_has_records = 1;
+}
+
+static char const *bench_platform_name(unsigned char platform) {
+    return platform == CS_PLATFORM_2010 ? "cs2010" : "cs3";
+}
+
+/**
+ * @brief Runs the loaded program with an engine for BENCH_MIN_NS at least,
+ *      restarting it whenever it stops
+ * @param cs Pointer to the emulation instance, with the program loaded
+ * @param engine BENCH_ENGINE_*
+ * @param instructions Pointer where the amount of instructions will be stored
+ * @return Elapsed time, in nanoseconds
+ */
+static unsigned long long bench_engine(struct cs_machine *cs, int engine, unsigned long long *instructions) {
+    unsigned long long start   = bench_now();
+    unsigned long long elapsed = 0;
+    unsigned long long done    = 0;
+    unsigned long long target;
+
+    cs_hard_reset(cs, 0);
+    while (elapsed < BENCH_MIN_NS) {
+        target = done + cs_get_instructions(cs) + BENCH_BATCH;
+        while (done + cs_get_instructions(cs) < target) {
+            switch (engine) {
+                case BENCH_ENGINE_MICROSTEP:
+                    cs_microstep(cs);
+                    break;
+                case BENCH_ENGINE_FULLSTEP:
+                    cs_fullstep(cs);
+                    break;
+                case BENCH_ENGINE_BLOCKSTEP:
+                    cs_blockstep(cs, BENCH_BLOCK_INSTRUCTIONS);
+                    break;
+                case BENCH_ENGINE_RUN:
+                default:
+                    cs_run(cs, BENCH_RUN_CYCLES);
+                    break;
+            }
+            if (cs_get_state_page(cs)[CS_STATE_PAGE_OFFSET_STOPPED]) {
+                done += cs_get_instructions(cs);
+                cs_hard_reset(cs, 0);
+            }
+        }
+        elapsed = bench_now() - start;
+    }
+
+    *instructions = done + cs_get_instructions(cs);
+    return elapsed;
+}
+
+/**
+ * @brief Benchmarks every engine on an assembly program, writing a record for each one
+ * @param name Name of the program
+ * @param source Assembly source
+ * @param platform CS platform
+ * @return 0 if success, 1 if the program can't be assembled or loaded
+ */
+static int bench_program(char const *name, char const *source, unsigned char platform) {
+    struct cs_as_parse_info *parsing_info = cs_as_parse_create();
+    struct cs_machine       *cs           = cs_create();
+    unsigned long long       instructions;
+    unsigned long long       elapsed;
+    int                      engine;
+    int                      result = 1;
+
+    if (!parsing_info || !cs || cs_init(cs, platform) != CS_INIT_OK ||
+        cs_as_parse_init(parsing_info, CS_ROM_SIZE, platform) != CS_AS_PARSE_INIT_OK ||
+        cs_as_parse_source(parsing_info, source, 1) == CS_AS_PARSE_ERROR ||
+        cs_as_parse_assemble(parsing_info, 1) == CS_AS_PARSE_ERROR ||
+        cs_load_machine_code(cs, cs_as_get_machine_code(parsing_info)) != CS_LOAD_OK) {
+        fprintf(stderr, "bench: skipping %s (%s)\n", name, bench_platform_name(platform));
+        goto end;
+    }
+
+    for (engine = 0; engine < BENCH_ENGINES; engine++) {
+        elapsed = bench_engine(cs, engine, &instructions);
+        bench_begin_record();
+        printf("\"platform\": \"%s\", \"program\": ", bench_platform_name(platform));
+        bench_put_string(name);
+        printf(", \"engine\": \"%s\", \"instructions\": %llu, \"seconds\": %.6f, \"instructions_per_second\": %.0f}",
+               bench_engine_names[engine], instructions, (double)elapsed / BENCH_NS_PER_SECOND,
+               (double)instructions * BENCH_NS_PER_SECOND / elapsed);
+    }
+    result = 0;
+
+end:
+    cs_as_parse_free(parsing_info);
+    cs_free(cs);
+    return result;
+}
+
+static int bench_file(char const *path, unsigned char platform) {
+    char       *source = bench_read_file(path);
+    char const *name   = path;
+    char const *separator;
+    int         result;
+
+    if (!source) {
+        fprintf(stderr, "bench: can't read %s\n", path);
+        return 1;
+    }
+    if ((separator = strrchr(name, '/')) || (separator = strrchr(name, '\\'))) {
+        name = separator + 1;
+    }
+    result = bench_program(name, source, platform);
+    free(source);
+    return result;
+}
+
+/**
+ * @brief Generates an assembly source with labels, comments, jumps and blank lines
+ * @param lines Amount of lines
+ * @return Pointer to the source, which must be freed, or null pointer if
+ *      no enough memory is available
+ */
+static char *bench_generate_source(unsigned long lines) {
+    char         *source = malloc(lines * 48 + 64);
+    size_t        length = 0;
+    unsigned long line;
+
+    if (!source) {
+        return 0;
+    }
+    for (line = 0; line < lines; line++) {
+        if (line % 16 == 0) {
+            length += sprintf(source + length, "label_%lu: LDI R4, 0x55\n", line / 16);
+        } else if (line % 16 == 15) {
+            length += sprintf(source + length, "\n");
+        } else {
+            /* Jumps target the next label */
+            length += sprintf(source + length, bench_source_lines[line % BENCH_SOURCE_PATTERN], line / 16 + 1);
+        }
+    }
+    length += sprintf(source + length, "label_%lu: STOP\n", (line + 15) / 16);
+    return source;
+}
+
+/**
+ * @brief Benchmarks cs_as_parse_source and cs_as_parse_assemble on a
+ *      generated source, writing a record
+ * @param platform CS platform
+ * @return 0 if success, 1 if no enough memory is available or assembling fails
+ */
+static int bench_assembler(unsigned char platform) {
+    char                    *source = bench_generate_source(BENCH_SOURCE_LINES);
+    struct cs_as_parse_info *parsing_info;
+    unsigned long long       lines   = 0;
+    unsigned long long       elapsed = 0;
+    unsigned long long       start;
+    int                      result = 0;
+
+    if (!source) {
+        return 1;
+    }
+
+    while (!result && elapsed < BENCH_MIN_NS) {
+        parsing_info = cs_as_parse_create();
+        if (!parsing_info || cs_as_parse_init(parsing_info, BENCH_SOURCE_LINES + 1, platform) != CS_AS_PARSE_INIT_OK) {
+            result = 1;
+        } else {
+            start = bench_now();
+            if (cs_as_parse_source(parsing_info, source, 1) == CS_AS_PARSE_ERROR ||
+                cs_as_parse_assemble(parsing_info, 1) == CS_AS_PARSE_ERROR) {
+                fprintf(stderr, "bench: %s", cs_as_parse_get_log(parsing_info));
+                result = 1;
+            }
+            elapsed += bench_now() - start;
+            lines += BENCH_SOURCE_LINES + 1;
+        }
+        cs_as_parse_free(parsing_info);
+    }
+    free(source);
+
+    if (!result) {
+        bench_begin_record();
+        printf("\"platform\": \"%s\", \"lines\": %llu, \"seconds\": %.6f, \"lines_per_second\": %.0f}",
+               bench_platform_name(platform), lines, (double)elapsed / BENCH_NS_PER_SECOND,
+               (double)lines * BENCH_NS_PER_SECOND / elapsed);
+    }
+    return result;
+}
+
+/**
+ * Usage: bench [--cs2010 | --cs3 | FILE]...
+ * Files are assembly programs for the platform of the last option given.
+ * Results are written to the standard output as JSON
+ */
+int main(int argc, char **argv) {
+    unsigned char platform = CS_PLATFORM_2010;
+    int           failures = 0;
+    int           i;
+    size_t        mix;
+
+    printf("{\n  \"emulator\": [");
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--cs2010")) {
+            platform = CS_PLATFORM_2010;
+        } else if (!strcmp(argv[i], "--cs3")) {
+            platform = CS_PLATFORM_3;
+        } else {
+            bench_file(argv[i], platform);
+        }
+    }
+    for (mix = 0; mix < BENCH_MIXES; mix++) {
+        failures += bench_program(bench_mixes[mix].name, bench_mixes[mix].cs2010_source, CS_PLATFORM_2010);
+        failures += bench_program(bench_mixes[mix].name, bench_mixes[mix].cs3_source, CS_PLATFORM_3);
+    }
+
+    printf("\n  ],\n  \"assembler\": [");
+    bench_has_records = 0;
+    failures += bench_assembler(CS_PLATFORM_2010);
+    failures += bench_assembler(CS_PLATFORM_3);
+    printf("\n  ]\n}\n");
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/** @file difftest.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/asm2010.h"
+
+/** @brief Programs run on each platform unless --programs is given */
+#define DIFFTEST_DEFAULT_PROGRAMS 20000ull
+
+static char const *const difftest_engine_names[] = {"fullstep", "blockstep", "run"};
+
+static char const *difftest_platform_name(unsigned char platform) {
+    return platform == CS_PLATFORM_2010 ? "cs2010" : "cs3";
+}
+
+/**
+ * @brief Names the state page member containing a byte
+ * @param offset Offset of the byte in the state page
+ * @return Name of the member
+ */
+static char const *difftest_offset_name(size_t offset) {
+    if (offset >= CS_STATE_PAGE_OFFSET_ROM) {
+        return "ROM";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_RAM) {
+        return "RAM";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_INSTRUCTIONS) {
+        return "instructions";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_CYCLES) {
+        return "cycles";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_IR_ADDR) {
+        return "IR address";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_PLATFORM) {
+        return "platform";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_STOPPED) {
+        return "stopped";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_MICROOP) {
+        return "microop";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_SIGNALS) {
+        return "signals";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_MAR) {
+        return "MAR";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_MDR) {
+        return "MDR";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_SR) {
+        return "SR";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_AC) {
+        return "AC";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_PC) {
+        return "PC";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_SP) {
+        return "SP";
+    } else if (offset >= CS_STATE_PAGE_OFFSET_R0) {
+        return "R0-R7";
+    }
+    return "IR";
+}
+
+/**
+ * @brief Prints a shrunk divergence: the engine, where it diverged, and
+ *      the program with its initial state
+ * @param divergence Pointer to the divergence
+ * @param platform CS platform
+ */
+static void difftest_print_divergence(struct cs_difftest_divergence *divergence, unsigned char platform) {
+    struct cs_difftest_program *program = &divergence->program;
+    char                       *disassembly;
+    size_t                      i;
+
+    printf("%s: %s diverged after %llu instructions, at state page offset %lu (%s)\n",
+           difftest_platform_name(platform), difftest_engine_names[divergence->engine], divergence->instruction,
+           (unsigned long)divergence->offset, difftest_offset_name(divergence->offset));
+
+    printf("registers:");
+    for (i = 0; i < 8; i++) {
+        printf(" R%lu=0x%02X", (unsigned long)i, program->registers[i]);
+    }
+    printf("\nRAM:");
+    for (i = 0; i < CS_RAM_SIZE; i++) {
+        if (program->ram[i]) {
+            printf(" [0x%02lX]=0x%02X", (unsigned long)i, program->ram[i]);
+        }
+    }
+    printf("\nchunk seed: %llu\nprogram:\n", program->seed);
+
+    disassembly = cs_as_disassemble_instructions(program->machine_instructions,
+                                                 program->machine_instructions_amount, platform);
+    if (disassembly) {
+        printf("%s\n", disassembly);
+        free(disassembly);
+    } else {
+        for (i = 0; i < program->machine_instructions_amount; i++) {
+            printf("    0x%04X\n", program->machine_instructions[i]);
+        }
+    }
+}
+
+/**
+ * @brief Runs the differential tester on a platform, reporting the result
+ * @param platform CS platform
+ * @param programs Amount of programs
+ * @param seed Seed of the pseudorandom programs
+ * @return CS_DIFFTEST_OK, CS_DIFFTEST_DIVERGED or CS_DIFFTEST_FAILED as cs_difftest_run does
+ */
+static int difftest_platform(unsigned char platform, unsigned long long programs, unsigned long long seed) {
+    static struct cs_difftest_divergence divergence;
+    unsigned long long                   instructions = 0;
+    clock_t                              start        = clock();
+    double                               seconds;
+    int                                  result;
+
+    result  = cs_difftest_run(platform, programs, seed, &divergence, &instructions);
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    switch (result) {
+        case CS_DIFFTEST_OK:
+            printf("%s: %llu programs, %llu reference instructions in %.2f s (%.0f instructions per second)\n",
+                   difftest_platform_name(platform), programs, instructions, seconds,
+                   seconds > 0 ? instructions / seconds : 0.0);
+            break;
+        case CS_DIFFTEST_DIVERGED:
+            difftest_print_divergence(&divergence, platform);
+            break;
+        case CS_DIFFTEST_FAILED:
+        default:
+            fprintf(stderr, "difftest: %s failed, no enough memory is available\n", difftest_platform_name(platform));
+            break;
+    }
+    return result;
+}
+
+/**
+ * Usage: difftest [--programs N] [--seed N]
+ * Runs the same random programs on CS2010 and CS3 with every engine.
+ * Exits with failure if any engine diverges from the microstepped reference
+ */
+int main(int argc, char **argv) {
+    unsigned long long programs = DIFFTEST_DEFAULT_PROGRAMS;
+    unsigned long long seed     = 1;
+    int                failures = 0;
+    int                i;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--programs") && i + 1 < argc) {
+            programs = strtoull(argv[++i], 0, 0);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], 0, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [--programs N] [--seed N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    failures += difftest_platform(CS_PLATFORM_2010, programs, seed) != CS_DIFFTEST_OK;
+    failures += difftest_platform(CS_PLATFORM_3, programs, seed) != CS_DIFFTEST_OK;
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
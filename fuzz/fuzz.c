@@ -0,0 +1,188 @@
+/** @file fuzz.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/asm2010.h"
+
+/** @brief Executions run on each program unless --executions is given */
+#define FUZZ_DEFAULT_EXECUTIONS 10000ull
+/** @brief Clock cycles after which an execution times out unless --max-cycles is given */
+#define FUZZ_DEFAULT_MAX_CYCLES 10000ull
+/** @brief Stack depth above which an execution fails unless --max-stack is given */
+#define FUZZ_DEFAULT_MAX_STACK 64
+
+static char const *const fuzz_outcome_names[] = {"ok", "timeout", "stack", "wrong output"};
+
+/** @brief Options shared by every program fuzzed */
+struct fuzz_options {
+    unsigned long long executions;
+    unsigned long long seed;
+    unsigned long long max_cycles;
+    unsigned char      max_stack_depth;
+    /** @brief RAM addresses served from the input tape */
+    unsigned char input_addresses[CS_RAM_SIZE / 8];
+};
+typedef struct fuzz_options fuzz_options;
+
+static char const *fuzz_platform_name(unsigned char platform) {
+    return platform == CS_PLATFORM_2010 ? "cs2010" : "cs3";
+}
+
+static char *fuzz_read_file(char const *path) {
+    FILE *file = fopen(path, "rb");
+    char *contents;
+    long  length;
+
+    if (!file) {
+        return 0;
+    }
+    if (fseek(file, 0, SEEK_END) || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET)) {
+        fclose(file);
+        return 0;
+    }
+    contents = malloc((size_t)length + 1);
+    if (contents && fread(contents, 1, (size_t)length, file) != (size_t)length) {
+        free(contents);
+        contents = 0;
+    }
+    if (contents) {
+        contents[length] = '\0';
+    }
+    fclose(file);
+    return contents;
+}
+
+/**
+ * @brief Prints a failing input: its outcome, where it ended, and the
+ *      registers, RAM and tape bytes that aren't zero
+ * @param failure Pointer to the failure
+ */
+static void fuzz_print_failure(struct cs_fuzz_failure const *failure) {
+    size_t i;
+
+    printf("  %s at 0x%02X (coverage 0x%016llX)\n    registers:", fuzz_outcome_names[failure->outcome],
+           failure->instruction_address, failure->coverage_hash);
+    for (i = 0; i < 8; i++) {
+        printf(" R%lu=0x%02X", (unsigned long)i, failure->input.registers[i]);
+    }
+    printf("\n    RAM:");
+    for (i = 0; i < CS_RAM_SIZE; i++) {
+        if (failure->input.ram[i]) {
+            printf(" [0x%02lX]=0x%02X", (unsigned long)i, failure->input.ram[i]);
+        }
+    }
+    printf("\n    tape:");
+    for (i = 0; i < CS_FUZZ_TAPE_SIZE; i++) {
+        printf(" %02X", failure->input.tape[i]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Assembles and loads an assembly program, and fuzzes it from its reset state
+ * @param path Path of the assembly source
+ * @param platform CS platform
+ * @param options Pointer to the options
+ */
+static void fuzz_file(char const *path, unsigned char platform, fuzz_options const *options) {
+    struct cs_as_parse_info      *parsing_info = cs_as_parse_create();
+    struct cs_machine            *cs           = cs_create();
+    struct cs_fuzz_failure const *failures;
+    char                         *source = fuzz_read_file(path);
+    clock_t                       start;
+    double                        seconds;
+    size_t                        failures_amount;
+    size_t                        corpus_amount;
+    size_t                        i;
+
+    if (!source || !parsing_info || !cs || cs_init(cs, platform) != CS_INIT_OK ||
+        cs_as_parse_init(parsing_info, CS_ROM_SIZE, platform) != CS_AS_PARSE_INIT_OK ||
+        cs_as_parse_source(parsing_info, source, 1) == CS_AS_PARSE_ERROR ||
+        cs_as_parse_assemble(parsing_info, 1) == CS_AS_PARSE_ERROR ||
+        cs_load_machine_code(cs, cs_as_get_machine_code(parsing_info)) != CS_LOAD_OK) {
+        fprintf(stderr, "fuzz: skipping %s (%s)\n", path, fuzz_platform_name(platform));
+        goto end;
+    }
+    if (!cs_fuzz_enable(cs, options->input_addresses, options->max_cycles, options->max_stack_depth,
+                        options->seed)) {
+        fprintf(stderr, "fuzz: can't fuzz %s (%s)\n", path, fuzz_platform_name(platform));
+        goto end;
+    }
+
+    start   = clock();
+    cs_fuzz_run(cs, options->executions, 0);
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    failures = cs_fuzz_get_failures(cs, &failures_amount);
+    cs_fuzz_get_corpus(cs, &corpus_amount);
+    printf("%s (%s): %llu executions in %.2f s (%.0f executions per second), %lu corpus inputs, %lu failures\n",
+           path, fuzz_platform_name(platform), options->executions, seconds,
+           seconds > 0 ? options->executions / seconds : 0.0, (unsigned long)corpus_amount,
+           (unsigned long)failures_amount);
+    for (i = 0; i < failures_amount; i++) {
+        fuzz_print_failure(&failures[i]);
+    }
+
+end:
+    free(source);
+    cs_as_parse_free(parsing_info);
+    cs_free(cs);
+}
+
+/**
+ * Usage: fuzz [--executions N] [--seed N] [--max-cycles N] [--max-stack N]
+ *             [--input ADDRESS]... [--cs2010 | --cs3 | FILE]...
+ * Files are assembly programs for the platform of the last option given,
+ * fuzzed with the options given before them. Failing inputs are reported
+ * but don't make it fail, since programs polling their input never stop.
+ * Programs that can't be assembled, such as error.asm, are skipped
+ */
+int main(int argc, char **argv) {
+    fuzz_options       options;
+    unsigned char      platform = CS_PLATFORM_2010;
+    unsigned long long value;
+    int                i;
+
+    memset(&options, 0, sizeof options);
+    options.executions      = FUZZ_DEFAULT_EXECUTIONS;
+    options.seed            = 1;
+    options.max_cycles      = FUZZ_DEFAULT_MAX_CYCLES;
+    options.max_stack_depth = FUZZ_DEFAULT_MAX_STACK;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--cs2010")) {
+            platform = CS_PLATFORM_2010;
+        } else if (!strcmp(argv[i], "--cs3")) {
+            platform = CS_PLATFORM_3;
+        } else if (!strcmp(argv[i], "--executions") && i + 1 < argc) {
+            options.executions = strtoull(argv[++i], 0, 0);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], 0, 0);
+        } else if (!strcmp(argv[i], "--max-cycles") && i + 1 < argc) {
+            options.max_cycles = strtoull(argv[++i], 0, 0);
+        } else if (!strcmp(argv[i], "--max-stack") && i + 1 < argc && (value = strtoull(argv[i + 1], 0, 0)) < 0xFF) {
+            options.max_stack_depth = (unsigned char)value;
+            i++;
+        } else if (!strcmp(argv[i], "--input") && i + 1 < argc && (value = strtoull(argv[i + 1], 0, 0)) < CS_RAM_SIZE) {
+            options.input_addresses[value / 8] |= 1u << (value % 8);
+            i++;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr,
+                    "Usage: %s [--executions N] [--seed N] [--max-cycles N] [--max-stack N] [--input ADDRESS]... "
+                    "[--cs2010 | --cs3 | FILE]...\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            fuzz_file(argv[i], platform, &options);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -142,8 +142,13 @@ ASM2010_API void cs_as_parse_free(struct cs_as_parse_info *parsing_info);
 #define CS_PLATFORM_2010 (1ul << 0)
 #define CS_PLATFORM_3    (1ul << 1)
 
+/* Opt-in platform flags, to be combined with a platform */
+#define CS_PLATFORM_INTERRUPTS (1ul << 2)
+
 #define CS_ROM_SIZE 256
 #define CS_RAM_SIZE 256
+/** @brief Amount of opcodes, as encoded in the 5 most significant bits of an instruction */
+#define CS_OPCODES_SIZE 32
 
 #define CS_SR_C_OFFSET 0
 #define CS_SR_Z_OFFSET 1
@@ -207,6 +212,10 @@ ASM2010_API void cs_as_parse_free(struct cs_as_parse_info *parsing_info);
 #define CS_IO_WRITE_NOT_CONTROLLED 0
 #define CS_IO_WRITE_CONTROLLED     1
 
+#define CS_ACCESS_NONE 0
+#define CS_ACCESS_RAM  1
+#define CS_ACCESS_IO   2
+
 #define CS_INIT_OK                0
 #define CS_INIT_NOT_ENOUGH_MEMORY 1
 #define CS_INIT_INVALID_PLATFORM  2
@@ -216,12 +225,63 @@ ASM2010_API void cs_as_parse_free(struct cs_as_parse_info *parsing_info);
 #define CS_LOAD_NOT_ENOUGH_ROM           2
 #define CS_LOAD_ROM_INVALID_INSTRUCTIONS 3
 
+#define CS_RUN_EXHAUSTED  0
+#define CS_RUN_STOPPED    1
+#define CS_RUN_BREAKPOINT 2
+#define CS_RUN_WATCHPOINT 3
+#define CS_RUN_CONDITION  4
+
+#define CS_WATCH_READ  (1u << 0)
+#define CS_WATCH_WRITE (1u << 1)
+
+#define CS_CONDITION_OK            0
+#define CS_CONDITION_FAILED        1
+#define CS_CONDITION_SYNTAX_ERROR  2
+#define CS_CONDITION_UNKNOWN_LABEL 3
+#define CS_CONDITION_TOO_COMPLEX   4
+
+#define CS_FUZZ_OK           0
+#define CS_FUZZ_TIMEOUT      1
+#define CS_FUZZ_STACK        2
+#define CS_FUZZ_WRONG_OUTPUT 3
+
+/** @brief Length of the input tape of a fuzzer input */
+#define CS_FUZZ_TAPE_SIZE 32
+
+#define CS_DIFFTEST_OK       0
+#define CS_DIFFTEST_DIVERGED 1
+#define CS_DIFFTEST_FAILED   2
+
+#define CS_DIFFTEST_FULLSTEP  0
+#define CS_DIFFTEST_BLOCKSTEP 1
+#define CS_DIFFTEST_RUN       2
+
+/* State page layout. Multi-byte fields are stored in the host byte order */
+#define CS_STATE_PAGE_OFFSET_REGISTERS    0
+#define CS_STATE_PAGE_OFFSET_IR           0
+#define CS_STATE_PAGE_OFFSET_R0           2
+#define CS_STATE_PAGE_OFFSET_SP           10
+#define CS_STATE_PAGE_OFFSET_PC           11
+#define CS_STATE_PAGE_OFFSET_AC           12
+#define CS_STATE_PAGE_OFFSET_SR           13
+#define CS_STATE_PAGE_OFFSET_MDR          14
+#define CS_STATE_PAGE_OFFSET_MAR          15
+#define CS_STATE_PAGE_OFFSET_SIGNALS      16
+#define CS_STATE_PAGE_OFFSET_MICROOP      20
+#define CS_STATE_PAGE_OFFSET_STOPPED      21
+#define CS_STATE_PAGE_OFFSET_PLATFORM     22
+#define CS_STATE_PAGE_OFFSET_IR_ADDR      23
+#define CS_STATE_PAGE_OFFSET_CYCLES       24
+#define CS_STATE_PAGE_OFFSET_INSTRUCTIONS 32
+#define CS_STATE_PAGE_OFFSET_RAM          40
+#define CS_STATE_PAGE_OFFSET_ROM          (CS_STATE_PAGE_OFFSET_RAM + CS_RAM_SIZE)
+#define CS_STATE_PAGE_SIZE                (CS_STATE_PAGE_OFFSET_ROM + 2 * CS_ROM_SIZE)
+
 typedef unsigned short cs_io_read_fn(unsigned char);
 typedef unsigned char  cs_io_write_fn(unsigned char, unsigned char);
 
-/** @brief CS registers */
+/** @brief CS registers. Holds no pointers, so it can be viewed as plain bytes */
 struct cs_registers {
-    unsigned char *regfile[8];
     unsigned short ir;
     unsigned char  r0;
     unsigned char  r1;
@@ -245,39 +305,300 @@ struct cs_memory {
     unsigned char  *ram;
 };
 
+/** @brief Consistent copy of the CS state, published for concurrent readers */
+struct cs_snapshot_state {
+    /** @brief Publication number (0 until the first publication) */
+    unsigned long publication;
+    /** @brief CS registers */
+    struct cs_registers registers;
+    /** @brief CS UC signals */
+    unsigned int signals;
+    /** @brief Current microoperation counter */
+    unsigned char microop;
+    /** @brief CS stop signal */
+    unsigned char stopped;
+    /** @brief CS RAM contents */
+    unsigned char ram[CS_RAM_SIZE];
+};
+
+/** @brief Output performed while batched I/O is enabled */
+struct cs_io_record {
+    /** @brief Value of the cycle counter when the output was performed */
+    unsigned long long cycle;
+    /** @brief Output address */
+    unsigned char address;
+    /** @brief Output value */
+    unsigned char value;
+};
+
+#define CS_TRACE_NO_REGISTER 0xFF
+
+#define CS_TRACE_RAM_WRITE (1u << 0)
+#define CS_TRACE_STOPPED   (1u << 1)
+
+/** @brief Fixed-width (12 bytes) record of the state after a traced step */
+struct cs_trace_record {
+    unsigned short ir;
+    unsigned char  pc;
+    unsigned char  sr;
+    unsigned char  ac;
+    /** @brief Microoperation counter */
+    unsigned char microop;
+    /** @brief Index of the general purpose register changed by the step,
+     *      or CS_TRACE_NO_REGISTER */
+    unsigned char changed_register;
+    /** @brief New value of the changed register */
+    unsigned char changed_register_value;
+    /** @brief Address of the last memory write of the step (valid with CS_TRACE_RAM_WRITE) */
+    unsigned char ram_address;
+    /** @brief Value of the last memory write of the step (valid with CS_TRACE_RAM_WRITE) */
+    unsigned char ram_value;
+    /** @brief CS_TRACE_* flags */
+    unsigned char flags;
+    unsigned char reserved;
+};
+
+/** @brief Call graph counters of a subroutine */
+struct cs_call_graph_entry {
+    /** @brief Amount of calls */
+    unsigned long long calls;
+    /** @brief Cycles spent in the subroutine, including its callees */
+    unsigned long long inclusive_cycles;
+    /** @brief Cycles spent in the subroutine, excluding its callees */
+    unsigned long long exclusive_cycles;
+};
+
+#define CS_TRACER_READ  (1u << 0)
+#define CS_TRACER_WRITE (1u << 1)
+
+/** @brief Fixed-width (8 bytes) record of an executed instruction */
+struct cs_tracer_record {
+    unsigned short ir;
+    /** @brief ROM address of the instruction */
+    unsigned char pc;
+    /** @brief Status register after the instruction */
+    unsigned char sr;
+    /** @brief CS_TRACER_READ and CS_TRACER_WRITE if the instruction accesses memory */
+    unsigned char flags;
+    /** @brief RAM or I/O address accessed, or 0 if flags is 0 */
+    unsigned char address;
+    /** @brief Byte read or written, as transferred to or from the device
+     *      for I/O addresses, or 0 if flags is 0 */
+    unsigned char value;
+    unsigned char reserved;
+};
+
+/** @brief Amount of opcodes, as encoded in the 5 most significant bits of an instruction */
+#define CS_COUNTERS_OPCODES 32
+/** @brief Amount of BRxx conditions, as encoded in the register A field of a BRxx instruction */
+#define CS_COUNTERS_CONDITIONS 8
+
+/** @brief Aggregate execution counters */
+struct cs_counters {
+    /** @brief Completed instructions by opcode */
+    unsigned long long instructions[CS_COUNTERS_OPCODES];
+    /** @brief BRxx instructions by condition, depending on whether the branch was taken */
+    unsigned long long branches_taken[CS_COUNTERS_CONDITIONS];
+    unsigned long long branches_not_taken[CS_COUNTERS_CONDITIONS];
+    /** @brief Memory accesses by address that reached RAM, including the stack */
+    unsigned long long ram_reads[CS_RAM_SIZE];
+    unsigned long long ram_writes[CS_RAM_SIZE];
+    /** @brief Memory accesses by address handled by an I/O device */
+    unsigned long long io_reads[CS_RAM_SIZE];
+    unsigned long long io_writes[CS_RAM_SIZE];
+    /** @brief Maximum stack depth reached at an instruction boundary, in bytes */
+    unsigned char max_stack_depth;
+};
+
+/** @brief Size of a coverage bitmap, bit i % 8 of byte i / 8 standing for ROM address i */
+#define CS_COVERAGE_BITMAP_SIZE (CS_ROM_SIZE / 8)
+
+/** @brief Instruction and branch coverage bitmaps */
+struct cs_coverage {
+    /** @brief ROM addresses of completed instructions */
+    unsigned char executed[CS_COVERAGE_BITMAP_SIZE];
+    /** @brief ROM addresses of BRxx instructions whose branch was taken */
+    unsigned char taken[CS_COVERAGE_BITMAP_SIZE];
+    /** @brief ROM addresses of BRxx instructions whose branch was not taken */
+    unsigned char not_taken[CS_COVERAGE_BITMAP_SIZE];
+};
+
+/** @brief Read of a RAM address that was never written */
+struct cs_uninit_read {
+    /** @brief ROM address of the instruction that read it */
+    unsigned char instruction_address;
+    /** @brief RAM address read */
+    unsigned char address;
+    /** @brief Completed instructions when it was first read */
+    unsigned long long instruction;
+};
+
+/** @brief Fuzzer input, applied over the state the fuzzer was enabled at */
+struct cs_fuzz_input {
+    /** @brief Initial R0-R7 */
+    unsigned char registers[8];
+    /** @brief Initial RAM contents */
+    unsigned char ram[CS_RAM_SIZE];
+    /** @brief Values served in order to the reads of the input addresses.
+     *      Reads past the end get 0 */
+    unsigned char tape[CS_FUZZ_TAPE_SIZE];
+};
+
+/** @brief Input that made an execution fail */
+struct cs_fuzz_failure {
+    /** @brief CS_FUZZ_TIMEOUT, CS_FUZZ_STACK or CS_FUZZ_WRONG_OUTPUT */
+    int outcome;
+    /** @brief ROM address of the instruction in IR when the execution ended */
+    unsigned char instruction_address;
+    /** @brief Hash of the instructions executed and the branches taken
+     *      and not taken by the execution */
+    unsigned long long coverage_hash;
+    /** @brief Failing input */
+    struct cs_fuzz_input input;
+};
+
+/** @brief Program run by the differential tester, with its initial state */
+struct cs_difftest_program {
+    /** @brief Machine instructions */
+    unsigned short machine_instructions[CS_ROM_SIZE];
+    size_t         machine_instructions_amount;
+    /** @brief Initial R0-R7 */
+    unsigned char registers[8];
+    /** @brief Initial RAM contents */
+    unsigned char ram[CS_RAM_SIZE];
+    /** @brief Seed of the amounts of instructions or cycles each engine runs at once */
+    unsigned long long seed;
+};
+
+/** @brief State of an engine that differs from the microstepped reference */
+struct cs_difftest_divergence {
+    /** @brief CS_DIFFTEST_FULLSTEP, CS_DIFFTEST_BLOCKSTEP or CS_DIFFTEST_RUN */
+    int engine;
+    /** @brief Instructions completed by the reference when the states were compared */
+    unsigned long long instruction;
+    /** @brief First differing byte of the state page (see CS_STATE_PAGE_OFFSET_*) */
+    size_t offset;
+    /** @brief Program that diverges */
+    struct cs_difftest_program program;
+};
+
+struct cs_machine;
+/** @brief Checks the state of a machine after a fuzzer execution. Returns
+ *      0 if the program produced a wrong output for the input */
+typedef unsigned char cs_fuzz_check_fn(struct cs_machine const *, struct cs_fuzz_input const *);
+
 struct cs_instruction_op;
+struct cs_accesses;
+struct cs_breakpoints;
+struct cs_clock;
+struct cs_counters;
+struct cs_coverage;
+struct cs_fuzz;
+struct cs_interrupts;
+struct cs_call_graph;
+struct cs_history;
+struct cs_io_log;
+struct cs_loops;
+struct cs_profiler;
+struct cs_snapshot;
+struct cs_trace_file;
+struct cs_tracer;
+struct cs_uninit;
+struct cs_vcd;
 
-/** @brief CS computer */
+/** @brief CS computer. The members up to rom form the state page, a
+ *      pointer-free block with the fixed layout described by the
+ *      CS_STATE_PAGE_OFFSET_* constants (see cs_get_state_page) */
 struct cs_machine {
-    /** @brief CS memory (RAM and ROM ) */
-    struct cs_memory memory;
     /** @brief CS registers */
     struct cs_registers registers;
     /** @brief CS UC signals */
-    unsigned long signals;
+    unsigned int signals;
+    /** @brief Current microoperation counter (starts at 0) */
+    unsigned char microop;
+    /** @brief CS stop signal */
+    unsigned char stopped;
+    /** @brief CS platform */
+    unsigned char platform;
+    /** @brief ROM address of the instruction in IR */
+    unsigned char instruction_address;
+    /** @brief Elapsed clock cycles, one per microoperation performed */
+    unsigned long long cycles;
+    /** @brief Completed instructions. Interrupt entries aren't counted */
+    unsigned long long instructions;
+    /** @brief CS RAM contents */
+    unsigned char ram[CS_RAM_SIZE];
+    /** @brief CS ROM contents */
+    unsigned short rom[CS_ROM_SIZE];
+    /** @brief CS memory (RAM and ROM ), pointing into the state page */
+    struct cs_memory memory;
+    /** @brief General purpose registers indexed by number (for internal use only) */
+    unsigned char *regfile[8];
     /** @brief I/O handlers */
     cs_io_read_fn  *io_read_fn;
     cs_io_write_fn *io_write_fn;
+    /** @brief Batched I/O state, replacing the I/O handlers when present (for internal use only) */
+    struct cs_io_log *io_log;
+    /** @brief Load-time classification of the memory accesses in ROM (for internal use only) */
+    struct cs_accesses *accesses;
+    /** @brief Counted loops fast-forwarded by cs_run (for internal use only) */
+    struct cs_loops *loops;
+    /** @brief Record of the step being traced by cs_run_traced (for internal use only) */
+    struct cs_trace_record *trace_record;
     /** @brief Opcode implementation (for internal use only) */
     struct cs_instruction_op const *opcodes;
-    /** @brief CS platform */
-    unsigned char platform;
-    /** @brief Current microoperation counter (starts at 0) */
-    unsigned char microop;
-    /** @brief CS stop signal */
-    unsigned char stopped;
+    /** @brief Clock cycles taken by the stepper of each opcode, counted from its signals (for internal use only) */
+    unsigned char opcode_cycles[CS_OPCODES_SIZE];
+    /** @brief Cycle at which scheduled events must be checked (for internal use only) */
+    unsigned long long next_event;
+    /** @brief Interrupt controller and event scheduler, only present when
+     *      CS_PLATFORM_INTERRUPTS is enabled (for internal use only) */
+    struct cs_interrupts *interrupts;
+    /** @brief Real-time clock pacing state (for internal use only) */
+    struct cs_clock *clock;
+    /** @brief Published state for concurrent readers (for internal use only) */
+    struct cs_snapshot *snapshot;
+    /** @brief Per-PC execution counters (for internal use only) */
+    struct cs_profiler *profiler;
+    /** @brief Shadow call stack and call path counters (for internal use only) */
+    struct cs_call_graph *call_graph;
+    /** @brief Execution trace ring buffer (for internal use only) */
+    struct cs_tracer *tracer;
+    /** @brief Streaming trace file writer (for internal use only) */
+    struct cs_trace_file *trace_file;
+    /** @brief Checkpoints and input log for reverse execution (for internal use only) */
+    struct cs_history *history;
+    /** @brief Breakpoint and watchpoint bitmaps, checked by cs_run when
+     *      present (for internal use only) */
+    struct cs_breakpoints *breakpoints;
+    /** @brief Aggregate execution counters (for internal use only) */
+    struct cs_counters *counters;
+    /** @brief Streaming waveform writer (for internal use only) */
+    struct cs_vcd *vcd;
+    /** @brief Instruction and branch coverage (for internal use only) */
+    struct cs_coverage *coverage;
+    /** @brief Uninitialized RAM read detection (for internal use only) */
+    struct cs_uninit *uninit;
+    /** @brief Coverage-guided fuzzer (for internal use only) */
+    struct cs_fuzz *fuzz;
 };
 
 /**
- * @brief Creates a new CS emulation instance
+ * @brief Creates a new CS emulation instance, to be initialized with cs_init
  * @return Pointer to a new CS emulation instance. It must be freed using cs_free
  */
 ASM2010_API struct cs_machine *cs_create();
 
 /**
- * @brief Initialize a given CS emulation instance
- * @param cs Pointer to the CS emulation instance
- * @param platform CS platform to initialize
+ * @brief Initialize a given CS emulation instance. It may be called again
+ *      on an initialized instance to change its platform: everything
+ *      allocated for the previous one is freed first, which disables every
+ *      observer (I/O log, profiler, tracer, coverage, fuzzer...), clears the
+ *      breakpoints and closes the trace and VCD files. If it fails, the
+ *      instance holds no allocations and only cs_init or cs_free may follow
+ * @param cs Pointer to the CS emulation instance, created by cs_create
+ * @param platform CS platform to initialize, optionally combined with
+ *      CS_PLATFORM_INTERRUPTS to add an interrupt controller and timer
  * @return CS_INIT_OK if success,
  *         CS_INIT_NOT_ENOUGH_MEMORY if no enough memory is available or
  *         CS_INIT_INVALID_PLATFORM if the specified platform is invalid
@@ -292,6 +613,90 @@ ASM2010_API int cs_init(struct cs_machine *cs, unsigned char platform);
 ASM2010_API
 void cs_set_io_functions(struct cs_machine *cs, cs_io_read_fn io_read_fn, cs_io_write_fn io_write_fn);
 
+/**
+ * @brief Sets the RAM addresses the I/O handlers may control. The LD, ST,
+ *      LDS and STS instructions proven at load time to always access
+ *      another address read and write RAM directly in cs_fullstep,
+ *      cs_blockstep and cs_run, without calling the I/O handlers.
+ *      cs_set_io_functions sets every address, or none if both handlers
+ *      are the default ones
+ * @param cs Pointer to the emulation instance
+ * @param addresses Bitmap of CS_RAM_SIZE bits, bit i % 8 of byte i / 8
+ *      for the address i, or null pointer for every address
+ */
+ASM2010_API void cs_set_io_addresses(struct cs_machine *cs, unsigned char const *addresses);
+
+/**
+ * @brief Gets the load-time classification of the memory access of an
+ *      instruction in ROM
+ * @param cs Pointer to the emulation instance
+ * @param address ROM address of the instruction
+ * @return CS_ACCESS_RAM if it is a LD, ST, LDS or STS proven to always
+ *         access the same address, which the I/O handlers don't control,
+ *         CS_ACCESS_IO if it is one which may reach the I/O handlers or
+ *         CS_ACCESS_NONE if it doesn't access memory
+ */
+ASM2010_API int cs_get_access_class(struct cs_machine const *cs, unsigned char address);
+
+/**
+ * @brief Enables batched I/O. While enabled, the I/O handlers are not
+ *      called: outputs to the controlled addresses are appended to a ring
+ *      buffer that the host drains periodically, other outputs write RAM,
+ *      and inputs are served from a shadow page that the host updates. Calling it again discards the previous
+ *      records, shadow page and controlled addresses
+ * @param cs Pointer to the emulation instance
+ * @param capacity Amount of records the ring buffer can hold. It will
+ *      be rounded up to a power of two
+ * @return 1 if success, 0 if no enough memory is available or the
+ *         capacity can't be rounded up to a power of two
+ */
+ASM2010_API unsigned char cs_io_log_enable(struct cs_machine *cs, size_t capacity);
+
+/**
+ * @brief Disables batched I/O, restoring the I/O handlers
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_io_log_disable(struct cs_machine *cs);
+
+/**
+ * @brief Gets the shadow page used to serve inputs. It has CS_RAM_SIZE
+ *      entries, which follow the same convention as the values returned
+ *      by cs_io_read_fn: CS_IO_READ_NOT_CONTROLLED (the default) reads
+ *      from RAM instead
+ * @param cs Pointer to the emulation instance
+ * @return Pointer to the shadow page, or null pointer if batched I/O
+ *         is not enabled
+ */
+ASM2010_API unsigned short *cs_io_log_get_shadow(struct cs_machine *cs);
+
+/**
+ * @brief Sets whether outputs to a given address are controlled by the
+ *      host, like cs_io_write_fn returning CS_IO_WRITE_CONTROLLED.
+ *      Only controlled outputs are recorded, and they don't reach RAM
+ * @param cs Pointer to the emulation instance
+ * @param address Output address
+ * @param controlled Whether the address is controlled
+ */
+ASM2010_API
+void cs_io_log_set_write_controlled(struct cs_machine *cs, unsigned char address, unsigned char controlled);
+
+/**
+ * @brief Moves the oldest output records to a given array
+ * @param cs Pointer to the emulation instance
+ * @param records Pointer to the array where records will be copied
+ * @param max_records Maximum amount of records to copy
+ * @return Amount of records copied
+ */
+ASM2010_API size_t cs_io_log_drain(struct cs_machine *cs, struct cs_io_record *records, size_t max_records);
+
+/**
+ * @brief Gets the amount of output records lost because the ring buffer
+ *      was full when they were performed
+ * @param cs Pointer to the emulation instance
+ * @return Amount of dropped records since batched I/O was enabled
+ */
+ASM2010_API size_t cs_io_log_get_dropped(struct cs_machine *cs);
+
 /**
  * @brief Clears the selected memories
  * @param cs Pointer to the emulation instance
@@ -313,6 +718,33 @@ ASM2010_API void cs_reset_registers(struct cs_machine *cs);
  */
 ASM2010_API void cs_free(struct cs_machine *cs);
 
+/**
+ * @brief Gets the state page of a given emulation instance. The engine
+ *      operates on it directly, so hosts can keep a view over it (such as
+ *      a typed array or a memoryview) instead of copying the state
+ * @param cs Pointer to the emulation instance
+ * @return Pointer to CS_STATE_PAGE_SIZE bytes laid out as described by
+ *      the CS_STATE_PAGE_OFFSET_* constants. It is valid until cs_free
+ */
+ASM2010_API unsigned char *cs_get_state_page(struct cs_machine *cs);
+
+/**
+ * @brief Gets the clock cycles elapsed since the last reset. Every
+ *      stepping function counts the cycles of the microoperations of each
+ *      instruction on the platform, so they can be compared across runs
+ * @param cs Pointer to the emulation instance
+ * @return Elapsed clock cycles
+ */
+ASM2010_API unsigned long long cs_get_cycles(struct cs_machine const *cs);
+
+/**
+ * @brief Gets the instructions completed since the last reset. Together
+ *      with cs_get_cycles it gives the average cycles per instruction
+ * @param cs Pointer to the emulation instance
+ * @return Completed instructions
+ */
+ASM2010_API unsigned long long cs_get_instructions(struct cs_machine const *cs);
+
 /**
  * @brief Loads CS machine code into the emulation instance
  * @param cs Pointer to the emulation instance
@@ -379,6 +811,125 @@ ASM2010_API void cs_fullstep(struct cs_machine *cs);
  */
 ASM2010_API unsigned char cs_blockstep(struct cs_machine *cs, size_t max_instructions);
 
+/**
+ * @brief Runs instructions until the machine stops or the given amount
+ *      of clock cycles elapses. Execution may end in the middle of an
+ *      instruction, which the next call will resume. If breakpoints or
+ *      watchpoints are set, it also stops before executing an instruction
+ *      with a breakpoint (except the first one, so a stopped run can be
+ *      resumed), after completing an instruction that hit a watchpoint,
+ *      or when a conditional breakpoint holds. Otherwise, counted loops
+ *      made of register arithmetic and stores, closed by a BRZS and a JMP,
+ *      are executed in closed form when nothing observes each instruction.
+ *      The state left is the same as running them one instruction at a time
+ * @param cs Pointer to the emulation instance
+ * @param max_cycles Maximum number of clock cycles to run
+ * @return CS_RUN_STOPPED if the machine stopped,
+ *         CS_RUN_BREAKPOINT if a breakpoint was reached,
+ *         CS_RUN_WATCHPOINT if a watchpoint was hit (see cs_watchpoint_get_hit),
+ *         CS_RUN_CONDITION if a conditional breakpoint held (see cs_condition_get_hit),
+ *         CS_RUN_EXHAUSTED if the cycle budget was exhausted
+ */
+ASM2010_API int cs_run(struct cs_machine *cs, unsigned long long max_cycles);
+
+/**
+ * @brief Performs several steps, writing a record of the state after
+ *      each one. It is equivalent to calling cs_fullstep (or cs_microstep)
+ *      and reading the registers after every call
+ * @param cs Pointer to the emulation instance
+ * @param steps Maximum number of steps to perform
+ * @param microsteps 1 to perform microsteps, 0 to perform fullsteps
+ * @param records Buffer with room for at least steps records
+ * @return Number of records written. It is less than steps only if the
+ *         machine stopped, in which case the last record has the
+ *         CS_TRACE_STOPPED flag
+ */
+ASM2010_API
+size_t cs_run_traced(struct cs_machine *cs, size_t steps, unsigned char microsteps, struct cs_trace_record *records);
+
+/**
+ * @brief Enables real-time pacing at a given CS clock frequency.
+ *      Instructions are executed in bursts, sleeping until the deadline
+ *      of each burst. Deadlines are computed from the elapsed cycles since
+ *      the pacing started, so oversleeping is corrected on the next burst.
+ *      Calling it again restarts pacing with the new parameters
+ * @param cs Pointer to the emulation instance
+ * @param frequency CS clock frequency, in Hz
+ * @param burst_period Time between bursts, in microseconds
+ * @return 1 if success, 0 if no enough memory is available or
+ *         frequency is 0
+ */
+ASM2010_API
+unsigned char cs_clock_enable(struct cs_machine *cs, unsigned long frequency, unsigned long burst_period);
+
+/**
+ * @brief Disables real-time pacing and frees its associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_clock_disable(struct cs_machine *cs);
+
+/**
+ * @brief Runs the emulation instance at the pacing frequency, blocking
+ *      the calling thread until the machine stops or the given amount
+ *      of clock cycles elapses. If the host falls behind by several
+ *      bursts (e.g. between two calls), pacing resynchronizes instead
+ *      of running the missed cycles at full speed
+ * @param cs Pointer to the emulation instance
+ * @param max_cycles Maximum number of clock cycles to run
+ * @return CS_RUN_STOPPED if the machine stopped, CS_RUN_BREAKPOINT,
+ *         CS_RUN_WATCHPOINT or CS_RUN_CONDITION as cs_run does, or CS_RUN_EXHAUSTED if the
+ *         cycle budget was exhausted or pacing is not enabled
+ */
+ASM2010_API int cs_clock_run(struct cs_machine *cs, unsigned long long max_cycles);
+
+/**
+ * @brief Enables or disables the acceptance of interrupts. Interrupts
+ *      raised meanwhile are kept pending. Enabled by default
+ * @param cs Pointer to the emulation instance
+ * @param enabled Whether interrupts are accepted
+ */
+ASM2010_API void cs_set_interrupts_enabled(struct cs_machine *cs, unsigned char enabled);
+
+/**
+ * @brief Requests an interrupt. At the next instruction boundary, if no
+ *      handler is running, the return address is pushed as a CALL would
+ *      and execution continues at the vector. SR is saved and restored
+ *      when the handler executes its RET. When several interrupts are
+ *      pending, lower vectors have priority
+ * @param cs Pointer to the emulation instance
+ * @param vector ROM address of the interrupt handler
+ * @return 1 if success, 0 if the platform has no interrupts
+ */
+ASM2010_API unsigned char cs_raise_interrupt(struct cs_machine *cs, unsigned char vector);
+
+/**
+ * @brief Schedules a one-shot interrupt request
+ * @param cs Pointer to the emulation instance
+ * @param delay Clock cycles from now until the request
+ * @param vector ROM address of the interrupt handler
+ * @return 1 if success, 0 if the platform has no interrupts or
+ *         too many events are scheduled
+ */
+ASM2010_API
+unsigned char cs_schedule_interrupt(struct cs_machine *cs, unsigned long long delay, unsigned char vector);
+
+/**
+ * @brief Starts the timer device, which requests an interrupt
+ *      periodically. Restarts it if it was already running
+ * @param cs Pointer to the emulation instance
+ * @param period Clock cycles between requests
+ * @param vector ROM address of the interrupt handler
+ * @return 1 if success, 0 if the platform has no interrupts,
+ *         period is 0 or too many events are scheduled
+ */
+ASM2010_API unsigned char cs_timer_start(struct cs_machine *cs, unsigned long long period, unsigned char vector);
+
+/**
+ * @brief Stops the timer device
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_timer_stop(struct cs_machine *cs);
+
 /**
  * @brief Performs a hard reset
  *      This includes clearing all the registers and
@@ -397,6 +948,620 @@ ASM2010_API void cs_hard_reset(struct cs_machine *cs, unsigned char clear_rom);
  */
 ASM2010_API void cs_soft_reset(struct cs_machine *cs);
 
+/**
+ * @brief Enables state publication for concurrent readers. The state
+ *      is published every given amount of completed instructions and
+ *      whenever cs_snapshot_publish is called. Calling it again only
+ *      updates the interval. Must not be called while readers are active
+ * @param cs Pointer to the emulation instance
+ * @param interval Amount of instructions between publications, or 0 to
+ *      only publish on demand
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_snapshot_enable(struct cs_machine *cs, size_t interval);
+
+/**
+ * @brief Disables state publication and frees its associated memory.
+ *      Must not be called while readers are active
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_snapshot_disable(struct cs_machine *cs);
+
+/**
+ * @brief Publishes the current state. Must be called from the thread
+ *      running the emulation instance
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_snapshot_publish(struct cs_machine *cs);
+
+/**
+ * @brief Copies the last published state. Safe to call from any thread
+ *      while the emulation instance keeps running
+ * @param cs Pointer to the emulation instance
+ * @param state Pointer to the struct where the state will be copied
+ * @return 1 if success, 0 if state publication is not enabled
+ */
+ASM2010_API unsigned char cs_snapshot_read(struct cs_machine const *cs, struct cs_snapshot_state *state);
+
+/**
+ * @brief Enables the per-PC profiler, which counts completed instructions
+ *      and clock cycles by ROM address. Calling it again keeps the counters
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_profiler_enable(struct cs_machine *cs);
+
+/**
+ * @brief Disables the per-PC profiler and frees its associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_profiler_disable(struct cs_machine *cs);
+
+/**
+ * @brief Resets the per-PC profiler counters
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_profiler_clear(struct cs_machine *cs);
+
+/**
+ * @brief Gets the completed instructions counted by ROM address
+ * @param cs Pointer to the emulation instance
+ * @return Pointer to CS_ROM_SIZE counters, or null pointer if the
+ *         profiler is not enabled
+ */
+ASM2010_API unsigned long long const *cs_profiler_get_instructions(struct cs_machine const *cs);
+
+/**
+ * @brief Gets the clock cycles counted by ROM address
+ * @param cs Pointer to the emulation instance
+ * @return Pointer to CS_ROM_SIZE counters, or null pointer if the
+ *         profiler is not enabled
+ */
+ASM2010_API unsigned long long const *cs_profiler_get_cycles(struct cs_machine const *cs);
+
+/**
+ * @brief Builds a text report of the profiler counters mapped to the source
+ *      lines of the loaded program: the hottest lines, the totals of each
+ *      label and an annotated listing. The returned string must be freed
+ *      by the caller
+ * @param cs Pointer to the emulation instance
+ * @param machine_code Machine code of the loaded program
+ * @param source Assembly source the machine code was assembled from
+ * @param max_hottest_lines Maximum amount of lines in the hottest lines section
+ * @return Pointer to a string containing the report if success,
+ *        null pointer otherwise
+ */
+ASM2010_API
+char *cs_profiler_report(struct cs_machine const *cs, struct cs_as_machine_code const *machine_code,
+                         char const *source, size_t max_hottest_lines);
+
+/**
+ * @brief Enables the call graph profiler. It follows CALL, RET and
+ *      interrupts in a shadow call stack, attributing cycles to each
+ *      subroutine entry address and to each call path. Calling it again
+ *      keeps the counters
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_call_graph_enable(struct cs_machine *cs);
+
+/**
+ * @brief Disables the call graph profiler and frees its associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_call_graph_disable(struct cs_machine *cs);
+
+/**
+ * @brief Resets the call graph profiler counters
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_call_graph_clear(struct cs_machine *cs);
+
+/**
+ * @brief Gets the call graph counters of every subroutine entry address.
+ *      Calls in progress are included up to the current cycle. The
+ *      program start counts as a subroutine entered on each reset
+ * @param cs Pointer to the emulation instance
+ * @param entries Array of CS_ROM_SIZE entries where the counters will be copied
+ * @return 1 if success, 0 if the call graph profiler is not enabled
+ */
+ASM2010_API unsigned char cs_call_graph_get_entries(struct cs_machine const *cs, struct cs_call_graph_entry *entries);
+
+/**
+ * @brief Exports the exclusive cycles of each call path in collapsed
+ *      stack format ("main;mult 27" per line), as used to build flame
+ *      graphs. The returned string must be freed by the caller
+ * @param cs Pointer to the emulation instance
+ * @param machine_code Machine code of the loaded program, or null pointer
+ *      to name subroutines by their entry address
+ * @param source Assembly source the machine code was assembled from, or
+ *      null pointer to name subroutines by their entry address
+ * @return Pointer to a string containing the export if success,
+ *        null pointer otherwise
+ */
+ASM2010_API
+char *cs_call_graph_export(struct cs_machine const *cs, struct cs_as_machine_code const *machine_code,
+                           char const *source);
+
+/**
+ * @brief Enables the execution tracer, which records every completed
+ *      instruction into a ring buffer, overwriting the oldest records.
+ *      The tracer is only available if the library was built with
+ *      ASM2010_TRACER. Calling it again drops the recorded trace
+ * @param cs Pointer to the emulation instance
+ * @param capacity Minimum amount of records kept (rounded up to a power of two)
+ * @return 1 if success, 0 if no enough memory is available, the capacity
+ *         can't be rounded up to a power of two, or the tracer was not built
+ */
+ASM2010_API unsigned char cs_tracer_enable(struct cs_machine *cs, size_t capacity);
+
+/**
+ * @brief Disables the execution tracer and frees its associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_tracer_disable(struct cs_machine *cs);
+
+/**
+ * @brief Drops the recorded trace
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_tracer_clear(struct cs_machine *cs);
+
+/**
+ * @brief Gets the amount of records written since the tracer was enabled
+ *      or cleared, including the ones already overwritten
+ * @param cs Pointer to the emulation instance
+ * @return Amount of records written
+ */
+ASM2010_API unsigned long long cs_tracer_get_total(struct cs_machine const *cs);
+
+/**
+ * @brief Copies the most recent records, oldest first
+ * @param cs Pointer to the emulation instance
+ * @param records Buffer where the records will be copied
+ * @param max_records Maximum amount of records to copy
+ * @return Amount of records copied
+ */
+ASM2010_API
+size_t cs_tracer_get_records(struct cs_machine const *cs, struct cs_tracer_record *records, size_t max_records);
+
+#define CS_TRACE_FILE_OK           0
+#define CS_TRACE_FILE_FAILED       1
+#define CS_TRACE_FILE_INVALID      2
+#define CS_TRACE_FILE_OUT_OF_RANGE 3
+
+/**
+ * @brief Starts streaming the execution to a trace file. Every completed
+ *      instruction is appended as a compact delta of the registers and RAM,
+ *      with a full keyframe every keyframe_interval instructions so that
+ *      cs_trace_file_seek doesn't need to replay the whole trace. Calling
+ *      it again closes the current trace file
+ * @param cs Pointer to the emulation instance
+ * @param path Path of the trace file, which is overwritten
+ * @param keyframe_interval Instructions between keyframes, greater than 0
+ * @return 1 if success, 0 if the file could not be written
+ */
+ASM2010_API unsigned char cs_trace_file_open(struct cs_machine *cs, char const *path, unsigned long keyframe_interval);
+
+/**
+ * @brief Stops streaming the execution and writes the keyframe index
+ * @param cs Pointer to the emulation instance
+ * @return 1 if the whole trace file was written, 0 otherwise
+ */
+ASM2010_API unsigned char cs_trace_file_close(struct cs_machine *cs);
+
+/**
+ * @brief Restores the state of a traced execution (ROM, registers, RAM,
+ *      cycle counter and stop signal) right after a given amount of
+ *      instructions had been completed
+ * @param cs Pointer to the emulation instance, of the traced platform
+ * @param path Path of a closed trace file
+ * @param instruction Amount of completed instructions (0 for the state
+ *      when the trace was opened)
+ * @return CS_TRACE_FILE_OK if success, CS_TRACE_FILE_FAILED if the file
+ *         could not be read (including offsets beyond what the C library
+ *         can seek to), CS_TRACE_FILE_INVALID if it isn't a closed
+ *         trace file of the platform, or CS_TRACE_FILE_OUT_OF_RANGE if
+ *         the trace is shorter
+ */
+ASM2010_API int cs_trace_file_seek(struct cs_machine *cs, char const *path, unsigned long long instruction);
+
+/**
+ * @brief Enables reverse execution. The state is checkpointed every
+ *      interval instructions, and every input read, whether each output
+ *      was claimed by a device and every interrupt raised, scheduled,
+ *      enabled or disabled by the host are logged, so that going
+ *      backwards restores the nearest checkpoint and replays forward from
+ *      it. The replay is silent: the I/O handlers, the batched I/O log and
+ *      the observers (counters, coverage, profiler, call graph, tracer,
+ *      trace and VCD files...) only see each instruction once. When the
+ *      budget is exhausted, every other checkpoint is dropped and the
+ *      interval doubled, and the logs are charged against it too, moving
+ *      the start of the history forward. Changing the interrupts from the
+ *      host while behind drops the history after the current instruction.
+ *      The history starts over on resets and loads, and calling it again
+ *      starts it over from the current state (which must be done after
+ *      changing the state other than by executing it)
+ * @param cs Pointer to the emulation instance
+ * @param interval Instructions between checkpoints, greater than 0
+ * @param budget Maximum amount of checkpoints kept, at least 2. The logs
+ *      are charged a checkpoint for about every CS_STATE_PAGE_SIZE bytes
+ *      they take
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_history_enable(struct cs_machine *cs, unsigned long interval, size_t budget);
+
+/**
+ * @brief Disables reverse execution and frees its associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_history_disable(struct cs_machine *cs);
+
+/**
+ * @brief Gets the amount of instructions completed since the history started
+ * @param cs Pointer to the emulation instance
+ * @return Amount of completed instructions
+ */
+ASM2010_API unsigned long long cs_history_get_instruction(struct cs_machine const *cs);
+
+/**
+ * @brief Goes back to the start of the current instruction if it is
+ *      partially executed, or to the start of the previous one otherwise.
+ *      Stepping forward afterwards replays the logged I/O and interrupt
+ *      changes silently, until the instruction where it went back from
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if the history is disabled, lost a log entry,
+ *         or is already at its start
+ */
+ASM2010_API unsigned char cs_reverse_step(struct cs_machine *cs);
+
+/**
+ * @brief Goes back to the last instruction boundary where the next
+ *      instruction to execute has a breakpoint, or to the start of the
+ *      history if there is none
+ * @param cs Pointer to the emulation instance
+ * @param breakpoints Bitmap of ROM addresses (CS_ROM_SIZE / 8 bytes,
+ *      bit i % 8 of byte i / 8 for address i), or null pointer to go
+ *      back to the start of the history
+ * @return 1 if a breakpoint was found, 0 otherwise
+ */
+ASM2010_API unsigned char cs_reverse_continue(struct cs_machine *cs, unsigned char const *breakpoints);
+
+/**
+ * @brief Sets or removes a breakpoint, where cs_run stops before
+ *      executing the instruction
+ * @param cs Pointer to the emulation instance
+ * @param address ROM address
+ * @param enabled Whether the breakpoint is set
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_breakpoint_set(struct cs_machine *cs, unsigned char address, unsigned char enabled);
+
+/**
+ * @brief Sets or removes a watchpoint, where cs_run stops after
+ *      completing an instruction that accesses the address
+ * @param cs Pointer to the emulation instance
+ * @param address RAM address
+ * @param flags CS_WATCH_READ and/or CS_WATCH_WRITE, or 0 to remove it
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_watchpoint_set(struct cs_machine *cs, unsigned char address, unsigned char flags);
+
+/**
+ * @brief Removes every breakpoint and watchpoint, so that cs_run
+ *      doesn't check them anymore
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_breakpoints_clear(struct cs_machine *cs);
+
+/**
+ * @brief Gets the watchpoint hit by the last cs_run returning CS_RUN_WATCHPOINT
+ * @param cs Pointer to the emulation instance
+ * @param address Pointer where the RAM address will be stored, or null pointer
+ * @return CS_WATCH_READ or CS_WATCH_WRITE, or 0 if no watchpoint was hit
+ */
+ASM2010_API unsigned char cs_watchpoint_get_hit(struct cs_machine const *cs, unsigned char *address);
+
+/**
+ * @brief Adds a conditional breakpoint, where cs_run stops after
+ *      completing an instruction if an expression holds. Expressions are
+ *      case-insensitive and made of:
+ *      - Numbers (decimal, 0x or $ hexadecimal, 0b binary) and labels
+ *      - Registers R0-R7, SP, PC, AC, SR, MDR, MAR, IR, and ADDR (the
+ *        ROM address of the next instruction to execute)
+ *      - Status flags SR.C, SR.Z, SR.N and SR.V
+ *      - RAM[address], and CHANGED(RAM[address]) for a constant address,
+ *        which holds if the content changed since the last evaluation
+ *      - Operators !, + and - (16-bit), &, ==, !=, <, <=, >, >=, && and ||,
+ *        and parentheses
+ *      An expression is only evaluated at the instruction addresses where
+ *      it may hold, e.g. "ADDR >= loop && ADDR < end && SR.Z", or only
+ *      after its RAM addresses are written if it doesn't read registers
+ * @param cs Pointer to the emulation instance
+ * @param expression Condition expression
+ * @param machine_code Machine code to resolve the labels, or null pointer
+ * @param source Assembly source of the machine code, or null pointer
+ * @param id Pointer where the identifier of the condition will be stored, or null pointer
+ * @return CS_CONDITION_OK if success, CS_CONDITION_FAILED if no enough
+ *         memory is available, CS_CONDITION_SYNTAX_ERROR if the expression
+ *         is invalid, CS_CONDITION_UNKNOWN_LABEL if a label isn't found, or
+ *         CS_CONDITION_TOO_COMPLEX if the expression is nested too deep
+ *         or has too many CHANGED terms
+ */
+ASM2010_API
+int cs_condition_add(struct cs_machine *cs, char const *expression, struct cs_as_machine_code const *machine_code,
+                     char const *source, size_t *id);
+
+/**
+ * @brief Removes a conditional breakpoint
+ * @param cs Pointer to the emulation instance
+ * @param id Identifier of the condition
+ * @return 1 if success, 0 if no such condition exists
+ */
+ASM2010_API unsigned char cs_condition_remove(struct cs_machine *cs, size_t id);
+
+/**
+ * @brief Gets the conditional breakpoint that held in the last cs_run returning CS_RUN_CONDITION
+ * @param cs Pointer to the emulation instance
+ * @param id Pointer where the identifier of the condition will be stored, or null pointer
+ * @return 1 if a condition held, 0 otherwise
+ */
+ASM2010_API unsigned char cs_condition_get_hit(struct cs_machine const *cs, size_t *id);
+
+/**
+ * @brief Enables the aggregate execution counters: instructions by opcode,
+ *      BRxx taken and not taken by condition, RAM and I/O accesses by
+ *      address, and maximum stack depth. Calling it again keeps the counters
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_counters_enable(struct cs_machine *cs);
+
+/**
+ * @brief Disables the aggregate execution counters and frees their associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_counters_disable(struct cs_machine *cs);
+
+/**
+ * @brief Resets the aggregate execution counters to zero
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_counters_clear(struct cs_machine *cs);
+
+/**
+ * @brief Copies the aggregate execution counters
+ * @param cs Pointer to the emulation instance
+ * @param counters Pointer where the counters will be copied
+ * @return 1 if success, 0 if the counters are not enabled
+ */
+ASM2010_API unsigned char cs_counters_get(struct cs_machine const *cs, struct cs_counters *counters);
+
+/**
+ * @brief Starts streaming a Value Change Dump of the control signals
+ *      (each CS_SIGNAL_* bit, and the ALU operation field on CS2010 or
+ *      the ALU signals on CS3) and PC, IR, AC, MAR and MDR, with one time
+ *      unit per clock cycle. Only the values changed by each
+ *      microoperation are written. While the dump is open, every stepping
+ *      function executes microoperation by microoperation. Calling it
+ *      again closes the current dump
+ * @param cs Pointer to the emulation instance
+ * @param path Path of the dump file, which is overwritten
+ * @return 1 if success, 0 if the file could not be written
+ */
+ASM2010_API unsigned char cs_vcd_open(struct cs_machine *cs, char const *path);
+
+/**
+ * @brief Stops streaming the Value Change Dump
+ * @param cs Pointer to the emulation instance
+ * @return 1 if the whole dump was written, 0 otherwise
+ */
+ASM2010_API unsigned char cs_vcd_close(struct cs_machine *cs);
+
+/**
+ * @brief Enables the coverage bitmaps: ROM addresses of completed
+ *      instructions, and taken and not taken outcomes of each BRxx
+ *      instruction. Calling it again keeps the bitmaps
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_coverage_enable(struct cs_machine *cs);
+
+/**
+ * @brief Disables the coverage bitmaps and frees their associated memory
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_coverage_disable(struct cs_machine *cs);
+
+/**
+ * @brief Clears the coverage bitmaps
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_coverage_clear(struct cs_machine *cs);
+
+/**
+ * @brief Copies the coverage bitmaps
+ * @param cs Pointer to the emulation instance
+ * @param coverage Pointer where the bitmaps will be copied
+ * @return 1 if success, 0 if the coverage is not enabled
+ */
+ASM2010_API unsigned char cs_coverage_get(struct cs_machine const *cs, struct cs_coverage *coverage);
+
+/**
+ * @brief Merges the coverage of another run of the same program, so that
+ *      an address is covered if it was covered by any of them
+ * @param coverage Pointer to the coverage merged into
+ * @param other Pointer to the coverage to merge
+ */
+ASM2010_API void cs_coverage_merge(struct cs_coverage *coverage, struct cs_coverage const *other);
+
+/**
+ * @brief Builds a text report of a coverage mapped to the source lines of
+ *      the program: the covered instructions and branch outcomes, and the
+ *      lines with instructions never executed or branches never taken or
+ *      never not taken. The returned string must be freed by the caller
+ * @param coverage Pointer to the coverage
+ * @param machine_code Machine code of the program
+ * @param source Assembly source the machine code was assembled from
+ * @return Pointer to a string containing the report if success,
+ *        null pointer otherwise
+ */
+ASM2010_API
+char *cs_coverage_report(struct cs_coverage const *coverage, struct cs_as_machine_code const *machine_code,
+                         char const *source);
+
+/**
+ * @brief Enables the detection of uninitialized RAM reads. A shadow
+ *      bitmap tracks the RAM addresses written since the RAM was last
+ *      cleared, and reads from RAM of any other address are reported,
+ *      once for each instruction and address. Inputs provided by I/O
+ *      devices aren't reported. Calling it again keeps the reports
+ * @param cs Pointer to the emulation instance
+ * @return 1 if success, 0 if no enough memory is available
+ */
+ASM2010_API unsigned char cs_uninit_enable(struct cs_machine *cs);
+
+/**
+ * @brief Disables the detection of uninitialized RAM reads and frees its
+ *      associated memory, including the reports
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_uninit_disable(struct cs_machine *cs);
+
+/**
+ * @brief Gets the uninitialized RAM reads reported, in the order they
+ *      first happened
+ * @param cs Pointer to the emulation instance
+ * @param amount Pointer where the amount of reads will be stored
+ * @return Pointer to the reads, valid until the next step or
+ *         cs_uninit_disable, or null pointer if there are none
+ */
+ASM2010_API struct cs_uninit_read const *cs_uninit_get_reads(struct cs_machine const *cs, size_t *amount);
+
+/**
+ * @brief Builds a text report of the uninitialized RAM reads with the
+ *      source line of each instruction. The returned string must be freed
+ *      by the caller
+ * @param cs Pointer to the emulation instance
+ * @param machine_code Machine code of the loaded program
+ * @param source Assembly source the machine code was assembled from
+ * @return Pointer to a string containing the report if success,
+ *        null pointer otherwise
+ */
+ASM2010_API
+char *cs_uninit_report(struct cs_machine const *cs, struct cs_as_machine_code const *machine_code,
+                       char const *source);
+
+/**
+ * @brief Enables the coverage-guided fuzzer for the loaded program. The
+ *      current state becomes the starting state of every execution, and
+ *      the first input of the corpus. Each execution restores it, applies
+ *      the registers and RAM of an input, and runs until the machine stops
+ *      or fails. Calling it again discards the corpus and failures
+ * @param cs Pointer to the emulation instance, at an instruction boundary
+ * @param input_addresses Bitmap of RAM addresses (CS_RAM_SIZE / 8 bytes,
+ *      bit i % 8 of byte i / 8 for address i) whose reads are served from
+ *      the input tape instead of the I/O handlers, or null pointer
+ * @param max_cycles Clock cycles after which an execution fails with CS_FUZZ_TIMEOUT
+ * @param max_stack_depth Stack depth in bytes (0xFF - SP) above which an
+ *      execution fails with CS_FUZZ_STACK, which catches runaway stack use
+ *      and stack underflows. It must be below 255
+ * @param seed Seed of the pseudorandom mutations
+ * @return 1 if success, 0 if max_stack_depth is 255 or no enough memory is available
+ */
+ASM2010_API unsigned char cs_fuzz_enable(struct cs_machine *cs, unsigned char const *input_addresses,
+                                         unsigned long long max_cycles, unsigned char max_stack_depth,
+                                         unsigned long long seed);
+
+/**
+ * @brief Disables the fuzzer and frees its associated memory, including
+ *      the corpus and failures. The machine keeps the state of the last execution
+ * @param cs Pointer to the emulation instance
+ */
+ASM2010_API void cs_fuzz_disable(struct cs_machine *cs);
+
+/**
+ * @brief Adds an input to the corpus, such as the input of a known test case
+ * @param cs Pointer to the emulation instance
+ * @param input Pointer to the input
+ * @return 1 if success, 0 if the fuzzer is not enabled or no enough memory is available
+ */
+ASM2010_API unsigned char cs_fuzz_add_input(struct cs_machine *cs, struct cs_fuzz_input const *input);
+
+/**
+ * @brief Runs mutations of the inputs of the corpus. Inputs reaching new
+ *      instruction or branch coverage (see cs_coverage_enable) are added to
+ *      the corpus. Timeouts and stack failures are recorded once for each
+ *      instruction address, and wrong outputs, which all end at a STOP,
+ *      once for each coverage (see cs_fuzz_failure.coverage_hash)
+ * @param cs Pointer to the emulation instance
+ * @param executions Amount of executions
+ * @param check Function checking the state after each execution that
+ *      stopped, or null pointer
+ * @return Amount of new failures recorded
+ */
+ASM2010_API size_t cs_fuzz_run(struct cs_machine *cs, unsigned long long executions, cs_fuzz_check_fn *check);
+
+/**
+ * @brief Runs a single input, leaving the machine in its final state, so
+ *      that a failure can be reproduced and inspected
+ * @param cs Pointer to the emulation instance
+ * @param input Pointer to the input
+ * @param check Function checking the state if the execution stopped, or null pointer
+ * @return CS_FUZZ_OK if the execution stopped and passed the check, or
+ *         the failure otherwise
+ */
+ASM2010_API int cs_fuzz_execute(struct cs_machine *cs, struct cs_fuzz_input const *input, cs_fuzz_check_fn *check);
+
+/**
+ * @brief Gets the corpus of inputs
+ * @param cs Pointer to the emulation instance
+ * @param amount Pointer where the amount of inputs will be stored
+ * @return Pointer to the inputs, valid until the next cs_fuzz_run or
+ *         cs_fuzz_add_input, or null pointer if the fuzzer is not enabled
+ */
+ASM2010_API struct cs_fuzz_input const *cs_fuzz_get_corpus(struct cs_machine const *cs, size_t *amount);
+
+/**
+ * @brief Gets the failing inputs found
+ * @param cs Pointer to the emulation instance
+ * @param amount Pointer where the amount of failures will be stored
+ * @return Pointer to the failures, valid until the next cs_fuzz_run, or
+ *         null pointer if there are none
+ */
+ASM2010_API struct cs_fuzz_failure const *cs_fuzz_get_failures(struct cs_machine const *cs, size_t *amount);
+
+/**
+ * @brief Runs random valid programs with microsteps, taken as the
+ *      reference, and with fullsteps, blocksteps and cs_run. The state page
+ *      of each engine is compared with the reference's whenever both have
+ *      completed the same instructions, which for fullsteps is after every
+ *      instruction. The first divergence found is shrunk to a minimal
+ *      program by dropping instructions and zeroing the initial state
+ * @param platform CS platform, as passed to cs_init
+ * @param programs Amount of programs
+ * @param seed Seed of the pseudorandom programs
+ * @param divergence Pointer where the shrunk divergence will be stored
+ * @param instructions Pointer where the amount of instructions run by the
+ *      reference will be stored, or null pointer
+ * @return CS_DIFFTEST_OK if every engine agreed,
+ *         CS_DIFFTEST_DIVERGED if an engine diverged or
+ *         CS_DIFFTEST_FAILED if the platform is invalid or no enough memory is available
+ */
+ASM2010_API int cs_difftest_run(unsigned char platform, unsigned long long programs, unsigned long long seed,
+                                struct cs_difftest_divergence *divergence, unsigned long long *instructions);
+
+/**
+ * @brief Runs a single program with every engine, such as a shrunk
+ *      divergence to check a fix
+ * @param platform CS platform, as passed to cs_init
+ * @param program Pointer to the program
+ * @param divergence Pointer where the divergence will be stored, if any
+ * @return CS_DIFFTEST_OK, CS_DIFFTEST_DIVERGED or CS_DIFFTEST_FAILED as cs_difftest_run does
+ */
+ASM2010_API int cs_difftest_execute(unsigned char platform, struct cs_difftest_program const *program,
+                                    struct cs_difftest_divergence *divergence);
+
 /**
  * @brief Stub method for I/O. Always returns data from memory
  *      Default I/O handler for CS instances
@@ -409,6 +1574,168 @@ ASM2010_API cs_io_read_fn cs_io_read_stub;
  */
 ASM2010_API cs_io_write_fn cs_io_write_stub;
 
+/* ANALYSIS */
+/** @brief Index standing for no block, loop or subroutine */
+#define CS_ANALYSIS_NONE 0xFFFFu
+/** @brief Cycles standing for no worst-case bound */
+#define CS_ANALYSIS_UNBOUNDED (~0ull)
+
+#define CS_ANALYSIS_BLOCK_REACHABLE (1u << 0)
+#define CS_ANALYSIS_BLOCK_CALL      (1u << 1)
+#define CS_ANALYSIS_BLOCK_RETURN    (1u << 2)
+#define CS_ANALYSIS_BLOCK_STOP      (1u << 3)
+
+/** @brief Basic block: instructions always executed in sequence, from
+ *      its leader to its last instruction */
+struct cs_analysis_block {
+    /** @brief Address of the leader */
+    unsigned char first;
+    /** @brief Address of the last instruction */
+    unsigned char last;
+    /** @brief CS_ANALYSIS_BLOCK_* flags. Blocks are reachable from the
+     *      entry of a subroutine */
+    unsigned char flags;
+    /** @brief Successor blocks: the next address (also after a CALL
+     *      returns), and the target of a JMP or BRxx. Successors outside
+     *      the program are CS_ANALYSIS_NONE */
+    unsigned short fallthrough;
+    unsigned short target;
+    /** @brief Subroutine the block belongs to, the first one reaching it
+     *      if several do, or CS_ANALYSIS_NONE */
+    unsigned short subroutine;
+    /** @brief Innermost loop containing the block, or CS_ANALYSIS_NONE */
+    unsigned short loop;
+    /** @brief Cycles of the instructions of the block, without the callee
+     *      of a CALL. Taking a BRxx costs one more */
+    unsigned short cycles;
+};
+
+/** @brief Natural loop, formed by the back edges to its header */
+struct cs_analysis_loop {
+    /** @brief Block every iteration starts at, which dominates the loop */
+    unsigned short header;
+    /** @brief Innermost loop containing this one, or CS_ANALYSIS_NONE */
+    unsigned short parent;
+    /** @brief Subroutine of the header */
+    unsigned short subroutine;
+    /** @brief Nesting depth, 1 for outermost loops */
+    unsigned char depth;
+    /** @brief Most times the header runs each time the loop is entered,
+     *      inferred from a counter updated by SUBI or ADDI and tested by a
+     *      BRxx leaving the loop, or 0 if unknown */
+    unsigned short bound;
+    /** @brief Worst-case cycles from entering the loop until leaving it,
+     *      or CS_ANALYSIS_UNBOUNDED */
+    unsigned long long wcet;
+    /** @brief Bitmap of the addresses of the instructions in the loop,
+     *      bit i % 8 of byte i / 8 for address i */
+    unsigned char body[CS_ROM_SIZE / 8];
+};
+
+/** @brief Subroutine: the program entry at address 0, or a CALL target */
+struct cs_analysis_subroutine {
+    /** @brief Address of the entry */
+    unsigned char entry;
+    /** @brief Block starting at the entry */
+    unsigned short block;
+    /** @brief Worst-case cycles from the entry until a RET or STOP,
+     *      callees included, or CS_ANALYSIS_UNBOUNDED */
+    unsigned long long wcet;
+};
+
+/** @brief Call site, an edge of the call graph */
+struct cs_analysis_call {
+    /** @brief Address of the CALL */
+    unsigned char address;
+    /** @brief Subroutine containing the CALL, or CS_ANALYSIS_NONE if unreachable */
+    unsigned short caller;
+    /** @brief Subroutine called, or CS_ANALYSIS_NONE if its target is outside the program */
+    unsigned short callee;
+};
+
+struct cs_analysis;
+
+/**
+ * @brief Analyzes the control flow of machine code: splits it into basic
+ *      blocks, finds the subroutines and the natural loops of each one, and
+ *      builds the call graph. Then estimates the worst-case cycles of the
+ *      loops and subroutines from the cycles of each instruction. Every
+ *      address of the program is taken as an instruction. Interrupts are
+ *      not accounted for, and each RET is taken to return after its CALL
+ * @param machine_instructions Pointer to the machine instructions
+ * @param machine_instructions_amount Amount of machine instructions
+ * @param platform CS platform which the machine instructions belong to
+ * @return Pointer to the analysis, which must be freed using
+ *      cs_analysis_free, or null pointer if the instructions don't fit in
+ *      ROM or belong to the platform, or no enough memory is available
+ */
+ASM2010_API
+struct cs_analysis *cs_analysis_create(unsigned short const *machine_instructions, size_t machine_instructions_amount,
+                                       unsigned char platform);
+
+/**
+ * @brief Frees an analysis
+ * @param analysis Pointer to the analysis
+ */
+ASM2010_API void cs_analysis_free(struct cs_analysis *analysis);
+
+/**
+ * @brief Gets the basic blocks, in address order
+ * @param analysis Pointer to the analysis
+ * @param amount Pointer where the amount of blocks will be stored
+ * @return Pointer to the blocks, valid until cs_analysis_free
+ */
+ASM2010_API struct cs_analysis_block const *cs_analysis_get_blocks(struct cs_analysis const *analysis, size_t *amount);
+
+/**
+ * @brief Gets the basic block containing an instruction
+ * @param analysis Pointer to the analysis
+ * @param address Address of the instruction
+ * @return Index of the block, or CS_ANALYSIS_NONE if the address is outside the program
+ */
+ASM2010_API unsigned short cs_analysis_get_block(struct cs_analysis const *analysis, unsigned char address);
+
+/**
+ * @brief Gets the natural loops, in the address order of their headers
+ * @param analysis Pointer to the analysis
+ * @param amount Pointer where the amount of loops will be stored
+ * @return Pointer to the loops, valid until cs_analysis_free
+ */
+ASM2010_API struct cs_analysis_loop const *cs_analysis_get_loops(struct cs_analysis const *analysis, size_t *amount);
+
+/**
+ * @brief Gets the subroutines. The first one is the program entry, and
+ *      the rest follow in the address order of their entries
+ * @param analysis Pointer to the analysis
+ * @param amount Pointer where the amount of subroutines will be stored
+ * @return Pointer to the subroutines, valid until cs_analysis_free
+ */
+ASM2010_API struct cs_analysis_subroutine const *cs_analysis_get_subroutines(struct cs_analysis const *analysis,
+                                                                            size_t                   *amount);
+
+/**
+ * @brief Gets the call sites, in address order
+ * @param analysis Pointer to the analysis
+ * @param amount Pointer where the amount of call sites will be stored
+ * @return Pointer to the call sites, valid until cs_analysis_free
+ */
+ASM2010_API struct cs_analysis_call const *cs_analysis_get_calls(struct cs_analysis const *analysis, size_t *amount);
+
+/**
+ * @brief Builds a text report of the worst-case cycles of an analysis
+ *      mapped to the source lines of the program: the worst-case cycles of
+ *      each subroutine and loop, and the cycles of each line along with the
+ *      most times it runs each time its subroutine is called
+ * @param analysis Pointer to the analysis
+ * @param machine_code Machine code of the program
+ * @param source Assembly source the machine code was assembled from
+ * @return Pointer to a string containing the report, which must be freed
+ *      by the caller, if success, null pointer otherwise
+ */
+ASM2010_API
+char *cs_analysis_wcet_report(struct cs_analysis const *analysis, struct cs_as_machine_code const *machine_code,
+                              char const *source);
+
 #ifdef __cplusplus
 }
 #endif
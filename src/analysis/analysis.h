@@ -0,0 +1,70 @@
+/** @file analysis.h */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <stddef.h>
+
+#include "../m2010/cs.h"
+#include "../m2010/cs_instructions.h"
+#include "../m2010/cs_platforms.h"
+
+#include "../utils.h"
+
+#include "../../include/asm2010.h"
+
+/** @brief Size of a bitmap with a bit for each block or address */
+#define AN_BITMAP_SIZE (CS_ROM_SIZE / 8)
+
+typedef struct cs_analysis            cs_analysis;
+typedef struct cs_analysis_block      cs_analysis_block;
+typedef struct cs_analysis_call       cs_analysis_call;
+typedef struct cs_analysis_loop       cs_analysis_loop;
+typedef struct cs_analysis_subroutine cs_analysis_subroutine;
+
+/** @brief Control flow analysis of a program */
+struct cs_analysis {
+    cs_platform    platform;
+    unsigned short machine_instructions[CS_ROM_SIZE];
+    size_t         machine_instructions_amount;
+    /** @brief Block containing each address */
+    unsigned short address_blocks[CS_ROM_SIZE];
+    cs_analysis_block blocks[CS_ROM_SIZE];
+    size_t            blocks_amount;
+    /** @brief Predecessors of block i are predecessors[predecessors_start[i]]
+     *      up to predecessors[predecessors_start[i + 1]] */
+    unsigned short predecessors_start[CS_ROM_SIZE + 1];
+    unsigned short predecessors[2 * CS_ROM_SIZE];
+    cs_analysis_loop loops[CS_ROM_SIZE];
+    /** @brief Bitmap of the blocks of each loop */
+    unsigned char loop_blocks[CS_ROM_SIZE][AN_BITMAP_SIZE];
+    size_t        loops_amount;
+    cs_analysis_subroutine subroutines[CS_ROM_SIZE];
+    size_t                 subroutines_amount;
+    cs_analysis_call       calls[CS_ROM_SIZE];
+    size_t                 calls_amount;
+};
+
+/**
+ * @brief Counts the bits set in a bitmap of AN_BITMAP_SIZE bytes
+ * @param bitmap Pointer to the bitmap
+ * @return Amount of bits set
+ */
+size_t an_bitmap_count(unsigned char const *bitmap);
+
+/**
+ * @brief Gets the opcodes of a platform
+ * @param platform CS platform
+ * @return Pointer to the opcodes, or null pointer if the platform is unknown
+ */
+cs_instruction_op const *an_get_opcodes(cs_platform platform);
+
+/**
+ * @brief Estimates the cycles of the blocks, and the worst-case cycles of
+ *      the loops and subroutines of an analysis with its control flow built
+ * @param analysis Pointer to the analysis
+ * @return true if success, false if no enough memory is available
+ */
+bool an_compute_wcet(cs_analysis *analysis);
+
+#endif /* ANALYSIS_H */
@@ -0,0 +1,495 @@
+/** @file analysis_cfg.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../m2010/cs.h"
+#include "../m2010/cs2010/cs2010_platform.h"
+#include "../m2010/cs3/cs3_platform.h"
+
+#include "analysis.h"
+
+/** @brief Working memory of the dominator and loop computations */
+struct an_scratch {
+    /** @brief Blocks reachable from the entry of the subroutine being analyzed */
+    unsigned char reachable[AN_BITMAP_SIZE];
+    /** @brief Dominators of each block */
+    unsigned char dominators[CS_ROM_SIZE][AN_BITMAP_SIZE];
+    /** @brief Blocks of the loop of each header, and the subroutine it was found in */
+    unsigned char  header_loops[CS_ROM_SIZE][AN_BITMAP_SIZE];
+    bool           is_header[CS_ROM_SIZE];
+    unsigned short header_subroutines[CS_ROM_SIZE];
+    unsigned short stack[2 * CS_ROM_SIZE];
+};
+typedef struct an_scratch an_scratch;
+
+size_t an_bitmap_count(unsigned char const *bitmap) {
+    size_t count = 0;
+    size_t i;
+
+    for (i = 0; i < AN_BITMAP_SIZE * 8; i++) {
+        if (BIT_TEST(bitmap, i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static bool an_is_subset(unsigned char const *subset, unsigned char const *bitmap) {
+    size_t i;
+
+    for (i = 0; i < AN_BITMAP_SIZE; i++) {
+        if (subset[i] & ~bitmap[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+cs_instruction_op const *an_get_opcodes(cs_platform platform) {
+    switch (CS_PLATFORM_BASE(platform)) {
+        case CS_PLATFORM_2010:
+            return cs2010_platform_opcodes;
+        case CS_PLATFORM_3:
+            return cs3_platform_opcodes;
+        default:
+            return 0;
+    }
+}
+
+static bool an_is_valid(cs_platform platform, unsigned short const *machine_instructions, size_t amount) {
+    cs_instruction_op const *opcodes = an_get_opcodes(platform);
+    size_t                   i;
+
+    if (!opcodes) {
+        return false;
+    }
+
+    for (i = 0; i < amount; i++) {
+        if (!opcodes[CS_GET_OPCODE(machine_instructions[i])].stepper ||
+            !opcodes[CS_GET_OPCODE(machine_instructions[i])].microstepper) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Gets the block at an address, or CS_ANALYSIS_NONE if it's outside the program */
+static unsigned short an_block_at(cs_analysis const *analysis, size_t address) {
+    return address < analysis->machine_instructions_amount ? analysis->address_blocks[address] : CS_ANALYSIS_NONE;
+}
+
+/**
+ * @brief Splits the program into basic blocks. Leaders are the entry, the
+ *      targets of JMP, BRxx and CALL, and the instructions following them
+ *      or a RET or STOP
+ * @param analysis Pointer to the analysis
+ */
+static void an_build_blocks(cs_analysis *analysis) {
+    size_t             amount = analysis->machine_instructions_amount;
+    bool               is_leader[CS_ROM_SIZE];
+    unsigned short     machine_instruction;
+    unsigned char      opcode;
+    cs_analysis_block *block = 0;
+    size_t             i;
+
+    memset(is_leader, 0, sizeof is_leader);
+    is_leader[0] = true;
+    for (i = 0; i < amount; i++) {
+        machine_instruction = analysis->machine_instructions[i];
+        opcode              = CS_GET_OPCODE(machine_instruction);
+        if (opcode == CS_INS_I_JMP || opcode == CS_INS_I_BRXX || opcode == CS_INS_I_CALL) {
+            if (CS_GET_ARG_B(machine_instruction) < amount) {
+                is_leader[CS_GET_ARG_B(machine_instruction)] = true;
+            }
+        } else if (opcode != CS_INS_I_RET && opcode != CS_INS_I_STOP) {
+            continue;
+        }
+        if (i + 1 < amount) {
+            is_leader[i + 1] = true;
+        }
+    }
+
+    for (i = 0; i < amount; i++) {
+        if (is_leader[i]) {
+            block              = &analysis->blocks[analysis->blocks_amount++];
+            block->first       = (unsigned char)i;
+            block->flags       = 0;
+            block->subroutine  = CS_ANALYSIS_NONE;
+            block->loop        = CS_ANALYSIS_NONE;
+            block->fallthrough = CS_ANALYSIS_NONE;
+            block->target      = CS_ANALYSIS_NONE;
+        }
+        block->last                 = (unsigned char)i;
+        analysis->address_blocks[i] = (unsigned short)(analysis->blocks_amount - 1);
+    }
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        block               = &analysis->blocks[i];
+        machine_instruction = analysis->machine_instructions[block->last];
+        /* PC wraps around at the end of ROM */
+        block->fallthrough = an_block_at(analysis, (block->last + 1u) % CS_ROM_SIZE);
+        switch (CS_GET_OPCODE(machine_instruction)) {
+            case CS_INS_I_JMP:
+                block->fallthrough = CS_ANALYSIS_NONE;
+                block->target      = an_block_at(analysis, CS_GET_ARG_B(machine_instruction));
+                break;
+            case CS_INS_I_BRXX:
+                block->target = an_block_at(analysis, CS_GET_ARG_B(machine_instruction));
+                break;
+            case CS_INS_I_CALL:
+                block->flags |= CS_ANALYSIS_BLOCK_CALL;
+                break;
+            case CS_INS_I_RET:
+                block->flags |= CS_ANALYSIS_BLOCK_RETURN;
+                block->fallthrough = CS_ANALYSIS_NONE;
+                break;
+            case CS_INS_I_STOP:
+                block->flags |= CS_ANALYSIS_BLOCK_STOP;
+                block->fallthrough = CS_ANALYSIS_NONE;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void an_build_predecessors(cs_analysis *analysis) {
+    unsigned short counts[CS_ROM_SIZE + 1];
+    size_t         i;
+
+    memset(counts, 0, sizeof counts);
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (analysis->blocks[i].fallthrough != CS_ANALYSIS_NONE) {
+            counts[analysis->blocks[i].fallthrough]++;
+        }
+        if (analysis->blocks[i].target != CS_ANALYSIS_NONE) {
+            counts[analysis->blocks[i].target]++;
+        }
+    }
+
+    analysis->predecessors_start[0] = 0;
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        analysis->predecessors_start[i + 1] = analysis->predecessors_start[i] + counts[i];
+        counts[i]                           = analysis->predecessors_start[i];
+    }
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (analysis->blocks[i].fallthrough != CS_ANALYSIS_NONE) {
+            analysis->predecessors[counts[analysis->blocks[i].fallthrough]++] = (unsigned short)i;
+        }
+        if (analysis->blocks[i].target != CS_ANALYSIS_NONE) {
+            analysis->predecessors[counts[analysis->blocks[i].target]++] = (unsigned short)i;
+        }
+    }
+}
+
+/** @brief Finds the subroutines: the program entry, then the CALL targets in address order */
+static void an_build_subroutines(cs_analysis *analysis) {
+    unsigned char is_entry[AN_BITMAP_SIZE];
+    size_t        i;
+
+    memset(is_entry, 0, sizeof is_entry);
+    BIT_SET(is_entry, 0);
+    for (i = 0; i < analysis->machine_instructions_amount; i++) {
+        if (CS_GET_OPCODE(analysis->machine_instructions[i]) == CS_INS_I_CALL &&
+            CS_GET_ARG_B(analysis->machine_instructions[i]) < analysis->machine_instructions_amount) {
+            BIT_SET(is_entry, CS_GET_ARG_B(analysis->machine_instructions[i]));
+        }
+    }
+
+    for (i = 0; i < analysis->machine_instructions_amount; i++) {
+        if (BIT_TEST(is_entry, i)) {
+            analysis->subroutines[analysis->subroutines_amount].entry   = (unsigned char)i;
+            analysis->subroutines[analysis->subroutines_amount++].block = analysis->address_blocks[i];
+        }
+    }
+}
+
+/**
+ * @brief Marks the blocks reachable from the entry of a subroutine,
+ *      without following calls, and assigns the unassigned ones to it
+ * @param analysis Pointer to the analysis
+ * @param scratch Pointer to the working memory
+ * @param subroutine Index of the subroutine
+ */
+static void an_visit_subroutine(cs_analysis *analysis, an_scratch *scratch, unsigned short subroutine) {
+    cs_analysis_block *block;
+    size_t             depth = 0;
+    unsigned short     index;
+
+    memset(scratch->reachable, 0, sizeof scratch->reachable);
+    index = analysis->subroutines[subroutine].block;
+    BIT_SET(scratch->reachable, index);
+    scratch->stack[depth++] = index;
+    while (depth) {
+        block = &analysis->blocks[scratch->stack[--depth]];
+        block->flags |= CS_ANALYSIS_BLOCK_REACHABLE;
+        if (block->subroutine == CS_ANALYSIS_NONE) {
+            block->subroutine = subroutine;
+        }
+        if (block->fallthrough != CS_ANALYSIS_NONE && !BIT_TEST(scratch->reachable, block->fallthrough)) {
+            BIT_SET(scratch->reachable, block->fallthrough);
+            scratch->stack[depth++] = block->fallthrough;
+        }
+        if (block->target != CS_ANALYSIS_NONE && !BIT_TEST(scratch->reachable, block->target)) {
+            BIT_SET(scratch->reachable, block->target);
+            scratch->stack[depth++] = block->target;
+        }
+    }
+}
+
+/**
+ * @brief Computes the dominators of the blocks reachable from the entry of
+ *      a subroutine, iterating until they don't change
+ * @param analysis Pointer to the analysis
+ * @param scratch Pointer to the working memory, with the reachable blocks
+ * @param entry Block at the entry of the subroutine
+ */
+static void an_compute_dominators(cs_analysis *analysis, an_scratch *scratch, unsigned short entry) {
+    unsigned char dominators[AN_BITMAP_SIZE];
+    bool          is_changed = true;
+    size_t        i;
+    size_t        j;
+    size_t        k;
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (BIT_TEST(scratch->reachable, i)) {
+            memcpy(scratch->dominators[i], scratch->reachable, AN_BITMAP_SIZE);
+        }
+    }
+    memset(scratch->dominators[entry], 0, AN_BITMAP_SIZE);
+    BIT_SET(scratch->dominators[entry], entry);
+
+    while (is_changed) {
+        is_changed = false;
+        for (i = 0; i < analysis->blocks_amount; i++) {
+            if (i == entry || !BIT_TEST(scratch->reachable, i)) {
+                continue;
+            }
+            memcpy(dominators, scratch->reachable, AN_BITMAP_SIZE);
+            for (j = analysis->predecessors_start[i]; j < analysis->predecessors_start[i + 1]; j++) {
+                if (BIT_TEST(scratch->reachable, analysis->predecessors[j])) {
+                    for (k = 0; k < AN_BITMAP_SIZE; k++) {
+                        dominators[k] &= scratch->dominators[analysis->predecessors[j]][k];
+                    }
+                }
+            }
+            BIT_SET(dominators, i);
+            if (memcmp(dominators, scratch->dominators[i], AN_BITMAP_SIZE)) {
+                memcpy(scratch->dominators[i], dominators, AN_BITMAP_SIZE);
+                is_changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Adds the natural loop of a back edge to the loop of its header,
+ *      which is every block reaching the tail without going through the header
+ * @param analysis Pointer to the analysis
+ * @param scratch Pointer to the working memory, with the reachable blocks
+ * @param tail Block the back edge goes from
+ * @param header Block the back edge goes to
+ * @param subroutine Index of the subroutine
+ */
+static void an_add_back_edge(cs_analysis *analysis, an_scratch *scratch, unsigned short tail, unsigned short header,
+                             unsigned short subroutine) {
+    unsigned char *body  = scratch->header_loops[header];
+    size_t         depth = 0;
+    unsigned short index;
+    size_t         i;
+
+    if (!scratch->is_header[header]) {
+        scratch->is_header[header]          = true;
+        scratch->header_subroutines[header] = subroutine;
+    }
+    BIT_SET(body, header);
+    if (BIT_TEST(body, tail)) {
+        return;
+    }
+    BIT_SET(body, tail);
+    scratch->stack[depth++] = tail;
+    while (depth) {
+        index = scratch->stack[--depth];
+        for (i = analysis->predecessors_start[index]; i < analysis->predecessors_start[index + 1]; i++) {
+            if (BIT_TEST(scratch->reachable, analysis->predecessors[i]) && !BIT_TEST(body, analysis->predecessors[i])) {
+                BIT_SET(body, analysis->predecessors[i]);
+                scratch->stack[depth++] = analysis->predecessors[i];
+            }
+        }
+    }
+}
+
+static void an_find_back_edges(cs_analysis *analysis, an_scratch *scratch, unsigned short subroutine) {
+    cs_analysis_block const *block;
+    size_t                   i;
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (!BIT_TEST(scratch->reachable, i)) {
+            continue;
+        }
+        block = &analysis->blocks[i];
+        if (block->fallthrough != CS_ANALYSIS_NONE && BIT_TEST(scratch->dominators[i], block->fallthrough)) {
+            an_add_back_edge(analysis, scratch, (unsigned short)i, block->fallthrough, subroutine);
+        }
+        if (block->target != CS_ANALYSIS_NONE && BIT_TEST(scratch->dominators[i], block->target)) {
+            an_add_back_edge(analysis, scratch, (unsigned short)i, block->target, subroutine);
+        }
+    }
+}
+
+/**
+ * @brief Lists the loops found in header order, and nests them: the
+ *      parent of a loop is the smallest loop strictly containing it
+ * @param analysis Pointer to the analysis
+ * @param scratch Pointer to the working memory, with the loops of each header
+ */
+static void an_build_loops(cs_analysis *analysis, an_scratch *scratch) {
+    cs_analysis_loop *loop;
+    size_t            sizes[CS_ROM_SIZE];
+    size_t            i;
+    size_t            j;
+    size_t            k;
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (!scratch->is_header[i]) {
+            continue;
+        }
+        loop             = &analysis->loops[analysis->loops_amount];
+        loop->header     = (unsigned short)i;
+        loop->parent     = CS_ANALYSIS_NONE;
+        loop->subroutine = scratch->header_subroutines[i];
+        memset(loop->body, 0, sizeof loop->body);
+        for (j = 0; j < analysis->blocks_amount; j++) {
+            if (BIT_TEST(scratch->header_loops[i], j)) {
+                for (k = analysis->blocks[j].first; k <= analysis->blocks[j].last; k++) {
+                    BIT_SET(loop->body, k);
+                }
+            }
+        }
+        memcpy(analysis->loop_blocks[analysis->loops_amount], scratch->header_loops[i], AN_BITMAP_SIZE);
+        sizes[analysis->loops_amount++] = an_bitmap_count(scratch->header_loops[i]);
+    }
+
+    for (i = 0; i < analysis->loops_amount; i++) {
+        for (j = 0; j < analysis->loops_amount; j++) {
+            if (sizes[j] > sizes[i] && an_is_subset(analysis->loop_blocks[i], analysis->loop_blocks[j]) &&
+                (analysis->loops[i].parent == CS_ANALYSIS_NONE || sizes[j] < sizes[analysis->loops[i].parent])) {
+                analysis->loops[i].parent = (unsigned short)j;
+            }
+        }
+    }
+
+    for (i = 0; i < analysis->loops_amount; i++) {
+        analysis->loops[i].depth = 1;
+        for (j = analysis->loops[i].parent; j != CS_ANALYSIS_NONE; j = analysis->loops[j].parent) {
+            analysis->loops[i].depth++;
+        }
+    }
+
+    /* The innermost loop of a block is the smallest one containing it */
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        for (j = 0; j < analysis->loops_amount; j++) {
+            if (BIT_TEST(analysis->loop_blocks[j], i) &&
+                (analysis->blocks[i].loop == CS_ANALYSIS_NONE || sizes[j] < sizes[analysis->blocks[i].loop])) {
+                analysis->blocks[i].loop = (unsigned short)j;
+            }
+        }
+    }
+}
+
+static void an_build_calls(cs_analysis *analysis) {
+    unsigned short    subroutine_entries[CS_ROM_SIZE];
+    unsigned short    machine_instruction;
+    cs_analysis_call *call;
+    size_t            i;
+
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        subroutine_entries[i] = CS_ANALYSIS_NONE;
+    }
+    for (i = 0; i < analysis->subroutines_amount; i++) {
+        subroutine_entries[analysis->subroutines[i].entry] = (unsigned short)i;
+    }
+
+    for (i = 0; i < analysis->machine_instructions_amount; i++) {
+        machine_instruction = analysis->machine_instructions[i];
+        if (CS_GET_OPCODE(machine_instruction) != CS_INS_I_CALL) {
+            continue;
+        }
+        call          = &analysis->calls[analysis->calls_amount++];
+        call->address = (unsigned char)i;
+        call->caller  = analysis->blocks[analysis->address_blocks[i]].subroutine;
+        call->callee  = subroutine_entries[CS_GET_ARG_B(machine_instruction)];
+    }
+}
+
+cs_analysis *cs_analysis_create(unsigned short const *machine_instructions, size_t machine_instructions_amount,
+                                unsigned char platform) {
+    cs_analysis   *analysis;
+    an_scratch    *scratch;
+    unsigned short i;
+
+    if (!machine_instructions || !machine_instructions_amount || machine_instructions_amount > CS_ROM_SIZE ||
+        !an_is_valid(platform, machine_instructions, machine_instructions_amount)) {
+        return 0;
+    }
+
+    analysis = calloc(1, sizeof *analysis);
+    scratch  = calloc(1, sizeof *scratch);
+    if (!analysis || !scratch) {
+        free(analysis);
+        free(scratch);
+        return 0;
+    }
+
+    analysis->platform                    = platform;
+    analysis->machine_instructions_amount = machine_instructions_amount;
+    memcpy(analysis->machine_instructions, machine_instructions,
+           machine_instructions_amount * sizeof *machine_instructions);
+
+    an_build_blocks(analysis);
+    an_build_predecessors(analysis);
+    an_build_subroutines(analysis);
+    for (i = 0; i < analysis->subroutines_amount; i++) {
+        an_visit_subroutine(analysis, scratch, i);
+        an_compute_dominators(analysis, scratch, analysis->subroutines[i].block);
+        an_find_back_edges(analysis, scratch, i);
+    }
+    an_build_loops(analysis, scratch);
+    an_build_calls(analysis);
+    free(scratch);
+
+    if (!an_compute_wcet(analysis)) {
+        free(analysis);
+        return 0;
+    }
+    return analysis;
+}
+
+void cs_analysis_free(cs_analysis *analysis) {
+    free(analysis);
+}
+
+cs_analysis_block const *cs_analysis_get_blocks(cs_analysis const *analysis, size_t *amount) {
+    *amount = analysis->blocks_amount;
+    return analysis->blocks;
+}
+
+unsigned short cs_analysis_get_block(cs_analysis const *analysis, unsigned char address) {
+    return an_block_at(analysis, address);
+}
+
+cs_analysis_loop const *cs_analysis_get_loops(cs_analysis const *analysis, size_t *amount) {
+    *amount = analysis->loops_amount;
+    return analysis->loops;
+}
+
+cs_analysis_subroutine const *cs_analysis_get_subroutines(cs_analysis const *analysis, size_t *amount) {
+    *amount = analysis->subroutines_amount;
+    return analysis->subroutines;
+}
+
+cs_analysis_call const *cs_analysis_get_calls(cs_analysis const *analysis, size_t *amount) {
+    *amount = analysis->calls_amount;
+    return analysis->calls;
+}
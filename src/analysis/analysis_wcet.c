@@ -0,0 +1,799 @@
+/** @file analysis_wcet.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "../m2010/cs.h"
+#include "../m2010/cs_opcodes.h"
+#include "../m2010/cs_profiler.h"
+#include "../m2010/cs_report.h"
+
+#include "analysis.h"
+
+/** @brief Cycles of a longest path standing for no path at all */
+#define AN_NO_PATH (CS_ANALYSIS_UNBOUNDED - 1)
+
+#define AN_UNVISITED 0
+#define AN_VISITING  1
+#define AN_VISITED   2
+
+/** @brief Working memory of the worst-case estimation */
+struct an_wcet {
+    cs_instruction_op const *opcodes;
+    /** @brief Clock cycles taken by each opcode, a taken BRxx taking one more */
+    unsigned char opcode_cycles[CS_OPCODES_SIZE];
+    /** @brief Subroutine called by the CALL at each address, or CS_ANALYSIS_NONE */
+    unsigned short callees[CS_ROM_SIZE];
+    /** @brief Blocks reachable from the entry of each subroutine, without following calls */
+    unsigned char reachable[CS_ROM_SIZE][AN_BITMAP_SIZE];
+    /** @brief Registers each subroutine and its callees may write, a bit for each */
+    unsigned char written[CS_ROM_SIZE];
+    unsigned char subroutine_states[CS_ROM_SIZE];
+    unsigned char loop_states[CS_ROM_SIZE];
+    /** @brief Longest paths from each node of the region being estimated to
+     *      a back edge to its header, and out of the region */
+    unsigned long long to_latch[CS_ROM_SIZE];
+    unsigned long long to_leave[CS_ROM_SIZE];
+    unsigned char      node_states[CS_ROM_SIZE];
+    /** @brief Subroutine whose blocks are the region being estimated, if it isn't a loop */
+    unsigned short subroutine;
+    unsigned short stack[2 * CS_ROM_SIZE];
+};
+typedef struct an_wcet an_wcet;
+
+static unsigned long long an_add(unsigned long long a, unsigned long long b) {
+    if (a == AN_NO_PATH || b == AN_NO_PATH) {
+        return AN_NO_PATH;
+    }
+    if (a == CS_ANALYSIS_UNBOUNDED || b == CS_ANALYSIS_UNBOUNDED || b >= AN_NO_PATH - a) {
+        return CS_ANALYSIS_UNBOUNDED;
+    }
+    return a + b;
+}
+
+static unsigned long long an_multiply(unsigned long long times, unsigned long long cycles) {
+    if (!times) {
+        return 0;
+    }
+    if (times == CS_ANALYSIS_UNBOUNDED || cycles >= AN_NO_PATH || cycles > (AN_NO_PATH - 1) / times) {
+        return CS_ANALYSIS_UNBOUNDED;
+    }
+    return times * cycles;
+}
+
+/** @brief Gets the longest of two paths, either of which may be AN_NO_PATH */
+static unsigned long long an_max(unsigned long long a, unsigned long long b) {
+    if (a == AN_NO_PATH) {
+        return b;
+    }
+    if (b == AN_NO_PATH) {
+        return a;
+    }
+    return a > b ? a : b;
+}
+
+/**
+ * @brief Lists the edges leaving a block. A RET or STOP has none
+ * @param analysis Pointer to the analysis
+ * @param block Index of the block
+ * @param successors Pointer where the successor blocks will be stored,
+ *      CS_ANALYSIS_NONE for leaving the program
+ * @param extra_cycles Pointer where the cycles of taking each edge will be stored
+ * @return Amount of edges
+ */
+static size_t an_get_edges(cs_analysis const *analysis, unsigned short block, unsigned short *successors,
+                           unsigned char *extra_cycles) {
+    cs_analysis_block const *data = &analysis->blocks[block];
+
+    switch (CS_GET_OPCODE(analysis->machine_instructions[data->last])) {
+        case CS_INS_I_RET:
+        case CS_INS_I_STOP:
+            return 0;
+        case CS_INS_I_JMP:
+            successors[0]   = data->target;
+            extra_cycles[0] = 0;
+            return 1;
+        case CS_INS_I_BRXX:
+            successors[0]   = data->fallthrough;
+            extra_cycles[0] = 0;
+            successors[1]   = data->target;
+            extra_cycles[1] = 1;
+            return 2;
+        default:
+            successors[0]   = data->fallthrough;
+            extra_cycles[0] = 0;
+            return 1;
+    }
+}
+
+/** @brief Gets the subroutine called by the CALL at an address, or CS_ANALYSIS_NONE */
+static unsigned short an_get_callee(cs_analysis const *analysis, size_t address) {
+    size_t i;
+
+    for (i = 0; i < analysis->calls_amount; i++) {
+        if (analysis->calls[i].address == address) {
+            return analysis->calls[i].callee;
+        }
+    }
+    return CS_ANALYSIS_NONE;
+}
+
+/** @brief Gets the registers an instruction may write, a bit for each */
+static unsigned char an_get_written(cs_analysis const *analysis, an_wcet const *wcet, size_t address) {
+    unsigned short machine_instruction = analysis->machine_instructions[address];
+
+    switch (CS_GET_OPCODE(machine_instruction)) {
+        case CS_INS_I_ST:
+        case CS_INS_I_STS:
+        case CS_INS_I_RET:
+        case CS_INS_I_BRXX:
+        case CS_INS_I_JMP:
+        case CS_INS_I_CP:
+        case CS_INS_I_CPI:
+        case CS_INS_I_CLC:
+        case CS_INS_I_SEC:
+        case CS_INS_I_STOP:
+            return 0;
+        case CS_INS_I_CALL:
+            return wcet->callees[address] == CS_ANALYSIS_NONE ? 0xFFu : wcet->written[wcet->callees[address]];
+        default:
+            if (wcet->opcodes[CS_GET_OPCODE(machine_instruction)].stepper == cs_op_noop_stepper) {
+                return 0;
+            }
+            return (unsigned char)(1u << CS_GET_REG_A(machine_instruction));
+    }
+}
+
+/**
+ * @brief Marks the blocks reachable from a subroutine entry, without following calls
+ * @param analysis Pointer to the analysis
+ * @param wcet Pointer to the working memory
+ * @param subroutine Index of the subroutine
+ */
+static void an_reach(cs_analysis const *analysis, an_wcet *wcet, unsigned short subroutine) {
+    unsigned char *reachable = wcet->reachable[subroutine];
+    unsigned short successors[2];
+    unsigned char  extra_cycles[2];
+    size_t         depth = 0;
+    size_t         edges;
+    size_t         i;
+
+    BIT_SET(reachable, analysis->subroutines[subroutine].block);
+    wcet->stack[depth++] = analysis->subroutines[subroutine].block;
+    while (depth) {
+        edges = an_get_edges(analysis, wcet->stack[--depth], successors, extra_cycles);
+        for (i = 0; i < edges; i++) {
+            if (successors[i] != CS_ANALYSIS_NONE && !BIT_TEST(reachable, successors[i])) {
+                BIT_SET(reachable, successors[i]);
+                wcet->stack[depth++] = successors[i];
+            }
+        }
+    }
+}
+
+/** @brief Finds the registers written by each subroutine, iterating until they don't change */
+static void an_build_written(cs_analysis const *analysis, an_wcet *wcet) {
+    cs_analysis_block const *block;
+    unsigned char            written;
+    bool                     is_changed = true;
+    size_t                   i;
+    size_t                   j;
+    size_t                   k;
+
+    while (is_changed) {
+        is_changed = false;
+        for (i = 0; i < analysis->subroutines_amount; i++) {
+            written = wcet->written[i];
+            for (j = 0; j < analysis->blocks_amount; j++) {
+                if (!BIT_TEST(wcet->reachable[i], j)) {
+                    continue;
+                }
+                block = &analysis->blocks[j];
+                for (k = block->first; k <= block->last; k++) {
+                    written |= an_get_written(analysis, wcet, k);
+                }
+            }
+            if (written != wcet->written[i]) {
+                wcet->written[i] = written;
+                is_changed       = true;
+            }
+        }
+    }
+}
+
+/** @brief Gets the cycles of a block, including the worst case of its callee */
+static unsigned long long an_block_cycles(cs_analysis const *analysis, an_wcet const *wcet, unsigned short block) {
+    cs_analysis_block const *data = &analysis->blocks[block];
+    unsigned short           callee;
+
+    if (!(data->flags & CS_ANALYSIS_BLOCK_CALL)) {
+        return data->cycles;
+    }
+    callee = wcet->callees[data->last];
+    if (callee == CS_ANALYSIS_NONE || wcet->subroutine_states[callee] != AN_VISITED) {
+        /* The callee is outside the program, or recursive */
+        return CS_ANALYSIS_UNBOUNDED;
+    }
+    return an_add(data->cycles, analysis->subroutines[callee].wcet);
+}
+
+/**
+ * @brief Gets the node of a region a block belongs to: the outermost loop
+ *      inside the region containing it, or the block itself
+ * @param analysis Pointer to the analysis
+ * @param region Loop whose body is the region, or CS_ANALYSIS_NONE for a subroutine
+ * @param block Index of the block
+ * @return Index of the loop, or CS_ANALYSIS_NONE if the block is a node by itself
+ */
+static unsigned short an_node_loop(cs_analysis const *analysis, unsigned short region, unsigned short block) {
+    unsigned short loop = analysis->blocks[block].loop;
+
+    if (loop == region) {
+        return CS_ANALYSIS_NONE;
+    }
+    while (loop != CS_ANALYSIS_NONE && analysis->loops[loop].parent != region) {
+        loop = analysis->loops[loop].parent;
+    }
+    return loop;
+}
+
+/**
+ * @brief Gets the cycles after a RET or STOP ends a path of the region being
+ *      estimated: none, unless a RET returns from the program entry to an
+ *      unknown address
+ */
+static unsigned long long an_end_cycles(cs_analysis const *analysis, an_wcet const *wcet, unsigned short region,
+                                        unsigned short block) {
+    if (region == CS_ANALYSIS_NONE && !wcet->subroutine &&
+        CS_GET_OPCODE(analysis->machine_instructions[analysis->blocks[block].last]) == CS_INS_I_RET) {
+        return CS_ANALYSIS_UNBOUNDED;
+    }
+    return 0;
+}
+
+static void an_visit_node(cs_analysis const *analysis, an_wcet *wcet, unsigned short region, unsigned short node);
+
+/**
+ * @brief Follows an edge of the region being estimated, updating the
+ *      longest paths of the node it leaves from
+ * @param analysis Pointer to the analysis
+ * @param wcet Pointer to the working memory
+ * @param region Loop whose body is the region, or CS_ANALYSIS_NONE for a subroutine
+ * @param successor Block the edge goes to, or CS_ANALYSIS_NONE if it leaves the program
+ * @param extra_cycles Cycles of taking the edge
+ * @param to_latch Pointer to the longest path to a back edge to the header
+ * @param to_leave Pointer to the longest path out of the region
+ */
+static void an_follow_edge(cs_analysis const *analysis, an_wcet *wcet, unsigned short region, unsigned short successor,
+                           unsigned char extra_cycles, unsigned long long *to_latch, unsigned long long *to_leave) {
+    unsigned short loop;
+    unsigned short node;
+
+    /* ROM past the program runs on for good */
+    if (successor == CS_ANALYSIS_NONE) {
+        *to_leave = CS_ANALYSIS_UNBOUNDED;
+        return;
+    }
+    if (region != CS_ANALYSIS_NONE) {
+        if (successor == analysis->loops[region].header) {
+            *to_latch = an_max(*to_latch, extra_cycles);
+            return;
+        }
+        if (!BIT_TEST(analysis->loop_blocks[region], successor)) {
+            *to_leave = an_max(*to_leave, extra_cycles);
+            return;
+        }
+    }
+
+    loop = an_node_loop(analysis, region, successor);
+    node = loop == CS_ANALYSIS_NONE ? successor : analysis->loops[loop].header;
+    if (wcet->node_states[node] == AN_VISITING) {
+        /* A cycle which isn't a natural loop */
+        *to_latch = CS_ANALYSIS_UNBOUNDED;
+        *to_leave = CS_ANALYSIS_UNBOUNDED;
+        return;
+    }
+    if (wcet->node_states[node] == AN_UNVISITED) {
+        an_visit_node(analysis, wcet, region, node);
+    }
+    *to_latch = an_max(*to_latch, an_add(extra_cycles, wcet->to_latch[node]));
+    *to_leave = an_max(*to_leave, an_add(extra_cycles, wcet->to_leave[node]));
+}
+
+/**
+ * @brief Computes the longest paths from a node of the region being
+ *      estimated. Loops inside the region are single nodes costing their
+ *      worst case, left through any of their exits
+ * @param analysis Pointer to the analysis
+ * @param wcet Pointer to the working memory
+ * @param region Loop whose body is the region, or CS_ANALYSIS_NONE for a subroutine
+ * @param node Block of the node, the header if it's a loop
+ */
+static void an_visit_node(cs_analysis const *analysis, an_wcet *wcet, unsigned short region, unsigned short node) {
+    unsigned long long to_latch = AN_NO_PATH;
+    unsigned long long to_leave = AN_NO_PATH;
+    unsigned long long cycles;
+    unsigned short     loop = an_node_loop(analysis, region, node);
+    unsigned short     successors[2];
+    unsigned char      extra_cycles[2];
+    size_t             edges;
+    size_t             i;
+    size_t             j;
+
+    wcet->node_states[node] = AN_VISITING;
+    if (loop == CS_ANALYSIS_NONE) {
+        cycles = an_block_cycles(analysis, wcet, node);
+        edges  = an_get_edges(analysis, node, successors, extra_cycles);
+        if (!edges) {
+            to_leave = an_end_cycles(analysis, wcet, region, node);
+        }
+        for (i = 0; i < edges; i++) {
+            an_follow_edge(analysis, wcet, region, successors[i], extra_cycles[i], &to_latch, &to_leave);
+        }
+    } else {
+        /* The exits of the loop take their extra cycles within its worst case */
+        cycles = analysis->loops[loop].wcet;
+        for (i = 0; i < analysis->blocks_amount; i++) {
+            if (!BIT_TEST(analysis->loop_blocks[loop], i)) {
+                continue;
+            }
+            edges = an_get_edges(analysis, (unsigned short)i, successors, extra_cycles);
+            if (!edges) {
+                to_leave = an_max(to_leave, an_end_cycles(analysis, wcet, region, (unsigned short)i));
+            }
+            for (j = 0; j < edges; j++) {
+                if (successors[j] == CS_ANALYSIS_NONE || !BIT_TEST(analysis->loop_blocks[loop], successors[j])) {
+                    an_follow_edge(analysis, wcet, region, successors[j], 0, &to_latch, &to_leave);
+                }
+            }
+        }
+    }
+
+    /* Reaching an unbounded node is unbounded, even if there's no path out of it */
+    if (cycles == CS_ANALYSIS_UNBOUNDED) {
+        to_latch = 0;
+        to_leave = 0;
+    }
+    wcet->to_latch[node]    = an_add(cycles, to_latch);
+    wcet->to_leave[node]    = an_add(cycles, to_leave);
+    wcet->node_states[node] = AN_VISITED;
+}
+
+/**
+ * @brief Checks whether every iteration of a loop runs a block: no back edge
+ *      to the header can be reached from it without going through the block
+ * @param analysis Pointer to the analysis
+ * @param wcet Pointer to the working memory
+ * @param loop Index of the loop
+ * @param block Index of the block
+ * @return true if every iteration runs the block, false otherwise
+ */
+static bool an_is_unavoidable(cs_analysis const *analysis, an_wcet *wcet, unsigned short loop, unsigned short block) {
+    unsigned short header = analysis->loops[loop].header;
+    unsigned char  visited[AN_BITMAP_SIZE];
+    unsigned short successors[2];
+    unsigned char  extra_cycles[2];
+    size_t         depth = 0;
+    size_t         edges;
+    size_t         i;
+
+    if (block == header) {
+        return true;
+    }
+    memset(visited, 0, sizeof visited);
+    BIT_SET(visited, header);
+    BIT_SET(visited, block);
+    wcet->stack[depth++] = header;
+    while (depth) {
+        edges = an_get_edges(analysis, wcet->stack[--depth], successors, extra_cycles);
+        for (i = 0; i < edges; i++) {
+            if (successors[i] == header) {
+                return false;
+            }
+            if (successors[i] != CS_ANALYSIS_NONE && BIT_TEST(analysis->loop_blocks[loop], successors[i]) &&
+                !BIT_TEST(visited, successors[i])) {
+                BIT_SET(visited, successors[i]);
+                wcet->stack[depth++] = successors[i];
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the counter update of an instruction: the amount a SUBI or
+ *      ADDI adds to its register, modulo 256
+ * @return true if the instruction is a counter update, false otherwise
+ */
+static bool an_get_update(cs_analysis const *analysis, unsigned short machine_instruction, unsigned char *step) {
+    switch (CS_GET_OPCODE(machine_instruction)) {
+        case CS_INS_I_SUBI:
+            *step = (unsigned char)(0x100u - CS_GET_ARG_B(machine_instruction));
+            return true;
+        case CS_INS_I_ADDI:
+            if (CS_PLATFORM_BASE(analysis->platform) != CS_PLATFORM_2010) {
+                return false;
+            }
+            *step = (unsigned char)CS_GET_ARG_B(machine_instruction);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Finds the value of a register when entering a loop, if it's
+ *      loaded by a LDI in the only block entering the loop from outside
+ * @return true if the value was found, false otherwise
+ */
+static bool an_get_initial_value(cs_analysis const *analysis, an_wcet const *wcet, unsigned short loop,
+                                 unsigned char reg, unsigned char *value) {
+    unsigned short header    = analysis->loops[loop].header;
+    unsigned short preheader = CS_ANALYSIS_NONE;
+    unsigned short machine_instruction;
+    size_t         i;
+
+    for (i = analysis->predecessors_start[header]; i < analysis->predecessors_start[header + 1]; i++) {
+        if (!BIT_TEST(analysis->loop_blocks[loop], analysis->predecessors[i])) {
+            if (preheader != CS_ANALYSIS_NONE) {
+                return false;
+            }
+            preheader = analysis->predecessors[i];
+        }
+    }
+    if (preheader == CS_ANALYSIS_NONE) {
+        return false;
+    }
+
+    for (i = analysis->blocks[preheader].last + 1u; i-- > analysis->blocks[preheader].first;) {
+        if (an_get_written(analysis, wcet, i) & (1u << reg)) {
+            machine_instruction = analysis->machine_instructions[i];
+            if (CS_GET_OPCODE(machine_instruction) != CS_INS_I_LDI) {
+                return false;
+            }
+            *value = (unsigned char)CS_GET_ARG_B(machine_instruction);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Counts the iterations until a counter equals a value
+ * @param initial Value of the counter when entering the loop
+ * @param step Amount added each iteration
+ * @param value Value making the loop exit
+ * @param is_updated_first Whether the counter is updated before being tested
+ * @return Iterations, or 0 if the counter never equals the value
+ */
+static unsigned short an_count_iterations(unsigned char initial, unsigned char step, unsigned char value,
+                                          bool is_updated_first) {
+    unsigned char  counter = is_updated_first ? (unsigned char)(initial + step) : initial;
+    unsigned short i;
+
+    for (i = 1; i <= CS_ROM_SIZE; i++) {
+        if (counter == value) {
+            return i;
+        }
+        counter = (unsigned char)(counter + step);
+    }
+    return 0;
+}
+
+/**
+ * @brief Infers the bound of a loop from a BRZS leaving it, when the Z flag
+ *      comes from either a SUBI or ADDI updating a counter right before, or a
+ *      CPI of a counter updated once each iteration. The counter must not be
+ *      written anywhere else in the loop or its callees
+ * @param analysis Pointer to the analysis
+ * @param wcet Pointer to the working memory
+ * @param loop Index of the loop
+ * @return Most times the header runs each time the loop is entered, or 0 if unknown
+ */
+static unsigned short an_infer_bound(cs_analysis const *analysis, an_wcet *wcet, unsigned short loop) {
+    cs_analysis_block const *block;
+    unsigned short           bound = 0;
+    unsigned short           iterations;
+    unsigned short           after;
+    unsigned short           machine_instruction;
+    unsigned short           update = 0;
+    size_t                   writes;
+    bool                     is_compared;
+    unsigned char            reg;
+    unsigned char            step = 0;
+    unsigned char            value;
+    unsigned char            initial;
+    size_t                   i;
+    size_t                   j;
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        block               = &analysis->blocks[i];
+        machine_instruction = analysis->machine_instructions[block->last];
+        if (block->loop != loop || block->last == block->first || CS_GET_OPCODE(machine_instruction) != CS_INS_I_BRXX ||
+            CS_GET_JMP_CONDITION(machine_instruction) != CS_JMP_COND_EQUAL || block->target == CS_ANALYSIS_NONE ||
+            BIT_TEST(analysis->loop_blocks[loop], block->target) || block->fallthrough == CS_ANALYSIS_NONE ||
+            !BIT_TEST(analysis->loop_blocks[loop], block->fallthrough)) {
+            continue;
+        }
+
+        /* Counter tested right after its update, or by a CPI */
+        machine_instruction = analysis->machine_instructions[block->last - 1];
+        reg                 = (unsigned char)CS_GET_REG_A(machine_instruction);
+        is_compared         = CS_GET_OPCODE(machine_instruction) == CS_INS_I_CPI;
+        value               = is_compared ? (unsigned char)CS_GET_ARG_B(machine_instruction) : 0;
+
+        /* The counter is written only by its update, once each iteration */
+        writes = 0;
+        for (j = 0; j < analysis->machine_instructions_amount; j++) {
+            if (BIT_TEST(analysis->loops[loop].body, j) && (an_get_written(analysis, wcet, j) & (1u << reg))) {
+                update = (unsigned short)j;
+                writes++;
+            }
+        }
+        if (writes != 1 || (!is_compared && update != block->last - 1) ||
+            !an_get_update(analysis, analysis->machine_instructions[update], &step) || !step ||
+            analysis->blocks[analysis->address_blocks[update]].loop != loop ||
+            !an_is_unavoidable(analysis, wcet, loop, (unsigned short)i) ||
+            !an_is_unavoidable(analysis, wcet, loop, analysis->address_blocks[update])) {
+            continue;
+        }
+
+        if (an_get_initial_value(analysis, wcet, loop, reg, &initial)) {
+            iterations = an_count_iterations(initial, step, value, true);
+            /* An update in another block may run after the test */
+            if (iterations && analysis->address_blocks[update] != i) {
+                after      = iterations;
+                iterations = an_count_iterations(initial, step, value, false);
+                if (iterations && after > iterations) {
+                    iterations = after;
+                }
+            }
+        } else {
+            /* Every value is reached within 256 iterations if the step is odd */
+            iterations = step & 1u ? CS_ROM_SIZE : 0;
+        }
+        if (iterations && (!bound || iterations < bound)) {
+            bound = iterations;
+        }
+    }
+    return bound;
+}
+
+/** @brief Estimates the worst case of a loop, after the loops inside it */
+static void an_estimate_loop(cs_analysis *analysis, an_wcet *wcet, unsigned short loop) {
+    cs_analysis_loop  *data = &analysis->loops[loop];
+    unsigned long long to_latch;
+    unsigned long long to_leave;
+    size_t             i;
+
+    wcet->loop_states[loop] = AN_VISITED;
+    for (i = 0; i < analysis->loops_amount; i++) {
+        if (analysis->loops[i].parent == loop && wcet->loop_states[i] != AN_VISITED) {
+            an_estimate_loop(analysis, wcet, (unsigned short)i);
+        }
+    }
+
+    memset(wcet->node_states, AN_UNVISITED, sizeof wcet->node_states);
+    an_visit_node(analysis, wcet, loop, data->header);
+    to_latch = wcet->to_latch[data->header];
+    to_leave = wcet->to_leave[data->header];
+
+    /* Every iteration but the last one goes back to the header */
+    data->bound = an_infer_bound(analysis, wcet, loop);
+    if (!data->bound || to_leave == AN_NO_PATH) {
+        data->wcet = CS_ANALYSIS_UNBOUNDED;
+    } else {
+        data->wcet = an_add(an_multiply(data->bound - 1u, to_latch), to_leave);
+    }
+}
+
+/** @brief Estimates the worst case of a subroutine, after its callees and loops */
+static void an_estimate_subroutine(cs_analysis *analysis, an_wcet *wcet, unsigned short subroutine) {
+    cs_analysis_subroutine *data = &analysis->subroutines[subroutine];
+    unsigned short          callee;
+    unsigned short          loop;
+    unsigned short          node;
+    size_t                  i;
+
+    wcet->subroutine_states[subroutine] = AN_VISITING;
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        if (BIT_TEST(wcet->reachable[subroutine], i) && (analysis->blocks[i].flags & CS_ANALYSIS_BLOCK_CALL)) {
+            callee = wcet->callees[analysis->blocks[i].last];
+            if (callee != CS_ANALYSIS_NONE && wcet->subroutine_states[callee] == AN_UNVISITED) {
+                an_estimate_subroutine(analysis, wcet, callee);
+            }
+        }
+    }
+    for (i = 0; i < analysis->loops_amount; i++) {
+        if (BIT_TEST(wcet->reachable[subroutine], analysis->loops[i].header) && wcet->loop_states[i] != AN_VISITED) {
+            an_estimate_loop(analysis, wcet, (unsigned short)i);
+        }
+    }
+
+    memset(wcet->node_states, AN_UNVISITED, sizeof wcet->node_states);
+    wcet->subroutine = subroutine;
+    loop = an_node_loop(analysis, CS_ANALYSIS_NONE, data->block);
+    node = loop == CS_ANALYSIS_NONE ? data->block : analysis->loops[loop].header;
+    an_visit_node(analysis, wcet, CS_ANALYSIS_NONE, node);
+    data->wcet = wcet->to_leave[node] == AN_NO_PATH ? CS_ANALYSIS_UNBOUNDED : wcet->to_leave[node];
+    wcet->subroutine_states[subroutine] = AN_VISITED;
+}
+
+bool an_compute_wcet(cs_analysis *analysis) {
+    an_wcet           *wcet = calloc(1, sizeof *wcet);
+    cs_analysis_block *block;
+    size_t             i;
+    size_t             j;
+
+    if (!wcet) {
+        return false;
+    }
+
+    wcet->opcodes = an_get_opcodes(analysis->platform);
+    for (i = 0; i < CS_OPCODES_SIZE; i++) {
+        wcet->opcode_cycles[i] = cs_op_cycles(&wcet->opcodes[i]);
+    }
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        wcet->callees[i] = an_get_callee(analysis, i);
+    }
+
+    for (i = 0; i < analysis->blocks_amount; i++) {
+        block         = &analysis->blocks[i];
+        block->cycles = 0;
+        for (j = block->first; j <= block->last; j++) {
+            block->cycles += wcet->opcode_cycles[CS_GET_OPCODE(analysis->machine_instructions[j])];
+        }
+    }
+    for (i = 0; i < analysis->loops_amount; i++) {
+        analysis->loops[i].wcet = CS_ANALYSIS_UNBOUNDED;
+    }
+
+    for (i = 0; i < analysis->subroutines_amount; i++) {
+        an_reach(analysis, wcet, (unsigned short)i);
+    }
+    an_build_written(analysis, wcet);
+    for (i = 0; i < analysis->subroutines_amount; i++) {
+        if (wcet->subroutine_states[i] == AN_UNVISITED) {
+            an_estimate_subroutine(analysis, wcet, (unsigned short)i);
+        }
+    }
+
+    free(wcet);
+    return true;
+}
+
+/**
+ * @brief Gets the most times an instruction runs each time its subroutine
+ *      is called, from the bounds of the loops containing it
+ * @return Times, or CS_ANALYSIS_UNBOUNDED
+ */
+static unsigned long long an_get_executions(cs_analysis const *analysis, size_t address) {
+    cs_analysis_block const *block      = &analysis->blocks[analysis->address_blocks[address]];
+    unsigned long long       executions = 1;
+    unsigned short           loop;
+
+    if (!(block->flags & CS_ANALYSIS_BLOCK_REACHABLE)) {
+        return 0;
+    }
+    for (loop = block->loop; loop != CS_ANALYSIS_NONE; loop = analysis->loops[loop].parent) {
+        if (!analysis->loops[loop].bound) {
+            return CS_ANALYSIS_UNBOUNDED;
+        }
+        executions *= analysis->loops[loop].bound;
+    }
+    return executions;
+}
+
+/** @brief Formats cycles or times, which may be CS_ANALYSIS_UNBOUNDED */
+static char const *an_format(char *buffer, size_t size, unsigned long long value) {
+    if (value == CS_ANALYSIS_UNBOUNDED) {
+        return "unbounded";
+    }
+    snprintf(buffer, size, "%llu", value);
+    return buffer;
+}
+
+char *cs_analysis_wcet_report(cs_analysis const *analysis, struct cs_as_machine_code const *machine_code,
+                              char const *source) {
+    cs_report_text           text = {0, 0, 0, false};
+    cs_analysis_block const *block;
+    unsigned long long      *line_cycles;
+    unsigned long long      *line_worst;
+    unsigned long long       executions;
+    unsigned long long       cycles;
+    unsigned short           callee;
+    unsigned char            opcode;
+    char const             **lines;
+    size_t                  *line_lengths;
+    size_t                   lines_amount;
+    size_t                   line;
+    size_t                   label_length;
+    size_t                   i;
+    char const              *label;
+    char                     buffers[2][24];
+
+    if (!analysis || !machine_code || !source) {
+        return 0;
+    }
+
+    lines_amount = cs_report_split_lines(source, &lines, &line_lengths);
+    if (!lines_amount) {
+        return 0;
+    }
+
+    /* Aggregate the cycles by source line (1-based, as the assembler reports them) */
+    line_cycles = calloc(lines_amount + 1, sizeof *line_cycles);
+    line_worst  = calloc(lines_amount + 1, sizeof *line_worst);
+    if (!line_cycles || !line_worst) {
+        free(lines);
+        free(line_lengths);
+        free(line_cycles);
+        free(line_worst);
+        return 0;
+    }
+    for (i = 0; i < analysis->machine_instructions_amount; i++) {
+        line = machine_code->matching_source_assembly_lines[i];
+        if (line > lines_amount) {
+            line = 0;
+        }
+
+        opcode = CS_GET_OPCODE(analysis->machine_instructions[i]);
+        cycles = cs_op_cycles(&an_get_opcodes(analysis->platform)[opcode]);
+        line_cycles[line] += cycles;
+
+        /* The worst case takes every BRxx */
+        executions = an_get_executions(analysis, i);
+        cycles += opcode == CS_INS_I_BRXX;
+        if (opcode == CS_INS_I_CALL) {
+            callee = an_get_callee(analysis, i);
+            cycles = an_add(cycles, callee == CS_ANALYSIS_NONE ? CS_ANALYSIS_UNBOUNDED
+                                                               : analysis->subroutines[callee].wcet);
+        }
+        line_worst[line] = an_add(line_worst[line], an_multiply(executions, cycles));
+    }
+
+    /* Subroutines */
+    cs_report_printf(&text, "Subroutines:\n%8s %20s  %s\n", "entry", "worst-case cycles", "label");
+    for (i = 0; i < analysis->subroutines_amount; i++) {
+        label_length = cs_profiler_find_label_at(machine_code, source, analysis->subroutines[i].entry, &label);
+        cs_report_printf(&text, "    " HEX8_X_FORMAT " %20s  %.*s\n", analysis->subroutines[i].entry,
+                         an_format(buffers[0], sizeof buffers[0], analysis->subroutines[i].wcet),
+                         (int)label_length, label);
+    }
+
+    /* Loops */
+    cs_report_printf(&text, "\nLoops:\n%8s %6s %10s %20s  %s\n", "header", "depth", "bound", "worst-case cycles",
+                     "label");
+    for (i = 0; i < analysis->loops_amount; i++) {
+        block        = &analysis->blocks[analysis->loops[i].header];
+        label_length = cs_profiler_find_label_at(machine_code, source, block->first, &label);
+        cs_report_printf(&text, "    " HEX8_X_FORMAT " %6u %10s %20s  %.*s\n", block->first,
+                         (unsigned)analysis->loops[i].depth,
+                         analysis->loops[i].bound ? an_format(buffers[0], sizeof buffers[0], analysis->loops[i].bound)
+                                                  : "unknown",
+                         an_format(buffers[1], sizeof buffers[1], analysis->loops[i].wcet), (int)label_length,
+                         label);
+    }
+
+    /* Annotated listing, each line's worst case in a call of its subroutine */
+    cs_report_printf(&text, "\nListing:\n%10s %20s  %s\n", "cycles", "worst-case cycles", "source");
+    for (line = 1; line <= lines_amount; line++) {
+        if (line_cycles[line]) {
+            cs_report_printf(&text, "%10llu %20s  %.*s\n", line_cycles[line],
+                             an_format(buffers[0], sizeof buffers[0], line_worst[line]), (int)line_lengths[line - 1],
+                             lines[line - 1]);
+        } else {
+            cs_report_printf(&text, "%10s %20s  %.*s\n", "", "", (int)line_lengths[line - 1], lines[line - 1]);
+        }
+    }
+
+    free(lines);
+    free(line_lengths);
+    free(line_cycles);
+    free(line_worst);
+
+    return cs_report_finish(&text);
+}
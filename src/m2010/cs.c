@@ -1,63 +1,157 @@
 /** @file cs.c */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../../include/asm2010.h"
 
+#include "cs_accesses.h"
+#include "cs_breakpoints.h"
+#include "cs_call_graph.h"
+#include "cs_clock.h"
+#include "cs_counters.h"
+#include "cs_coverage.h"
+#include "cs_fuzz.h"
+#include "cs_history.h"
 #include "cs_instructions.h"
+#include "cs_interrupts.h"
+#include "cs_io_log.h"
+#include "cs_loops.h"
 #include "cs_opcodes.h"
 #include "cs_platforms.h"
+#include "cs_profiler.h"
+#include "cs_snapshot.h"
+#include "cs_trace_file.h"
+#include "cs_tracer.h"
+#include "cs_uninit.h"
+#include "cs_vcd.h"
 
 #include "cs2010/cs2010_platform.h"
 #include "cs3/cs3_platform.h"
 
 #include "cs.h"
 
+/* Compile-time checks of the documented state page layout */
+#define CS_STATE_PAGE_CHECK(name, member)                                                                              \
+    typedef char cs_state_page_check_##name[offsetof(cs_machine, member) == CS_STATE_PAGE_OFFSET_##name ? 1 : -1]
+
+CS_STATE_PAGE_CHECK(IR, registers.ir);
+CS_STATE_PAGE_CHECK(R0, registers.r0);
+CS_STATE_PAGE_CHECK(SP, registers.sp);
+CS_STATE_PAGE_CHECK(PC, registers.pc);
+CS_STATE_PAGE_CHECK(AC, registers.ac);
+CS_STATE_PAGE_CHECK(SR, registers.sr);
+CS_STATE_PAGE_CHECK(MDR, registers.mdr);
+CS_STATE_PAGE_CHECK(MAR, registers.mar);
+CS_STATE_PAGE_CHECK(SIGNALS, signals);
+CS_STATE_PAGE_CHECK(MICROOP, microop);
+CS_STATE_PAGE_CHECK(STOPPED, stopped);
+CS_STATE_PAGE_CHECK(PLATFORM, platform);
+CS_STATE_PAGE_CHECK(IR_ADDR, instruction_address);
+CS_STATE_PAGE_CHECK(CYCLES, cycles);
+CS_STATE_PAGE_CHECK(INSTRUCTIONS, instructions);
+CS_STATE_PAGE_CHECK(RAM, ram);
+CS_STATE_PAGE_CHECK(ROM, rom);
+/* ROM words must take 2 bytes for the page to end at CS_STATE_PAGE_SIZE */
+typedef char cs_state_page_check_SIZE[sizeof(unsigned short) == 2 ? 1 : -1];
+
 cs_machine *cs_create() {
-    return malloc(sizeof(cs_machine));
+    /* Null internal pointers let the first cs_init tell there is nothing to free */
+    return calloc(1, sizeof(cs_machine));
+}
+
+/**
+ * @brief Frees every internal allocation of an emulation instance,
+ *      disabling its observers and closing its files
+ * @param cs Pointer to the emulation instance
+ */
+static void cs_free_internals(cs_machine *cs) {
+    free(cs->interrupts);
+    free(cs->accesses);
+    free(cs->loops);
+    cs->interrupts   = 0;
+    cs->accesses     = 0;
+    cs->loops        = 0;
+    cs->trace_record = 0;
+    cs_io_log_disable(cs);
+    cs_clock_disable(cs);
+    cs_snapshot_disable(cs);
+    cs_profiler_disable(cs);
+    cs_call_graph_disable(cs);
+    cs_tracer_disable(cs);
+    cs_trace_file_close(cs);
+    cs_history_disable(cs);
+    cs_breakpoints_clear(cs);
+    cs_counters_disable(cs);
+    cs_vcd_close(cs);
+    cs_coverage_disable(cs);
+    cs_uninit_disable(cs);
+    cs_fuzz_disable(cs);
 }
 
 static int cs_init_platform(cs_machine *cs, cs_platform platform) {
-    switch (platform) {
+    size_t i;
+
+    switch (CS_PLATFORM_BASE(platform)) {
         case CS_PLATFORM_2010:
             cs->opcodes = cs2010_platform_opcodes;
-            return CS_INIT_OK;
+            break;
         case CS_PLATFORM_3:
             cs->opcodes = cs3_platform_opcodes;
-            return CS_INIT_OK;
+            break;
         default:
             return CS_INIT_INVALID_PLATFORM;
     }
-}
+    for (i = 0; i < CS_OPCODES_SIZE; i++) {
+        cs->opcode_cycles[i] = cs_op_cycles(&cs->opcodes[i]);
+    }
 
-int cs_init(cs_machine *cs, cs_platform platform) {
-    if (!cs) {
+    cs->accesses = calloc(1, sizeof *cs->accesses);
+    cs->loops    = calloc(1, sizeof *cs->loops);
+    if (platform & CS_PLATFORM_INTERRUPTS) {
+        cs->interrupts = calloc(1, sizeof *cs->interrupts);
+    }
+    if (!cs->accesses || !cs->loops || ((platform & CS_PLATFORM_INTERRUPTS) && !cs->interrupts)) {
+        cs_free_internals(cs);
         return CS_INIT_NOT_ENOUGH_MEMORY;
     }
 
-    cs->memory.rom = malloc(sizeof *cs->memory.rom * CS_ROM_SIZE);
-    if (!cs->memory.rom) {
-        return CS_INIT_NOT_ENOUGH_MEMORY;
+    /* No access is proven to stay in RAM until a program is loaded */
+    memset(cs->accesses->constants, 0xFF, sizeof cs->accesses->constants);
+    memset(cs->accesses->addresses, 0xFF, sizeof cs->accesses->addresses);
+    if (cs->interrupts) {
+        cs->interrupts->enabled = true;
     }
 
-    cs->memory.ram = malloc(sizeof *cs->memory.ram * CS_RAM_SIZE);
-    if (!cs->memory.ram) {
-        free(cs->memory.rom);
+    cs->platform = platform;
+    return CS_INIT_OK;
+}
+
+int cs_init(cs_machine *cs, cs_platform platform) {
+    if (!cs) {
         return CS_INIT_NOT_ENOUGH_MEMORY;
     }
 
-    cs->registers.regfile[0] = &cs->registers.r0;
-    cs->registers.regfile[1] = &cs->registers.r1;
-    cs->registers.regfile[2] = &cs->registers.r2;
-    cs->registers.regfile[3] = &cs->registers.r3;
-    cs->registers.regfile[4] = &cs->registers.r4;
-    cs->registers.regfile[5] = &cs->registers.r5;
-    cs->registers.regfile[6] = &cs->registers.r6;
-    cs->registers.regfile[7] = &cs->registers.r7;
+    cs->memory.rom          = cs->rom;
+    cs->memory.ram          = cs->ram;
+    cs->instruction_address = 0;
+
+    cs->regfile[0] = &cs->registers.r0;
+    cs->regfile[1] = &cs->registers.r1;
+    cs->regfile[2] = &cs->registers.r2;
+    cs->regfile[3] = &cs->registers.r3;
+    cs->regfile[4] = &cs->registers.r4;
+    cs->regfile[5] = &cs->registers.r5;
+    cs->regfile[6] = &cs->registers.r6;
+    cs->regfile[7] = &cs->registers.r7;
 
     cs->io_read_fn  = cs_io_read_stub;
     cs->io_write_fn = cs_io_write_stub;
+    cs->next_event  = CS_INTERRUPTS_NO_EVENT;
+
+    /* A reinitialized instance starts over, without the allocations of the previous platform */
+    cs_free_internals(cs);
 
     return cs_init_platform(cs, platform);
 }
@@ -65,12 +159,59 @@ int cs_init(cs_machine *cs, cs_platform platform) {
 void cs_set_io_functions(cs_machine *cs, cs_io_read_fn io_read_fn, cs_io_write_fn io_write_fn) {
     cs->io_read_fn  = io_read_fn;
     cs->io_write_fn = io_write_fn;
+    /* The default handlers control no address */
+    if (io_read_fn == cs_io_read_stub && io_write_fn == cs_io_write_stub) {
+        memset(cs->accesses->io, 0, sizeof cs->accesses->io);
+        cs_accesses_classify(cs);
+    } else {
+        cs_set_io_addresses(cs, 0);
+    }
 }
 
 static void cs_fetch(cs_machine *cs) {
-    cs->registers.ir = cs->memory.rom[cs->registers.pc++];
-    cs->microop      = 0;
-    cs->signals      = cs->opcodes[CS_GET_OPCODE(cs->registers.ir)].signals[cs->microop];
+    cs->instruction_address = cs->registers.pc;
+    cs->registers.ir        = cs->memory.rom[cs->registers.pc++];
+    cs->microop             = 0;
+    cs->signals             = cs->opcodes[CS_GET_OPCODE(cs->registers.ir)].signals[cs->microop];
+}
+
+static void cs_complete(cs_machine *cs) {
+    /* Replayed instructions were observed when they first ran */
+    bool is_observed = !CS_HISTORY_IS_REPLAYING(cs);
+
+    if (is_observed) {
+#ifdef CS_TRACER
+        if (cs->tracer) {
+            cs_tracer_record_instruction(cs);
+        }
+#endif /* CS_TRACER */
+        if (cs->call_graph) {
+            cs_call_graph_tick(cs);
+        }
+        if (cs->counters) {
+            cs_counters_tick(cs);
+        }
+        if (cs->coverage) {
+            cs_coverage_tick(cs);
+        }
+    }
+    cs->instructions++;
+    cs_fetch(cs);
+    if (cs->cycles >= cs->next_event && cs_interrupts_dispatch(cs)) {
+        cs_fetch(cs);
+    }
+    if (cs->profiler && is_observed) {
+        cs_profiler_tick(cs);
+    }
+    if (cs->snapshot) {
+        cs_snapshot_tick(cs);
+    }
+    if (cs->trace_file && is_observed) {
+        cs_trace_file_record(cs);
+    }
+    if (cs->history) {
+        cs_history_tick(cs);
+    }
 }
 
 static void cs_microfetch(cs_machine *cs) {
@@ -105,14 +246,25 @@ int cs_load_machine_instructions(cs_machine *cs, unsigned short *machine_instruc
     cs_clear_memory(cs, true, true);
     cs_reset_registers(cs);
     memcpy(cs->memory.rom, machine_instructions, machine_instructions_amount * sizeof(*machine_instructions));
+    cs_accesses_analyze(cs);
+    cs_loops_restart(cs);
     cs_fetch(cs);
+    if (cs->history) {
+        cs_history_restart(cs);
+    }
     return CS_LOAD_OK;
 }
 
 void cs_microstep(cs_machine *cs) {
+    bool is_observed = !CS_HISTORY_IS_REPLAYING(cs);
+
+    if (!cs->stopped) {
+        cs->cycles++;
+    }
+
     switch (cs->opcodes[CS_GET_OPCODE(cs->registers.ir)].microstepper(cs)) {
         case CS_OP_DO_FETCH:
-            cs_fetch(cs);
+            cs_complete(cs);
             break;
         case CS_OP_DO_MICROFETCH:
             cs_microfetch(cs);
@@ -121,12 +273,30 @@ void cs_microstep(cs_machine *cs) {
         default:
             break;
     }
+
+    if (cs->vcd && is_observed) {
+        cs_vcd_record(cs);
+    }
 }
 
 static void cs_step(cs_machine *cs) {
-    switch (cs->opcodes[CS_GET_OPCODE(cs->registers.ir)].stepper(cs)) {
+    cs_instruction_op const *op = &cs->opcodes[CS_GET_OPCODE(cs->registers.ir)];
+
+    /* Waveforms need every microoperation */
+    if (cs->vcd) {
+        do {
+            cs_microstep(cs);
+        } while (cs->microop);
+        return;
+    }
+
+    if (!cs->stopped) {
+        cs->cycles += cs->opcode_cycles[CS_GET_OPCODE(cs->registers.ir)];
+    }
+
+    switch (op->stepper(cs)) {
         case CS_OP_DO_FETCH:
-            cs_fetch(cs);
+            cs_complete(cs);
             break;
         case CS_OP_DO_MICROFETCH:
             cs_microfetch(cs);
@@ -165,25 +335,111 @@ bool cs_blockstep(cs_machine *cs, size_t max_instructions) {
     return remaining_instructions != 0;
 }
 
+static int cs_run_breakpoints(cs_machine *cs, unsigned long long end_cycle) {
+    cs_breakpoints *breakpoints = cs->breakpoints;
+
+    breakpoints->hit_flags     = 0;
+    breakpoints->condition_hit = false;
+    while (!cs->stopped && cs->cycles < end_cycle) {
+        if (cs->microop) {
+            cs_microstep(cs);
+            if (cs->microop) {
+                continue;
+            }
+        } else {
+            cs_step(cs);
+        }
+
+        /* Checked at instruction boundaries only */
+        if (breakpoints->hit_flags) {
+            return CS_RUN_WATCHPOINT;
+        }
+        if (cs->stopped) {
+            break;
+        }
+        if ((breakpoints->condition_dirty || BIT_TEST(breakpoints->condition_pc, cs->instruction_address)) &&
+            cs_condition_check(cs)) {
+            return CS_RUN_CONDITION;
+        }
+        if (BIT_TEST(breakpoints->pc, cs->instruction_address)) {
+            return CS_RUN_BREAKPOINT;
+        }
+    }
+
+    return cs->stopped ? CS_RUN_STOPPED : CS_RUN_EXHAUSTED;
+}
+
+int cs_run(cs_machine *cs, unsigned long long max_cycles) {
+    unsigned long long end_cycle = cs->cycles + max_cycles;
+    unsigned char      address;
+    unsigned char      opcode;
+
+    if (cs->breakpoints) {
+        if (CS_BREAKPOINTS_IS_ACTIVE(cs->breakpoints)) {
+            return cs_run_breakpoints(cs, end_cycle);
+        }
+        /* Once everything is cleared nothing can be hit, and the fast path is taken again */
+        cs->breakpoints->hit_flags     = 0;
+        cs->breakpoints->condition_hit = false;
+    }
+
+    /* Resume a partially executed instruction */
+    while (cs->microop && !cs->stopped && cs->cycles < end_cycle) {
+        cs_microstep(cs);
+    }
+
+    while (!cs->stopped && cs->cycles < end_cycle) {
+        address = cs->instruction_address;
+        opcode  = CS_GET_OPCODE(cs->registers.ir);
+        cs_step(cs);
+        /* Counted loops are closed by a JMP back to their head */
+        if (opcode == CS_INS_I_JMP) {
+            cs_loops_forward(cs, address, end_cycle);
+        }
+    }
+
+    return cs->stopped ? CS_RUN_STOPPED : CS_RUN_EXHAUSTED;
+}
+
 void cs_hard_reset(cs_machine *cs, bool clear_rom) {
     cs_clear_memory(cs, clear_rom, true);
     cs_reset_registers(cs);
     cs_fetch(cs);
+    if (cs->history) {
+        cs_history_restart(cs);
+    }
 }
 
 void cs_soft_reset(cs_machine *cs) {
     cs->registers.pc = 0;
     cs->registers.sp = 0xFF;
     cs->stopped      = false;
+    if (cs->interrupts) {
+        cs_interrupts_reset(cs);
+    }
+    if (cs->profiler) {
+        cs_profiler_restart(cs);
+    }
+    if (cs->call_graph) {
+        cs_call_graph_restart(cs);
+    }
     cs_fetch(cs);
+    if (cs->history) {
+        cs_history_restart(cs);
+    }
 }
 
 void cs_clear_memory(cs_machine *cs, unsigned char clear_rom, unsigned char clear_ram) {
     if (clear_rom) {
         memset(cs->memory.rom, 0, CS_ROM_SIZE * sizeof *cs->memory.rom);
+        cs_accesses_analyze(cs);
+        cs_loops_restart(cs);
     }
     if (clear_ram) {
         memset(cs->memory.ram, 0, CS_RAM_SIZE * sizeof *cs->memory.ram);
+        if (cs->uninit) {
+            cs_uninit_restart(cs);
+        }
     }
 }
 
@@ -204,6 +460,17 @@ void cs_reset_registers(cs_machine *cs) {
     cs->registers.mdr = 0;
     cs->registers.mar = 0;
     cs->stopped       = false;
+    cs->cycles        = 0;
+    cs->instructions  = 0;
+    if (cs->interrupts) {
+        cs_interrupts_reset(cs);
+    }
+    if (cs->profiler) {
+        cs_profiler_restart(cs);
+    }
+    if (cs->call_graph) {
+        cs_call_graph_restart(cs);
+    }
 }
 
 void cs_free(cs_machine *cs) {
@@ -211,12 +478,18 @@ void cs_free(cs_machine *cs) {
         return;
     }
 
-    if (cs->memory.rom) {
-        free(cs->memory.rom);
-    }
-    if (cs->memory.ram) {
-        free(cs->memory.ram);
-    }
-
+    cs_free_internals(cs);
     free(cs);
 }
+
+unsigned char *cs_get_state_page(cs_machine *cs) {
+    return (unsigned char *)cs;
+}
+
+unsigned long long cs_get_cycles(cs_machine const *cs) {
+    return cs->cycles;
+}
+
+unsigned long long cs_get_instructions(cs_machine const *cs) {
+    return cs->instructions;
+}
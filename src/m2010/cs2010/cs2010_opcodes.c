@@ -9,21 +9,21 @@
 
 /* CS2010 ST */
 int cs2010_op_st_stepper(cs_machine *cs) {
-    cs->registers.mar = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
-    cs->registers.ac  = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    cs->registers.mar = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
+    cs->registers.ac  = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     cs->registers.mdr = cs->registers.ac;
-    cs_write_output(cs, cs->registers.mar, cs->registers.mdr);
+    cs_write_data(cs, cs->registers.mar, cs->registers.mdr);
     return CS_OP_DO_FETCH;
 }
 
 int cs2010_op_st_microstepper(cs_machine *cs) {
     switch (cs->microop) {
         case 0:
-            cs->registers.ac = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+            cs->registers.ac = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
-            cs->registers.ac  = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+            cs->registers.ac  = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 2:
             cs->registers.mdr = cs->registers.ac;
@@ -37,17 +37,17 @@ int cs2010_op_st_microstepper(cs_machine *cs) {
 
 /* CS2010 LD */
 int cs2010_op_ld_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
-    cs->registers.mar                                      = cs->registers.ac;
-    cs->registers.mdr                                      = cs_read_input(cs, cs->registers.mar);
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
+    cs->registers.ac                             = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
+    cs->registers.mar                            = cs->registers.ac;
+    cs->registers.mdr                            = cs_read_data(cs, cs->registers.mar);
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
     return CS_OP_DO_FETCH;
 }
 
 int cs2010_op_ld_microstepper(cs_machine *cs) {
     switch (cs->microop) {
         case 0:
-            cs->registers.ac = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+            cs->registers.ac = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
@@ -57,7 +57,7 @@ int cs2010_op_ld_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 3:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
             return CS_OP_DO_FETCH;
     }
 }
@@ -65,9 +65,9 @@ int cs2010_op_ld_microstepper(cs_machine *cs) {
 /* CS2010 STS */
 int cs2010_op_sts_stepper(cs_machine *cs) {
     cs->registers.mar = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.ac  = *cs->registers.regfile[CS_GET_ARG_A(cs->registers.ir)];
+    cs->registers.ac  = *cs->regfile[CS_GET_ARG_A(cs->registers.ir)];
     cs->registers.mdr = cs->registers.ac;
-    cs_write_output(cs, cs->registers.mar, cs->registers.mdr);
+    cs_write_data(cs, cs->registers.mar, cs->registers.mdr);
     return CS_OP_DO_FETCH;
 }
 
@@ -78,7 +78,7 @@ int cs2010_op_sts_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
-            cs->registers.ac  = *cs->registers.regfile[CS_GET_ARG_A(cs->registers.ir)];
+            cs->registers.ac  = *cs->regfile[CS_GET_ARG_A(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 2:
             cs->registers.mdr = cs->registers.ac;
@@ -92,10 +92,10 @@ int cs2010_op_sts_microstepper(cs_machine *cs) {
 
 /* CS2010 LDS */
 int cs2010_op_lds_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.mar                                      = cs->registers.ac;
-    cs->registers.mdr                                      = cs_read_input(cs, cs->registers.mar);
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
+    cs->registers.ac                             = CS_GET_ARG_B(cs->registers.ir);
+    cs->registers.mar                            = cs->registers.ac;
+    cs->registers.mdr                            = cs_read_data(cs, cs->registers.mar);
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
     return CS_OP_DO_FETCH;
 }
 
@@ -112,18 +112,18 @@ int cs2010_op_lds_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 3:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.mdr;
             return CS_OP_DO_FETCH;
     }
 }
 
 /* CS2010 CALL */
 int cs2010_op_call_stepper(cs_machine *cs) {
-    cs->registers.mdr                 = cs->registers.pc;
-    cs->registers.ac                  = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.mar                 = cs->registers.sp--;
-    cs->registers.pc                  = cs->registers.ac;
-    cs->memory.ram[cs->registers.mar] = cs->registers.mdr;
+    cs->registers.mdr = cs->registers.pc;
+    cs->registers.ac  = CS_GET_ARG_B(cs->registers.ir);
+    cs->registers.mar = cs->registers.sp--;
+    cs->registers.pc  = cs->registers.ac;
+    cs_write_memory(cs, cs->registers.mar, cs->registers.mdr);
     return CS_OP_DO_FETCH;
 }
 
@@ -138,8 +138,8 @@ int cs2010_op_call_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
-            cs->registers.pc                  = cs->registers.ac;
-            cs->memory.ram[cs->registers.mar] = cs->registers.mdr;
+            cs->registers.pc = cs->registers.ac;
+            cs_write_memory(cs, cs->registers.mar, cs->registers.mdr);
             return CS_OP_DO_FETCH;
     }
 }
@@ -147,7 +147,7 @@ int cs2010_op_call_microstepper(cs_machine *cs) {
 /* CS2010 RET */
 int cs2010_op_ret_stepper(cs_machine *cs) {
     cs->registers.mar = ++cs->registers.sp;
-    cs->registers.mdr = cs->memory.ram[cs->registers.mar];
+    cs->registers.mdr = cs_read_memory(cs, cs->registers.mar);
     cs->registers.pc  = cs->registers.mdr;
     return CS_OP_DO_FETCH;
 }
@@ -161,7 +161,7 @@ int cs2010_op_ret_microstepper(cs_machine *cs) {
             cs->registers.mar = cs->registers.sp;
             return CS_OP_DO_MICROFETCH;
         case 2:
-            cs->registers.mdr = cs->memory.ram[cs->registers.mar];
+            cs->registers.mdr = cs_read_memory(cs, cs->registers.mar);
             return CS_OP_DO_MICROFETCH;
         case 3:
         default:
@@ -198,7 +198,7 @@ static void cs_op_set_ror_flags(cs_machine *cs, unsigned char r, unsigned char a
 }
 
 int cs2010_op_ror_stepper(cs_machine *cs) {
-    unsigned char *dst_register = cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char *dst_register = cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     unsigned char  a_7          = BIT_AT(*dst_register, 7);
     unsigned char  a_0          = BIT_AT(*dst_register, 0);
     unsigned char  c_in         = BIT_AT(cs->registers.sr, CS_SR_C_OFFSET);
@@ -209,7 +209,7 @@ int cs2010_op_ror_stepper(cs_machine *cs) {
 }
 
 int cs2010_op_ror_microstepper(cs_machine *cs) {
-    unsigned char *dst_register = cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char *dst_register = cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     unsigned char  a_7;
     unsigned char  a_0;
     unsigned char  c_in;
@@ -247,7 +247,7 @@ static void cs_op_set_rol_flags(cs_machine *cs, unsigned char r, unsigned char a
 }
 
 int cs2010_op_rol_stepper(cs_machine *cs) {
-    unsigned char *dst_register = cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char *dst_register = cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     unsigned char  a_7          = BIT_AT(*dst_register, 7);
     unsigned char  a_6          = BIT_AT(*dst_register, 6);
     unsigned char  c_in         = BIT_AT(cs->registers.sr, CS_SR_C_OFFSET);
@@ -258,7 +258,7 @@ int cs2010_op_rol_stepper(cs_machine *cs) {
 }
 
 int cs2010_op_rol_microstepper(cs_machine *cs) {
-    unsigned char *dst_register = cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char *dst_register = cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     unsigned char  a_7;
     unsigned char  a_6;
     unsigned char  c_in;
@@ -280,11 +280,11 @@ int cs2010_op_rol_microstepper(cs_machine *cs) {
 
 /* CS2010 ADDI */
 int cs2010_op_addi_stepper(cs_machine *cs) {
-    return cs_op_arithmetic_stepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
+    return cs_op_arithmetic_stepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
                                     CS_GET_ARG_B(cs->registers.ir), false);
 }
 
 int cs2010_op_addi_microstepper(cs_machine *cs) {
-    return cs_op_arithmetic_microstepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
+    return cs_op_arithmetic_microstepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
                                          CS_GET_ARG_B(cs->registers.ir), false);
 }
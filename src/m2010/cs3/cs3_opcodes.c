@@ -9,20 +9,20 @@
 
 /* CS3 ST */
 int cs3_op_st_stepper(cs_machine *cs) {
-    cs->registers.mar = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
-    cs->registers.ac  = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
-    cs_write_output(cs, cs->registers.mar, cs->registers.ac);
+    cs->registers.mar = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
+    cs->registers.ac  = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
+    cs_write_data(cs, cs->registers.mar, cs->registers.ac);
     return CS_OP_DO_FETCH;
 }
 
 int cs3_op_st_microstepper(cs_machine *cs) {
     switch (cs->microop) {
         case 0:
-            cs->registers.ac = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+            cs->registers.ac = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
-            cs->registers.ac  = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+            cs->registers.ac  = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
@@ -33,23 +33,23 @@ int cs3_op_st_microstepper(cs_machine *cs) {
 
 /* CS3 LD */
 int cs3_op_ld_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
-    cs->registers.mar                                      = cs->registers.ac;
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
+    cs->registers.ac                             = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
+    cs->registers.mar                            = cs->registers.ac;
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_data(cs, cs->registers.mar);
     return CS_OP_DO_FETCH;
 }
 
 int cs3_op_ld_microstepper(cs_machine *cs) {
     switch (cs->microop) {
         case 0:
-            cs->registers.ac = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+            cs->registers.ac = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
             return CS_OP_DO_FETCH;
     }
 }
@@ -57,8 +57,8 @@ int cs3_op_ld_microstepper(cs_machine *cs) {
 /* CS3 STS */
 int cs3_op_sts_stepper(cs_machine *cs) {
     cs->registers.mar = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.ac  = *cs->registers.regfile[CS_GET_ARG_A(cs->registers.ir)];
-    cs_write_output(cs, cs->registers.mar, cs->registers.ac);
+    cs->registers.ac  = *cs->regfile[CS_GET_ARG_A(cs->registers.ir)];
+    cs_write_data(cs, cs->registers.mar, cs->registers.ac);
     return CS_OP_DO_FETCH;
 }
 
@@ -69,7 +69,7 @@ int cs3_op_sts_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 1:
             cs->registers.mar = cs->registers.ac;
-            cs->registers.ac  = *cs->registers.regfile[CS_GET_ARG_A(cs->registers.ir)];
+            cs->registers.ac  = *cs->regfile[CS_GET_ARG_A(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
@@ -80,9 +80,9 @@ int cs3_op_sts_microstepper(cs_machine *cs) {
 
 /* CS3 LDS */
 int cs3_op_lds_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.mar                                      = cs->registers.ac;
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
+    cs->registers.ac                             = CS_GET_ARG_B(cs->registers.ir);
+    cs->registers.mar                            = cs->registers.ac;
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_data(cs, cs->registers.mar);
     return CS_OP_DO_FETCH;
 }
 
@@ -96,17 +96,17 @@ int cs3_op_lds_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs_read_input(cs, cs->registers.mar);
             return CS_OP_DO_FETCH;
     }
 }
 
 /* CS3 CALL */
 int cs3_op_call_stepper(cs_machine *cs) {
-    cs->registers.ac                  = CS_GET_ARG_B(cs->registers.ir);
-    cs->registers.mar                 = cs->registers.sp--;
-    cs->memory.ram[cs->registers.mar] = cs->registers.pc;
-    cs->registers.pc                  = cs->registers.ac;
+    cs->registers.ac  = CS_GET_ARG_B(cs->registers.ir);
+    cs->registers.mar = cs->registers.sp--;
+    cs_write_memory(cs, cs->registers.mar, cs->registers.pc);
+    cs->registers.pc = cs->registers.ac;
     return CS_OP_DO_FETCH;
 }
 
@@ -117,7 +117,7 @@ int cs3_op_call_microstepper(cs_machine *cs) {
             cs->registers.mar = cs->registers.sp--;
             return CS_OP_DO_MICROFETCH;
         case 1:
-            cs->memory.ram[cs->registers.mar] = cs->registers.pc;
+            cs_write_memory(cs, cs->registers.mar, cs->registers.pc);
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
@@ -129,7 +129,7 @@ int cs3_op_call_microstepper(cs_machine *cs) {
 /* CS3 RET */
 int cs3_op_ret_stepper(cs_machine *cs) {
     cs->registers.mar = ++cs->registers.sp;
-    cs->registers.pc  = cs->memory.ram[cs->registers.mar];
+    cs->registers.pc  = cs_read_memory(cs, cs->registers.mar);
     return CS_OP_DO_FETCH;
 }
 
@@ -143,7 +143,7 @@ int cs3_op_ret_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 2:
         default:
-            cs->registers.pc = cs->memory.ram[cs->registers.mar];
+            cs->registers.pc = cs_read_memory(cs, cs->registers.mar);
             return CS_OP_DO_FETCH;
     }
 }
@@ -0,0 +1,302 @@
+/** @file cs_accesses.c */
+
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_instructions.h"
+#include "cs_opcodes.h"
+
+#include "cs_accesses.h"
+
+/** @brief Register values of the propagation, besides the constants 0 to 255 */
+#define CS_ACCESSES_UNKNOWN   0x100u
+#define CS_ACCESSES_UNREACHED 0x200u
+
+/** @brief Gets the registers an instruction may write, a bit for each, given those written by each subroutine */
+static unsigned char cs_accesses_get_written(cs_machine const *cs, unsigned char const *written,
+                                             unsigned short machine_instruction) {
+    unsigned char opcode = CS_GET_OPCODE(machine_instruction);
+
+    if (cs->opcodes[opcode].stepper == cs_op_noop_stepper) {
+        return 0;
+    }
+    switch (opcode) {
+        case CS_INS_I_ST:
+        case CS_INS_I_STS:
+        case CS_INS_I_RET:
+        case CS_INS_I_BRXX:
+        case CS_INS_I_JMP:
+        case CS_INS_I_CP:
+        case CS_INS_I_CPI:
+        case CS_INS_I_CLC:
+        case CS_INS_I_SEC:
+        case CS_INS_I_STOP:
+            return 0;
+        case CS_INS_I_CALL:
+            return written[CS_GET_ARG_B(machine_instruction)];
+        default:
+            return (unsigned char)(1u << CS_GET_REG_A(machine_instruction));
+    }
+}
+
+/**
+ * @brief Lists the addresses executed after an instruction, within its
+ *      subroutine: a CALL continues at its return address
+ * @param machine_instruction Instruction
+ * @param address ROM address of the instruction
+ * @param successors Pointer where the addresses will be stored
+ * @return Amount of addresses
+ */
+static size_t cs_accesses_get_successors(unsigned short machine_instruction, unsigned char address,
+                                         unsigned char *successors) {
+    switch (CS_GET_OPCODE(machine_instruction)) {
+        case CS_INS_I_RET:
+        case CS_INS_I_STOP:
+            return 0;
+        case CS_INS_I_JMP:
+            successors[0] = (unsigned char)CS_GET_ARG_B(machine_instruction);
+            return 1;
+        case CS_INS_I_BRXX:
+            successors[0] = (unsigned char)(address + 1u);
+            successors[1] = (unsigned char)CS_GET_ARG_B(machine_instruction);
+            return 2;
+        default:
+            /* PC wraps around at the end of ROM */
+            successors[0] = (unsigned char)(address + 1u);
+            return 1;
+    }
+}
+
+/**
+ * @brief Finds the registers written by the subroutine at each CALL target,
+ *      including its callees, iterating until they don't change
+ * @param cs Pointer to the emulation instance
+ * @param written Pointer where the registers of each address will be stored
+ */
+static void cs_accesses_build_written(cs_machine const *cs, unsigned char *written) {
+    unsigned char entries[CS_ROM_SIZE / 8];
+    unsigned char visited[CS_ROM_SIZE / 8];
+    unsigned char stack[CS_ROM_SIZE];
+    unsigned char successors[2];
+    unsigned char mask;
+    bool          is_changed = true;
+    size_t        depth;
+    size_t        amount;
+    size_t        i;
+    size_t        j;
+
+    memset(entries, 0, sizeof entries);
+    memset(written, 0, CS_ROM_SIZE);
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        if (CS_GET_OPCODE(cs->memory.rom[i]) == CS_INS_I_CALL) {
+            BIT_SET(entries, CS_GET_ARG_B(cs->memory.rom[i]));
+        }
+    }
+
+    while (is_changed) {
+        is_changed = false;
+        for (i = 0; i < CS_ROM_SIZE; i++) {
+            if (!BIT_TEST(entries, i)) {
+                continue;
+            }
+            mask  = written[i];
+            depth = 0;
+            memset(visited, 0, sizeof visited);
+            BIT_SET(visited, i);
+            stack[depth++] = (unsigned char)i;
+            while (depth) {
+                j = stack[--depth];
+                mask |= cs_accesses_get_written(cs, written, cs->memory.rom[j]);
+                amount = cs_accesses_get_successors(cs->memory.rom[j], (unsigned char)j, successors);
+                while (amount--) {
+                    if (!BIT_TEST(visited, successors[amount])) {
+                        BIT_SET(visited, successors[amount]);
+                        stack[depth++] = successors[amount];
+                    }
+                }
+            }
+            if (mask != written[i]) {
+                written[i] = mask;
+                is_changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Merges the registers reaching an address from one of its predecessors
+ * @param values Pointer to the registers already reaching the address
+ * @param incoming Pointer to the registers of the predecessor
+ * @return true if the registers reaching the address changed, false otherwise
+ */
+static bool cs_accesses_merge(unsigned short *values, unsigned short const *incoming) {
+    bool   is_changed = false;
+    size_t i;
+
+    if (values[0] == CS_ACCESSES_UNREACHED) {
+        memcpy(values, incoming, 8 * sizeof *values);
+        return true;
+    }
+    for (i = 0; i < 8; i++) {
+        if (values[i] != incoming[i] && values[i] != CS_ACCESSES_UNKNOWN) {
+            values[i]  = CS_ACCESSES_UNKNOWN;
+            is_changed = true;
+        }
+    }
+    return is_changed;
+}
+
+/**
+ * @brief Computes the registers after an instruction
+ * @param cs Pointer to the emulation instance
+ * @param written Pointer to the registers written by each subroutine
+ * @param machine_instruction Instruction
+ * @param values Pointer to the registers, updated in place
+ */
+static void cs_accesses_transfer(cs_machine const *cs, unsigned char const *written, unsigned short machine_instruction,
+                                 unsigned short *values) {
+    unsigned short *a     = &values[CS_GET_REG_A(machine_instruction)];
+    unsigned short  b     = values[CS_GET_REG_B(machine_instruction)];
+    unsigned char   k     = (unsigned char)CS_GET_ARG_B(machine_instruction);
+    unsigned char   mask  = cs_accesses_get_written(cs, written, machine_instruction);
+    bool            is_ok = *a < CS_ACCESSES_UNKNOWN;
+    size_t          i;
+
+    if (!mask) {
+        return;
+    }
+    switch (CS_GET_OPCODE(machine_instruction)) {
+        case CS_INS_I_LDI:
+            *a = k;
+            return;
+        case CS_INS_I_MOV:
+            *a = b;
+            return;
+        case CS_INS_I_ADD:
+            *a = is_ok && b < CS_ACCESSES_UNKNOWN ? (unsigned char)(*a + b) : CS_ACCESSES_UNKNOWN;
+            return;
+        case CS_INS_I_SUB:
+            *a = is_ok && b < CS_ACCESSES_UNKNOWN ? (unsigned char)(*a - b) : CS_ACCESSES_UNKNOWN;
+            return;
+        case CS_INS_I_ADDI:
+            *a = is_ok ? (unsigned char)(*a + k) : CS_ACCESSES_UNKNOWN;
+            return;
+        case CS_INS_I_SUBI:
+            *a = is_ok ? (unsigned char)(*a - k) : CS_ACCESSES_UNKNOWN;
+            return;
+        default:
+            for (i = 0; i < 8; i++) {
+                if (mask & (1u << i)) {
+                    values[i] = CS_ACCESSES_UNKNOWN;
+                }
+            }
+            return;
+    }
+}
+
+void cs_accesses_analyze(cs_machine *cs) {
+    unsigned short values[CS_ROM_SIZE][8];
+    unsigned short incoming[8];
+    unsigned char  written[CS_ROM_SIZE];
+    unsigned char  is_queued[CS_ROM_SIZE / 8];
+    unsigned char  queue[CS_ROM_SIZE];
+    unsigned char  successors[2];
+    unsigned short machine_instruction;
+    size_t         depth = 0;
+    size_t         amount;
+    size_t         address;
+    size_t         i;
+
+    cs_accesses_build_written(cs, written);
+
+    /* Registers are unknown at the entry, and propagated until they don't change */
+    for (address = 0; address < CS_ROM_SIZE; address++) {
+        values[address][0] = CS_ACCESSES_UNREACHED;
+    }
+    for (i = 0; i < 8; i++) {
+        values[0][i] = CS_ACCESSES_UNKNOWN;
+    }
+    memset(is_queued, 0, sizeof is_queued);
+    BIT_SET(is_queued, 0);
+    queue[depth++] = 0;
+    while (depth) {
+        address = queue[--depth];
+        BIT_CLEAR(is_queued, address);
+        machine_instruction = cs->memory.rom[address];
+        memcpy(incoming, values[address], sizeof incoming);
+
+        /* A subroutine starts with the registers of every CALL to it */
+        if (CS_GET_OPCODE(machine_instruction) == CS_INS_I_CALL) {
+            successors[0] = (unsigned char)CS_GET_ARG_B(machine_instruction);
+            if (cs_accesses_merge(values[successors[0]], incoming) && !BIT_TEST(is_queued, successors[0])) {
+                BIT_SET(is_queued, successors[0]);
+                queue[depth++] = successors[0];
+            }
+        }
+
+        cs_accesses_transfer(cs, written, machine_instruction, incoming);
+        amount = cs_accesses_get_successors(machine_instruction, (unsigned char)address, successors);
+        while (amount--) {
+            if (cs_accesses_merge(values[successors[amount]], incoming) &&
+                !BIT_TEST(is_queued, successors[amount])) {
+                BIT_SET(is_queued, successors[amount]);
+                queue[depth++] = successors[amount];
+            }
+        }
+    }
+
+    for (address = 0; address < CS_ROM_SIZE; address++) {
+        machine_instruction              = cs->memory.rom[address];
+        cs->accesses->constants[address] = CS_ACCESSES_NONE;
+        switch (CS_GET_OPCODE(machine_instruction)) {
+            case CS_INS_I_LDS:
+            case CS_INS_I_STS:
+                cs->accesses->constants[address] = CS_GET_ARG_B(machine_instruction);
+                break;
+            case CS_INS_I_LD:
+            case CS_INS_I_ST:
+                if (values[address][CS_GET_REG_B(machine_instruction)] < CS_ACCESSES_UNKNOWN) {
+                    cs->accesses->constants[address] = values[address][CS_GET_REG_B(machine_instruction)];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    cs_accesses_classify(cs);
+}
+
+void cs_accesses_classify(cs_machine *cs) {
+    cs_accesses *accesses = cs->accesses;
+    size_t       i;
+
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        if (accesses->constants[i] != CS_ACCESSES_NONE && !CS_ACCESSES_IS_IO(accesses, accesses->constants[i])) {
+            accesses->addresses[i] = accesses->constants[i];
+        } else {
+            accesses->addresses[i] = CS_ACCESSES_NONE;
+        }
+    }
+}
+
+void cs_set_io_addresses(cs_machine *cs, unsigned char const *addresses) {
+    if (addresses) {
+        memcpy(cs->accesses->io, addresses, sizeof cs->accesses->io);
+    } else {
+        memset(cs->accesses->io, 0xFF, sizeof cs->accesses->io);
+    }
+    cs_accesses_classify(cs);
+}
+
+int cs_get_access_class(cs_machine const *cs, unsigned char address) {
+    switch (CS_GET_OPCODE(cs->memory.rom[address])) {
+        case CS_INS_I_LD:
+        case CS_INS_I_ST:
+        case CS_INS_I_LDS:
+        case CS_INS_I_STS:
+            return cs->accesses->addresses[address] == CS_ACCESSES_NONE ? CS_ACCESS_IO : CS_ACCESS_RAM;
+        default:
+            return CS_ACCESS_NONE;
+    }
+}
@@ -0,0 +1,43 @@
+/** @file cs_accesses.h */
+
+#ifndef CS_ACCESSES_H
+#define CS_ACCESSES_H
+
+#include "cs.h"
+
+/** @brief Address standing for an access not proven to stay in RAM */
+#define CS_ACCESSES_NONE 0xFFFFu
+
+/** @brief Checks whether the I/O handlers may control a RAM address */
+#define CS_ACCESSES_IS_IO(accesses, address) BIT_TEST((accesses)->io, address)
+
+typedef struct cs_accesses cs_accesses;
+
+/** @brief Memory accesses of the program in ROM, classified at load time */
+struct cs_accesses {
+    /** @brief Address accessed by the LD, ST, LDS or STS at each ROM
+     *      address if it's always the same one, or CS_ACCESSES_NONE */
+    unsigned short constants[CS_ROM_SIZE];
+    /** @brief Constant addresses which the I/O handlers don't control, or
+     *      CS_ACCESSES_NONE: the accesses proven to stay in RAM */
+    unsigned short addresses[CS_ROM_SIZE];
+    /** @brief RAM addresses the I/O handlers may control */
+    unsigned char io[CS_RAM_SIZE / 8];
+};
+
+/**
+ * @brief Finds the constant addresses of the memory accesses in ROM,
+ *      propagating the constants loaded to the registers from the entry,
+ *      and classifies them
+ * @param cs Pointer to the emulation instance
+ */
+void cs_accesses_analyze(cs_machine *cs);
+
+/**
+ * @brief Classifies the constant addresses of the memory accesses in ROM
+ *      as RAM or I/O, after the I/O addresses change
+ * @param cs Pointer to the emulation instance
+ */
+void cs_accesses_classify(cs_machine *cs);
+
+#endif /* CS_ACCESSES_H */
@@ -0,0 +1,82 @@
+/** @file cs_breakpoints.c */
+
+#include <stdlib.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_breakpoints.h"
+
+cs_breakpoints *cs_breakpoints_get(cs_machine *cs) {
+    if (!cs->breakpoints) {
+        cs->breakpoints = calloc(1, sizeof *cs->breakpoints);
+    }
+    return cs->breakpoints;
+}
+
+static void cs_breakpoints_set_bit(cs_breakpoints *breakpoints, unsigned char *bitmap, unsigned char address,
+                                   bool enabled) {
+    if (!BIT_TEST(bitmap, address) == !enabled) {
+        return;
+    }
+    if (enabled) {
+        BIT_SET(bitmap, address);
+        breakpoints->bits_amount++;
+    } else {
+        BIT_CLEAR(bitmap, address);
+        breakpoints->bits_amount--;
+    }
+}
+
+void cs_breakpoints_watch(cs_machine *cs, size_t offset, unsigned char flags) {
+    cs_breakpoints *breakpoints = cs->breakpoints;
+    unsigned char  *bitmap      = flags & CS_WATCH_READ ? breakpoints->read : breakpoints->write;
+
+    if ((flags & CS_WATCH_WRITE) && BIT_TEST(breakpoints->condition_write, offset)) {
+        breakpoints->condition_dirty = true;
+    }
+
+    /* Keep the first hit of the instruction */
+    if (BIT_TEST(bitmap, offset) && !breakpoints->hit_flags) {
+        breakpoints->hit_flags   = flags;
+        breakpoints->hit_address = offset;
+    }
+}
+
+bool cs_breakpoint_set(cs_machine *cs, unsigned char address, bool enabled) {
+    cs_breakpoints *breakpoints = cs_breakpoints_get(cs);
+
+    if (!breakpoints) {
+        return false;
+    }
+    cs_breakpoints_set_bit(breakpoints, breakpoints->pc, address, enabled);
+    return true;
+}
+
+bool cs_watchpoint_set(cs_machine *cs, unsigned char address, unsigned char flags) {
+    cs_breakpoints *breakpoints = cs_breakpoints_get(cs);
+
+    if (!breakpoints) {
+        return false;
+    }
+    cs_breakpoints_set_bit(breakpoints, breakpoints->read, address, flags & CS_WATCH_READ);
+    cs_breakpoints_set_bit(breakpoints, breakpoints->write, address, flags & CS_WATCH_WRITE);
+    return true;
+}
+
+void cs_breakpoints_clear(cs_machine *cs) {
+    if (cs->breakpoints) {
+        cs_condition_free_all(cs);
+        free(cs->breakpoints);
+        cs->breakpoints = 0;
+    }
+}
+
+unsigned char cs_watchpoint_get_hit(cs_machine const *cs, unsigned char *address) {
+    if (!cs->breakpoints || !cs->breakpoints->hit_flags) {
+        return 0;
+    }
+    if (address) {
+        *address = cs->breakpoints->hit_address;
+    }
+    return cs->breakpoints->hit_flags;
+}
@@ -0,0 +1,59 @@
+/** @file cs_breakpoints.h */
+
+#ifndef CS_BREAKPOINTS_H
+#define CS_BREAKPOINTS_H
+
+#include "cs.h"
+#include "cs_condition.h"
+
+/** @brief Whether any breakpoint, watchpoint or condition is set, so cs_run must check them */
+#define CS_BREAKPOINTS_IS_ACTIVE(breakpoints) ((breakpoints)->bits_amount || (breakpoints)->conditions_amount)
+
+typedef struct cs_breakpoints cs_breakpoints;
+
+/** @brief Breakpoint and watchpoint bitmaps */
+struct cs_breakpoints {
+    /** @brief ROM addresses where cs_run stops before executing */
+    unsigned char pc[CS_ROM_SIZE / 8];
+    /** @brief RAM addresses where cs_run stops after a read */
+    unsigned char read[CS_RAM_SIZE / 8];
+    /** @brief RAM addresses where cs_run stops after a write */
+    unsigned char write[CS_RAM_SIZE / 8];
+    /** @brief Amount of bits set in pc, read and write */
+    size_t bits_amount;
+    /** @brief CS_WATCH_READ or CS_WATCH_WRITE if a watchpoint was hit */
+    unsigned char hit_flags;
+    /** @brief RAM address of the watchpoint hit */
+    unsigned char hit_address;
+    /** @brief Conditional breakpoints */
+    cs_condition *conditions;
+    size_t        conditions_amount;
+    /** @brief Identifier of the next condition added */
+    size_t next_condition_id;
+    /** @brief Instruction addresses where any condition may hold */
+    unsigned char condition_pc[CS_ROM_SIZE / 8];
+    /** @brief RAM addresses that on_write conditions depend on */
+    unsigned char condition_write[CS_RAM_SIZE / 8];
+    /** @brief Whether an address of condition_write was written since the last check */
+    bool condition_dirty;
+    /** @brief Whether a condition held, and its identifier */
+    bool   condition_hit;
+    size_t condition_hit_id;
+};
+
+/**
+ * @brief Gets the breakpoints of an emulation instance, creating them if needed
+ * @param cs Pointer to the emulation instance
+ * @return Pointer to the breakpoints, or null pointer if no enough memory is available
+ */
+cs_breakpoints *cs_breakpoints_get(cs_machine *cs);
+
+/**
+ * @brief Notifies a memory access, recording it if it hits a watchpoint
+ * @param cs Pointer to the emulation instance
+ * @param offset RAM address
+ * @param flags CS_WATCH_READ or CS_WATCH_WRITE
+ */
+void cs_breakpoints_watch(cs_machine *cs, size_t offset, unsigned char flags);
+
+#endif /* CS_BREAKPOINTS_H */
@@ -0,0 +1,241 @@
+/** @file cs_call_graph.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_instructions.h"
+#include "cs_profiler.h"
+#include "cs_report.h"
+
+#include "cs_call_graph.h"
+
+static void cs_call_graph_attribute(cs_machine *cs) {
+    cs_call_graph       *call_graph = cs->call_graph;
+    cs_call_graph_frame *frame      = &call_graph->frames[call_graph->depth - 1];
+    unsigned long long   cycles     = cs->cycles - call_graph->last_cycle;
+
+    call_graph->nodes[frame->node].exclusive_cycles += cycles;
+    call_graph->entries[frame->entry].exclusive_cycles += cycles;
+    call_graph->last_cycle = cs->cycles;
+}
+
+static void cs_call_graph_push(cs_machine *cs, unsigned char entry) {
+    cs_call_graph       *call_graph = cs->call_graph;
+    cs_call_graph_frame *frame;
+    unsigned short       parent;
+    unsigned short       node;
+
+    if (call_graph->depth == CS_CALL_GRAPH_MAX_DEPTH) {
+        return;
+    }
+
+    parent = call_graph->frames[call_graph->depth - 1].node;
+    node   = call_graph->nodes[parent].first_child;
+    while (node != CS_CALL_GRAPH_NO_NODE && call_graph->nodes[node].entry != entry) {
+        node = call_graph->nodes[node].next_sibling;
+    }
+
+    if (node == CS_CALL_GRAPH_NO_NODE) {
+        if (call_graph->nodes_amount < CS_CALL_GRAPH_MAX_NODES) {
+            node                                     = call_graph->nodes_amount++;
+            call_graph->nodes[node].exclusive_cycles = 0;
+            call_graph->nodes[node].entry            = entry;
+            call_graph->nodes[node].parent           = parent;
+            call_graph->nodes[node].first_child      = CS_CALL_GRAPH_NO_NODE;
+            call_graph->nodes[node].next_sibling     = call_graph->nodes[parent].first_child;
+            call_graph->nodes[parent].first_child    = node;
+        } else {
+            /* Out of paths, keep attributing the path to the caller */
+            node = parent;
+        }
+    }
+
+    frame              = &call_graph->frames[call_graph->depth++];
+    frame->start_cycle = cs->cycles;
+    frame->node        = node;
+    frame->entry       = entry;
+    frame->sp          = cs->registers.sp;
+
+    call_graph->entries[entry].calls++;
+    call_graph->active[entry]++;
+}
+
+static void cs_call_graph_pop(cs_machine *cs) {
+    cs_call_graph       *call_graph = cs->call_graph;
+    cs_call_graph_frame *frame;
+
+    /* Drop every call whose return address is no longer on the stack */
+    while (call_graph->depth > 1 && call_graph->frames[call_graph->depth - 1].sp < cs->registers.sp) {
+        frame = &call_graph->frames[--call_graph->depth];
+        if (!--call_graph->active[frame->entry]) {
+            call_graph->entries[frame->entry].inclusive_cycles += cs->cycles - frame->start_cycle;
+        }
+    }
+}
+
+void cs_call_graph_tick(cs_machine *cs) {
+    cs_call_graph_attribute(cs);
+
+    switch (CS_GET_OPCODE(cs->registers.ir)) {
+        case CS_INS_I_CALL:
+            cs_call_graph_push(cs, cs->registers.pc);
+            break;
+        case CS_INS_I_RET:
+            cs_call_graph_pop(cs);
+            break;
+        default:
+            break;
+    }
+}
+
+void cs_call_graph_enter(cs_machine *cs, unsigned char entry) {
+    cs_call_graph_attribute(cs);
+    cs_call_graph_push(cs, entry);
+}
+
+void cs_call_graph_restart(cs_machine *cs) {
+    cs_call_graph       *call_graph = cs->call_graph;
+    cs_call_graph_frame *root       = &call_graph->frames[0];
+
+    /* Calls in progress are dropped without counting their inclusive cycles */
+    memset(call_graph->active, 0, sizeof call_graph->active);
+
+    root->start_cycle = cs->cycles;
+    root->node        = 0;
+    root->entry       = call_graph->nodes[0].entry;
+    root->sp          = cs->registers.sp;
+
+    call_graph->depth      = 1;
+    call_graph->last_cycle = cs->cycles;
+    call_graph->entries[root->entry].calls++;
+    call_graph->active[root->entry]++;
+}
+
+bool cs_call_graph_enable(cs_machine *cs) {
+    cs_call_graph *call_graph;
+
+    if (cs->call_graph) {
+        return true;
+    }
+
+    call_graph = calloc(1, sizeof *call_graph);
+    if (!call_graph) {
+        return false;
+    }
+
+    /* The program start is the entry of the instruction in progress */
+    call_graph->nodes[0].entry        = cs->registers.pc - 1;
+    call_graph->nodes[0].parent       = CS_CALL_GRAPH_NO_NODE;
+    call_graph->nodes[0].first_child  = CS_CALL_GRAPH_NO_NODE;
+    call_graph->nodes[0].next_sibling = CS_CALL_GRAPH_NO_NODE;
+    call_graph->nodes_amount          = 1;
+
+    cs->call_graph = call_graph;
+    cs_call_graph_restart(cs);
+    return true;
+}
+
+void cs_call_graph_disable(cs_machine *cs) {
+    if (cs->call_graph) {
+        free(cs->call_graph);
+        cs->call_graph = 0;
+    }
+}
+
+void cs_call_graph_clear(cs_machine *cs) {
+    cs_call_graph *call_graph = cs->call_graph;
+    size_t         i;
+
+    if (!call_graph) {
+        return;
+    }
+
+    memset(call_graph->entries, 0, sizeof call_graph->entries);
+    for (i = 0; i < call_graph->nodes_amount; i++) {
+        call_graph->nodes[i].exclusive_cycles = 0;
+    }
+
+    /* Calls in progress start over from now */
+    for (i = 0; i < call_graph->depth; i++) {
+        call_graph->frames[i].start_cycle = cs->cycles;
+    }
+    call_graph->last_cycle = cs->cycles;
+}
+
+bool cs_call_graph_get_entries(cs_machine const *cs, cs_call_graph_entry *entries) {
+    cs_call_graph const       *call_graph = cs->call_graph;
+    cs_call_graph_frame const *frame;
+    bool                       counted[CS_ROM_SIZE] = {0};
+    size_t                     i;
+
+    if (!call_graph) {
+        return false;
+    }
+
+    memcpy(entries, call_graph->entries, sizeof call_graph->entries);
+
+    /* Add the cycles of the calls in progress, only once for recursive ones */
+    for (i = 0; i < call_graph->depth; i++) {
+        frame = &call_graph->frames[i];
+        if (!counted[frame->entry]) {
+            entries[frame->entry].inclusive_cycles += cs->cycles - frame->start_cycle;
+            counted[frame->entry] = true;
+        }
+    }
+    return true;
+}
+
+static void cs_call_graph_print_entry(cs_report_text *text, struct cs_as_machine_code const *machine_code,
+                                      char const *source, unsigned char entry) {
+    char const *label;
+    size_t      label_length = 0;
+
+    if (machine_code && source) {
+        label_length = cs_profiler_find_label_at(machine_code, source, entry, &label);
+    }
+
+    if (label_length) {
+        cs_report_printf(text, "%.*s", (int)label_length, label);
+    } else {
+        cs_report_printf(text, HEX8_X_FORMAT, entry);
+    }
+}
+
+char *cs_call_graph_export(cs_machine const *cs, struct cs_as_machine_code const *machine_code, char const *source) {
+    cs_call_graph const *call_graph = cs->call_graph;
+    cs_report_text       text       = {0, 0, 0, false};
+    unsigned short       path[CS_CALL_GRAPH_MAX_DEPTH];
+    size_t               path_length;
+    size_t               i;
+    unsigned short       node;
+
+    if (!call_graph) {
+        return 0;
+    }
+
+    for (i = 0; i < call_graph->nodes_amount; i++) {
+        if (!call_graph->nodes[i].exclusive_cycles) {
+            continue;
+        }
+
+        path_length = 0;
+        for (node = i; node != CS_CALL_GRAPH_NO_NODE; node = call_graph->nodes[node].parent) {
+            path[path_length++] = node;
+        }
+
+        while (path_length--) {
+            cs_call_graph_print_entry(&text, machine_code, source, call_graph->nodes[path[path_length]].entry);
+            cs_report_printf(&text, path_length ? ";" : " ");
+        }
+        cs_report_printf(&text, "%llu\n", call_graph->nodes[i].exclusive_cycles);
+    }
+
+    /* An empty graph is still a valid export */
+    if (!text.buffer && !text.failed) {
+        text.buffer = calloc(1, 1);
+    }
+
+    return cs_report_finish(&text);
+}
@@ -0,0 +1,82 @@
+/** @file cs_call_graph.h */
+
+#ifndef CS_CALL_GRAPH_H
+#define CS_CALL_GRAPH_H
+
+#include "cs.h"
+
+/** @brief Maximum amount of distinct call paths. Deeper calls are merged into their caller */
+#define CS_CALL_GRAPH_MAX_NODES 4096
+/** @brief Maximum depth of the shadow call stack */
+#define CS_CALL_GRAPH_MAX_DEPTH (CS_RAM_SIZE + 1)
+#define CS_CALL_GRAPH_NO_NODE   0xFFFF
+
+typedef struct cs_call_graph       cs_call_graph;
+typedef struct cs_call_graph_entry cs_call_graph_entry;
+
+/** @brief Call path, as a node of the tree of paths rooted at the program start */
+struct cs_call_graph_node {
+    /** @brief Cycles spent in this path outside of its callees */
+    unsigned long long exclusive_cycles;
+    unsigned short     parent;
+    unsigned short     first_child;
+    unsigned short     next_sibling;
+    /** @brief Subroutine entry address */
+    unsigned char entry;
+};
+typedef struct cs_call_graph_node cs_call_graph_node;
+
+/** @brief Active subroutine call */
+struct cs_call_graph_frame {
+    /** @brief Value of the cycle counter when the subroutine was called */
+    unsigned long long start_cycle;
+    /** @brief Call path node */
+    unsigned short node;
+    /** @brief Subroutine entry address */
+    unsigned char entry;
+    /** @brief Stack pointer right after the return address was pushed */
+    unsigned char sp;
+};
+typedef struct cs_call_graph_frame cs_call_graph_frame;
+
+/** @brief Call graph profiler state */
+struct cs_call_graph {
+    /** @brief Counters by subroutine entry address */
+    cs_call_graph_entry entries[CS_ROM_SIZE];
+    /** @brief Active calls of each subroutine entry address, so that
+     *      recursion only counts the outermost call as inclusive */
+    unsigned long active[CS_ROM_SIZE];
+    /** @brief Call path tree. Node 0 is the program start */
+    cs_call_graph_node nodes[CS_CALL_GRAPH_MAX_NODES];
+    size_t             nodes_amount;
+    /** @brief Shadow call stack. Frame 0 is the program start */
+    cs_call_graph_frame frames[CS_CALL_GRAPH_MAX_DEPTH];
+    size_t              depth;
+    /** @brief Value of the cycle counter at the last attribution */
+    unsigned long long last_cycle;
+};
+
+/**
+ * @brief Attributes the cycles of the instruction that has just been
+ *      completed and follows it if it was a CALL or RET. Must be called
+ *      before the next instruction is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_call_graph_tick(cs_machine *cs);
+
+/**
+ * @brief Pushes a call to a subroutine that wasn't issued by a CALL
+ *      instruction, such as an interrupt service routine
+ * @param cs Pointer to the emulation instance
+ * @param entry Subroutine entry address
+ */
+void cs_call_graph_enter(cs_machine *cs, unsigned char entry);
+
+/**
+ * @brief Drops the shadow call stack after the PC, the stack pointer or
+ *      the cycle counter have been reset
+ * @param cs Pointer to the emulation instance
+ */
+void cs_call_graph_restart(cs_machine *cs);
+
+#endif /* CS_CALL_GRAPH_H */
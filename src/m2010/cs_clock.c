@@ -0,0 +1,150 @@
+/** @file cs_clock.c */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
+#include "../../include/asm2010.h"
+
+#include "cs_clock.h"
+
+#define CS_CLOCK_NS_PER_SECOND      1000000000ull
+#define CS_CLOCK_NS_PER_MICROSECOND 1000ull
+
+/**
+ * @brief Reads the host monotonic clock
+ * @return Current time, in nanoseconds
+ */
+static unsigned long long cs_clock_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long)counter.QuadPart / frequency.QuadPart * CS_CLOCK_NS_PER_SECOND +
+           (unsigned long long)counter.QuadPart % frequency.QuadPart * CS_CLOCK_NS_PER_SECOND / frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * CS_CLOCK_NS_PER_SECOND + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Sleeps the calling thread until the given time
+ * @param deadline Host time to wake up at, in nanoseconds
+ */
+static void cs_clock_sleep_until(unsigned long long deadline) {
+    unsigned long long now = cs_clock_now();
+#ifdef _WIN32
+    if (deadline > now) {
+        Sleep((DWORD)((deadline - now) / (CS_CLOCK_NS_PER_SECOND / 1000)));
+    }
+#else
+    struct timespec remaining;
+    while (deadline > now) {
+        remaining.tv_sec  = (time_t)((deadline - now) / CS_CLOCK_NS_PER_SECOND);
+        remaining.tv_nsec = (long)((deadline - now) % CS_CLOCK_NS_PER_SECOND);
+        if (nanosleep(&remaining, 0) && errno != EINTR) {
+            break;
+        }
+        now = cs_clock_now();
+    }
+#endif
+}
+
+/**
+ * @brief Converts an amount of CS clock cycles to host time
+ * @param clock Pointer to the pacing state
+ * @param cycles Amount of cycles
+ * @return Duration of the cycles, in nanoseconds
+ */
+static unsigned long long cs_clock_cycles_to_ns(cs_clock const *clock, unsigned long long cycles) {
+    /* Split to avoid overflowing on long runs */
+    return cycles / clock->frequency * CS_CLOCK_NS_PER_SECOND +
+           cycles % clock->frequency * CS_CLOCK_NS_PER_SECOND / clock->frequency;
+}
+
+bool cs_clock_enable(cs_machine *cs, unsigned long frequency, unsigned long burst_period) {
+    if (!frequency) {
+        return false;
+    }
+
+    if (!cs->clock) {
+        cs->clock = malloc(sizeof *cs->clock);
+        if (!cs->clock) {
+            return false;
+        }
+    }
+
+    cs->clock->frequency    = frequency;
+    cs->clock->burst_cycles =
+        (unsigned long long)frequency * burst_period / (CS_CLOCK_NS_PER_SECOND / CS_CLOCK_NS_PER_MICROSECOND);
+    if (!cs->clock->burst_cycles) {
+        cs->clock->burst_cycles = 1;
+    }
+    cs->clock->epoch_time   = cs_clock_now();
+    cs->clock->epoch_cycles = cs->cycles;
+    return true;
+}
+
+void cs_clock_disable(cs_machine *cs) {
+    if (cs->clock) {
+        free(cs->clock);
+        cs->clock = 0;
+    }
+}
+
+int cs_clock_run(cs_machine *cs, unsigned long long max_cycles) {
+    cs_clock          *clock = cs->clock;
+    unsigned long long end_cycle;
+    unsigned long long burst;
+    unsigned long long max_lag;
+    unsigned long long deadline;
+    unsigned long long now;
+    int                result;
+
+    if (!clock) {
+        return CS_RUN_EXHAUSTED;
+    }
+
+    /* The cycle counter is reset along with the registers */
+    if (cs->cycles < clock->epoch_cycles) {
+        clock->epoch_time   = cs_clock_now();
+        clock->epoch_cycles = cs->cycles;
+    }
+
+    end_cycle = cs->cycles + max_cycles;
+    max_lag   = cs_clock_cycles_to_ns(clock, clock->burst_cycles * CS_CLOCK_MAX_LAG_BURSTS);
+    while (cs->cycles < end_cycle) {
+        deadline = clock->epoch_time + cs_clock_cycles_to_ns(clock, cs->cycles - clock->epoch_cycles);
+        now      = cs_clock_now();
+        if (now > deadline + max_lag) {
+            /* Too far behind: drop the missed time instead of catching up */
+            clock->epoch_time   = now;
+            clock->epoch_cycles = cs->cycles;
+        } else {
+            cs_clock_sleep_until(deadline);
+        }
+
+        burst = end_cycle - cs->cycles;
+        if (burst > clock->burst_cycles) {
+            burst = clock->burst_cycles;
+        }
+        result = cs_run(cs, burst);
+        if (result != CS_RUN_EXHAUSTED) {
+            return result;
+        }
+    }
+
+    return CS_RUN_EXHAUSTED;
+}
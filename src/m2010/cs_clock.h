@@ -0,0 +1,25 @@
+/** @file cs_clock.h */
+
+#ifndef CS_CLOCK_H
+#define CS_CLOCK_H
+
+#include "cs.h"
+
+/** @brief Bursts the host may fall behind before pacing resynchronizes */
+#define CS_CLOCK_MAX_LAG_BURSTS 4
+
+typedef struct cs_clock cs_clock;
+
+/** @brief Real-time pacing state */
+struct cs_clock {
+    /** @brief CS clock frequency, in Hz */
+    unsigned long frequency;
+    /** @brief Clock cycles executed per burst */
+    unsigned long long burst_cycles;
+    /** @brief Host time at which pacing started, in nanoseconds */
+    unsigned long long epoch_time;
+    /** @brief Machine cycle counter when pacing started */
+    unsigned long long epoch_cycles;
+};
+
+#endif /* CS_CLOCK_H */
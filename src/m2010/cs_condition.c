@@ -0,0 +1,646 @@
+/** @file cs_condition.c */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "../parse.h"
+
+#include "cs_breakpoints.h"
+#include "cs_profiler.h"
+
+#include "cs_condition.h"
+
+#define CS_CONDITION_MAX_IDENTIFIER_LENGTH 64
+
+/** @brief Register names and their state page offsets */
+static struct {
+    char const   *name;
+    unsigned char offset;
+} const cs_condition_registers[] = {
+    {"R0", CS_STATE_PAGE_OFFSET_R0},      {"R1", CS_STATE_PAGE_OFFSET_R0 + 1},  {"R2", CS_STATE_PAGE_OFFSET_R0 + 2},
+    {"R3", CS_STATE_PAGE_OFFSET_R0 + 3},  {"R4", CS_STATE_PAGE_OFFSET_R0 + 4},  {"R5", CS_STATE_PAGE_OFFSET_R0 + 5},
+    {"R6", CS_STATE_PAGE_OFFSET_R0 + 6},  {"R7", CS_STATE_PAGE_OFFSET_R0 + 7},  {"SP", CS_STATE_PAGE_OFFSET_SP},
+    {"PC", CS_STATE_PAGE_OFFSET_PC},      {"AC", CS_STATE_PAGE_OFFSET_AC},      {"SR", CS_STATE_PAGE_OFFSET_SR},
+    {"MDR", CS_STATE_PAGE_OFFSET_MDR},    {"MAR", CS_STATE_PAGE_OFFSET_MAR},    {"ADDR", CS_STATE_PAGE_OFFSET_IR_ADDR},
+};
+
+/** @brief Status register flag names */
+static struct {
+    char          name;
+    unsigned char mask;
+} const cs_condition_flags[] = {{'C', CS_SR_C}, {'Z', CS_SR_Z}, {'N', CS_SR_N}, {'V', CS_SR_V}};
+
+/** @brief Condition compilation state */
+struct cs_condition_compiler {
+    cs_machine                      *cs;
+    struct cs_as_machine_code const *machine_code;
+    char const                      *source;
+    /** @brief Current position in the uppercase expression */
+    char const   *position;
+    cs_condition *condition;
+    size_t        code_capacity;
+    /** @brief Evaluation stack depth after the code emitted so far */
+    size_t depth;
+    size_t changed_amount;
+    /** @brief Whether the condition reads registers, or RAM at a computed address */
+    bool uses_registers;
+    bool uses_dynamic_ram;
+    /** @brief RAM addresses read */
+    unsigned char ram[CS_RAM_SIZE / 8];
+    int           status;
+};
+typedef struct cs_condition_compiler cs_condition_compiler;
+
+static void cs_condition_compile_or(cs_condition_compiler *compiler);
+
+static void cs_condition_fail(cs_condition_compiler *compiler, int status) {
+    if (compiler->status == CS_CONDITION_OK) {
+        compiler->status = status;
+    }
+}
+
+static void cs_condition_emit(cs_condition_compiler *compiler, unsigned char byte) {
+    cs_condition  *condition = compiler->condition;
+    unsigned char *code;
+    size_t         capacity;
+
+    if (condition->code_length == compiler->code_capacity) {
+        capacity = compiler->code_capacity ? compiler->code_capacity * 2 : 32;
+        code     = realloc(condition->code, capacity);
+        if (!code) {
+            cs_condition_fail(compiler, CS_CONDITION_FAILED);
+            return;
+        }
+        condition->code         = code;
+        compiler->code_capacity = capacity;
+    }
+    condition->code[condition->code_length++] = byte;
+}
+
+/**
+ * @brief Emits an opcode, keeping track of the evaluation stack depth
+ * @param compiler Pointer to the compilation state
+ * @param op Opcode
+ * @param pushes Whether the opcode pushes a value (true) or pops one
+ *      value of two (false). Unary opcodes don't change the depth
+ */
+static void cs_condition_emit_op(cs_condition_compiler *compiler, unsigned char op, bool pushes) {
+    cs_condition_emit(compiler, op);
+    if (pushes) {
+        if (++compiler->depth > CS_CONDITION_MAX_STACK) {
+            cs_condition_fail(compiler, CS_CONDITION_TOO_COMPLEX);
+        }
+    } else if (op != CS_CONDITION_OP_NOT && op != CS_CONDITION_OP_RAM) {
+        compiler->depth--;
+    }
+}
+
+static void cs_condition_emit_const(cs_condition_compiler *compiler, size_t value) {
+    cs_condition_emit_op(compiler, CS_CONDITION_OP_CONST, true);
+    cs_condition_emit(compiler, value & 0xFFu);
+    cs_condition_emit(compiler, (value >> 8) & 0xFFu);
+}
+
+static bool cs_condition_accept(cs_condition_compiler *compiler, char const *token) {
+    size_t length = strlen(token);
+
+    skip_spaces(&compiler->position);
+    if (strncmp(compiler->position, token, length)) {
+        return false;
+    }
+    compiler->position += length;
+    return true;
+}
+
+static void cs_condition_expect(cs_condition_compiler *compiler, char const *token) {
+    if (!cs_condition_accept(compiler, token)) {
+        cs_condition_fail(compiler, CS_CONDITION_SYNTAX_ERROR);
+    }
+}
+
+/**
+ * @brief Parses a number or a label
+ * @param compiler Pointer to the compilation state
+ * @param value Pointer where the value will be stored
+ * @return true if success, false otherwise
+ */
+static bool cs_condition_parse_constant(cs_condition_compiler *compiler, size_t *value) {
+    char *identifier;
+    int   status;
+    bool  found = false;
+
+    skip_spaces(&compiler->position);
+    if (isdigit((unsigned char)*compiler->position) || *compiler->position == '$') {
+        *value = retrieve_value(&compiler->position, &status, 0xFFFFu, skip_spaces);
+        if (status != RETRIEVE_VALUE_OK) {
+            cs_condition_fail(compiler, CS_CONDITION_SYNTAX_ERROR);
+            return false;
+        }
+        return true;
+    }
+
+    identifier = retrieve_alnum_identifier(&compiler->position, CS_CONDITION_MAX_IDENTIFIER_LENGTH, skip_spaces);
+    if (!identifier) {
+        cs_condition_fail(compiler, CS_CONDITION_SYNTAX_ERROR);
+        return false;
+    }
+    if (compiler->machine_code && compiler->source) {
+        found = cs_profiler_find_label_address(compiler->machine_code, compiler->source, identifier,
+                                               strlen(identifier), value);
+    }
+    free(identifier);
+    if (!found) {
+        cs_condition_fail(compiler, CS_CONDITION_UNKNOWN_LABEL);
+    }
+    return found;
+}
+
+static void cs_condition_compile_ram(cs_condition_compiler *compiler) {
+    size_t start = compiler->condition->code_length;
+    size_t address;
+
+    cs_condition_expect(compiler, "[");
+    cs_condition_compile_or(compiler);
+    cs_condition_expect(compiler, "]");
+
+    /* A constant address is a dependency known in advance */
+    if (compiler->condition->code_length == start + 3 && compiler->condition->code[start] == CS_CONDITION_OP_CONST) {
+        address = compiler->condition->code[start + 1];
+        BIT_SET(compiler->ram, address);
+    } else {
+        compiler->uses_dynamic_ram = true;
+    }
+    cs_condition_emit_op(compiler, CS_CONDITION_OP_RAM, false);
+}
+
+static void cs_condition_compile_changed(cs_condition_compiler *compiler) {
+    size_t        address = 0;
+    unsigned char slot;
+
+    cs_condition_expect(compiler, "(");
+    cs_condition_expect(compiler, "RAM");
+    cs_condition_expect(compiler, "[");
+    if (compiler->status != CS_CONDITION_OK || !cs_condition_parse_constant(compiler, &address)) {
+        return;
+    }
+    cs_condition_expect(compiler, "]");
+    cs_condition_expect(compiler, ")");
+
+    if (compiler->changed_amount == CS_CONDITION_MAX_CHANGED) {
+        cs_condition_fail(compiler, CS_CONDITION_TOO_COMPLEX);
+        return;
+    }
+
+    address &= 0xFFu;
+    slot = compiler->changed_amount++;
+    compiler->condition->changed[slot] = compiler->cs->memory.ram[address];
+    BIT_SET(compiler->ram, address);
+    cs_condition_emit_op(compiler, CS_CONDITION_OP_CHANGED, true);
+    cs_condition_emit(compiler, address);
+    cs_condition_emit(compiler, slot);
+}
+
+static void cs_condition_compile_flag(cs_condition_compiler *compiler) {
+    size_t i;
+
+    for (i = 0; i < sizeof cs_condition_flags / sizeof *cs_condition_flags; i++) {
+        if (*compiler->position == cs_condition_flags[i].name) {
+            compiler->position++;
+            cs_condition_emit_op(compiler, CS_CONDITION_OP_BYTE, true);
+            cs_condition_emit(compiler, CS_STATE_PAGE_OFFSET_SR);
+            cs_condition_emit_const(compiler, cs_condition_flags[i].mask);
+            cs_condition_emit_op(compiler, CS_CONDITION_OP_AND, false);
+            return;
+        }
+    }
+    cs_condition_fail(compiler, CS_CONDITION_SYNTAX_ERROR);
+}
+
+static void cs_condition_compile_primary(cs_condition_compiler *compiler) {
+    char const *start;
+    char       *identifier;
+    size_t      value;
+    size_t      i;
+
+    skip_spaces(&compiler->position);
+    if (cs_condition_accept(compiler, "(")) {
+        cs_condition_compile_or(compiler);
+        cs_condition_expect(compiler, ")");
+        return;
+    }
+
+    if (isdigit((unsigned char)*compiler->position) || *compiler->position == '$') {
+        if (cs_condition_parse_constant(compiler, &value)) {
+            cs_condition_emit_const(compiler, value);
+        }
+        return;
+    }
+
+    start      = compiler->position;
+    identifier = retrieve_alnum_identifier(&compiler->position, CS_CONDITION_MAX_IDENTIFIER_LENGTH, skip_spaces);
+    if (!identifier) {
+        cs_condition_fail(compiler, CS_CONDITION_SYNTAX_ERROR);
+        return;
+    }
+
+    if (!strcmp(identifier, "RAM")) {
+        cs_condition_compile_ram(compiler);
+    } else if (!strcmp(identifier, "CHANGED")) {
+        cs_condition_compile_changed(compiler);
+    } else if (!strcmp(identifier, "IR")) {
+        compiler->uses_registers = true;
+        cs_condition_emit_op(compiler, CS_CONDITION_OP_IR, true);
+    } else if (!strcmp(identifier, "SR") && *compiler->position == '.') {
+        compiler->position++;
+        compiler->uses_registers = true;
+        cs_condition_compile_flag(compiler);
+    } else {
+        for (i = 0; i < sizeof cs_condition_registers / sizeof *cs_condition_registers; i++) {
+            if (!strcmp(identifier, cs_condition_registers[i].name)) {
+                compiler->uses_registers = true;
+                cs_condition_emit_op(compiler, CS_CONDITION_OP_BYTE, true);
+                cs_condition_emit(compiler, cs_condition_registers[i].offset);
+                break;
+            }
+        }
+
+        /* Anything else must be a label */
+        if (i == sizeof cs_condition_registers / sizeof *cs_condition_registers) {
+            compiler->position = start;
+            if (cs_condition_parse_constant(compiler, &value)) {
+                cs_condition_emit_const(compiler, value);
+            }
+        }
+    }
+    free(identifier);
+}
+
+static void cs_condition_compile_unary(cs_condition_compiler *compiler) {
+    skip_spaces(&compiler->position);
+    if (compiler->position[0] == '!' && compiler->position[1] != '=') {
+        compiler->position++;
+        cs_condition_compile_unary(compiler);
+        cs_condition_emit_op(compiler, CS_CONDITION_OP_NOT, false);
+    } else {
+        cs_condition_compile_primary(compiler);
+    }
+}
+
+static void cs_condition_compile_additive(cs_condition_compiler *compiler) {
+    unsigned char op;
+
+    cs_condition_compile_unary(compiler);
+    while (compiler->status == CS_CONDITION_OK) {
+        skip_spaces(&compiler->position);
+        if (*compiler->position == '+') {
+            op = CS_CONDITION_OP_ADD;
+        } else if (*compiler->position == '-') {
+            op = CS_CONDITION_OP_SUB;
+        } else {
+            break;
+        }
+        compiler->position++;
+        cs_condition_compile_unary(compiler);
+        cs_condition_emit_op(compiler, op, false);
+    }
+}
+
+static void cs_condition_compile_bitwise_and(cs_condition_compiler *compiler) {
+    cs_condition_compile_additive(compiler);
+    while (compiler->status == CS_CONDITION_OK) {
+        skip_spaces(&compiler->position);
+        if (compiler->position[0] != '&' || compiler->position[1] == '&') {
+            break;
+        }
+        compiler->position++;
+        cs_condition_compile_additive(compiler);
+        cs_condition_emit_op(compiler, CS_CONDITION_OP_AND, false);
+    }
+}
+
+static void cs_condition_compile_comparison(cs_condition_compiler *compiler) {
+    /* Longer operators first */
+    static struct {
+        char const   *token;
+        unsigned char op;
+    } const operators[] = {
+        {"==", CS_CONDITION_OP_EQ}, {"!=", CS_CONDITION_OP_NE}, {"<=", CS_CONDITION_OP_LE},
+        {">=", CS_CONDITION_OP_GE}, {"<", CS_CONDITION_OP_LT},  {">", CS_CONDITION_OP_GT},
+    };
+    size_t i;
+
+    cs_condition_compile_bitwise_and(compiler);
+    for (i = 0; i < sizeof operators / sizeof *operators; i++) {
+        if (cs_condition_accept(compiler, operators[i].token)) {
+            cs_condition_compile_bitwise_and(compiler);
+            cs_condition_emit_op(compiler, operators[i].op, false);
+            return;
+        }
+    }
+}
+
+static void cs_condition_compile_and(cs_condition_compiler *compiler) {
+    cs_condition_compile_comparison(compiler);
+    while (compiler->status == CS_CONDITION_OK && cs_condition_accept(compiler, "&&")) {
+        cs_condition_compile_comparison(compiler);
+        cs_condition_emit_op(compiler, CS_CONDITION_OP_LAND, false);
+    }
+}
+
+static void cs_condition_compile_or(cs_condition_compiler *compiler) {
+    cs_condition_compile_and(compiler);
+    while (compiler->status == CS_CONDITION_OK && cs_condition_accept(compiler, "||")) {
+        cs_condition_compile_and(compiler);
+        cs_condition_emit_op(compiler, CS_CONDITION_OP_LOR, false);
+    }
+}
+
+static unsigned int cs_condition_binary(unsigned char op, unsigned int a, unsigned int b) {
+    switch (op) {
+        case CS_CONDITION_OP_ADD:
+            return (a + b) & 0xFFFFu;
+        case CS_CONDITION_OP_SUB:
+            return (a - b) & 0xFFFFu;
+        case CS_CONDITION_OP_AND:
+            return a & b;
+        case CS_CONDITION_OP_EQ:
+            return a == b;
+        case CS_CONDITION_OP_NE:
+            return a != b;
+        case CS_CONDITION_OP_LT:
+            return a < b;
+        case CS_CONDITION_OP_LE:
+            return a <= b;
+        case CS_CONDITION_OP_GT:
+            return a > b;
+        case CS_CONDITION_OP_GE:
+            return a >= b;
+        case CS_CONDITION_OP_LAND:
+            return a && b;
+        case CS_CONDITION_OP_LOR:
+        default:
+            return a || b;
+    }
+}
+
+/**
+ * @brief Evaluates a condition for a given instruction address, with
+ *      every other register and the RAM unknown
+ * @param condition Pointer to the condition
+ * @param address Instruction address
+ * @return false if the condition can't hold at the address, true otherwise
+ */
+static bool cs_condition_may_hold(cs_condition const *condition, unsigned char address) {
+    unsigned int         values[CS_CONDITION_MAX_STACK];
+    bool                 known[CS_CONDITION_MAX_STACK];
+    unsigned char const *code = condition->code;
+    size_t               top  = 0;
+    size_t               pc   = 0;
+    unsigned char        op;
+    bool                 absorbing;
+
+    while (pc < condition->code_length) {
+        op = code[pc++];
+        switch (op) {
+            case CS_CONDITION_OP_CONST:
+                values[top]  = code[pc] | (unsigned int)code[pc + 1] << 8;
+                known[top++] = true;
+                pc += 2;
+                break;
+            case CS_CONDITION_OP_BYTE:
+                values[top]  = address;
+                known[top++] = code[pc++] == CS_STATE_PAGE_OFFSET_IR_ADDR;
+                break;
+            case CS_CONDITION_OP_IR:
+                known[top++] = false;
+                break;
+            case CS_CONDITION_OP_CHANGED:
+                known[top++] = false;
+                pc += 2;
+                break;
+            case CS_CONDITION_OP_RAM:
+                known[top - 1] = false;
+                break;
+            case CS_CONDITION_OP_NOT:
+                values[top - 1] = !values[top - 1];
+                break;
+            default:
+                top--;
+                if (op == CS_CONDITION_OP_LAND || op == CS_CONDITION_OP_LOR || op == CS_CONDITION_OP_AND) {
+                    /* A known operand may decide the result: false for && and &, true for || */
+                    absorbing = op == CS_CONDITION_OP_LOR;
+                    if ((known[top - 1] && !values[top - 1] == !absorbing) ||
+                        (known[top] && !values[top] == !absorbing)) {
+                        values[top - 1] = absorbing;
+                        known[top - 1]  = true;
+                        break;
+                    }
+                }
+                known[top - 1]  = known[top - 1] && known[top];
+                values[top - 1] = cs_condition_binary(op, values[top - 1], values[top]);
+                break;
+        }
+    }
+    return !known[0] || values[0];
+}
+
+static bool cs_condition_evaluate(cs_machine *cs, cs_condition *condition) {
+    unsigned int         stack[CS_CONDITION_MAX_STACK];
+    unsigned char const *code = condition->code;
+    unsigned char const *page = cs_get_state_page(cs);
+    size_t               top  = 0;
+    size_t               pc   = 0;
+    unsigned char        op;
+
+    while (pc < condition->code_length) {
+        op = code[pc++];
+        switch (op) {
+            case CS_CONDITION_OP_CONST:
+                stack[top++] = code[pc] | (unsigned int)code[pc + 1] << 8;
+                pc += 2;
+                break;
+            case CS_CONDITION_OP_BYTE:
+                stack[top++] = page[code[pc++]];
+                break;
+            case CS_CONDITION_OP_IR:
+                stack[top++] = cs->registers.ir;
+                break;
+            case CS_CONDITION_OP_CHANGED:
+                stack[top++] = cs->memory.ram[code[pc]] != condition->changed[code[pc + 1]];
+                condition->changed[code[pc + 1]] = cs->memory.ram[code[pc]];
+                pc += 2;
+                break;
+            case CS_CONDITION_OP_RAM:
+                stack[top - 1] = cs->memory.ram[stack[top - 1] & 0xFFu];
+                break;
+            case CS_CONDITION_OP_NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            default:
+                top--;
+                stack[top - 1] = cs_condition_binary(op, stack[top - 1], stack[top]);
+                break;
+        }
+    }
+    return stack[0] != 0;
+}
+
+bool cs_condition_check(cs_machine *cs) {
+    cs_breakpoints *breakpoints = cs->breakpoints;
+    cs_condition   *condition;
+    bool            dirty  = breakpoints->condition_dirty;
+    bool            is_hit = false;
+    bool            is_relevant;
+    size_t          i;
+
+    /* Every relevant condition is evaluated, even after one holds, so that
+     * none misses the write and changed() sees every value. The first one
+     * holding is reported */
+    breakpoints->condition_dirty = false;
+    for (i = 0; i < breakpoints->conditions_amount; i++) {
+        condition   = &breakpoints->conditions[i];
+        is_relevant = condition->on_write ? dirty : BIT_TEST(condition->pc, cs->instruction_address);
+        if (is_relevant && cs_condition_evaluate(cs, condition) && !is_hit) {
+            breakpoints->condition_hit    = true;
+            breakpoints->condition_hit_id = condition->id;
+            is_hit                        = true;
+        }
+    }
+    return is_hit;
+}
+
+/**
+ * @brief Rebuilds the bitmaps of the events where conditions are evaluated
+ * @param breakpoints Pointer to the breakpoints
+ */
+static void cs_condition_update(cs_breakpoints *breakpoints) {
+    cs_condition const *condition;
+    size_t              i;
+    size_t              j;
+
+    memset(breakpoints->condition_pc, 0, sizeof breakpoints->condition_pc);
+    memset(breakpoints->condition_write, 0, sizeof breakpoints->condition_write);
+    for (i = 0; i < breakpoints->conditions_amount; i++) {
+        condition = &breakpoints->conditions[i];
+        for (j = 0; j < CS_ROM_SIZE / 8; j++) {
+            breakpoints->condition_pc[j] |= condition->pc[j];
+            breakpoints->condition_write[j] |= condition->write[j];
+        }
+    }
+}
+
+void cs_condition_free_all(cs_machine *cs) {
+    cs_breakpoints *breakpoints = cs->breakpoints;
+    size_t          i;
+
+    for (i = 0; i < breakpoints->conditions_amount; i++) {
+        free(breakpoints->conditions[i].code);
+    }
+    free(breakpoints->conditions);
+    breakpoints->conditions        = 0;
+    breakpoints->conditions_amount = 0;
+    cs_condition_update(breakpoints);
+}
+
+int cs_condition_add(cs_machine *cs, char const *expression, struct cs_as_machine_code const *machine_code,
+                     char const *source, size_t *id) {
+    cs_breakpoints       *breakpoints = cs_breakpoints_get(cs);
+    cs_condition_compiler compiler;
+    cs_condition          condition;
+    cs_condition         *conditions;
+    char                 *upper_expression;
+    size_t                i;
+
+    if (!breakpoints) {
+        return CS_CONDITION_FAILED;
+    }
+
+    upper_expression = malloc(strlen(expression) + 1);
+    if (!upper_expression) {
+        return CS_CONDITION_FAILED;
+    }
+    for (i = 0; expression[i]; i++) {
+        upper_expression[i] = toupper((unsigned char)expression[i]);
+    }
+    upper_expression[i] = '\0';
+
+    memset(&condition, 0, sizeof condition);
+    memset(&compiler, 0, sizeof compiler);
+    compiler.cs           = cs;
+    compiler.machine_code = machine_code;
+    compiler.source       = source;
+    compiler.position     = upper_expression;
+    compiler.condition    = &condition;
+    compiler.status       = CS_CONDITION_OK;
+
+    cs_condition_compile_or(&compiler);
+    if (skip_spaces(&compiler.position) != PARSE_LINE_END) {
+        cs_condition_fail(&compiler, CS_CONDITION_SYNTAX_ERROR);
+    }
+    free(upper_expression);
+
+    conditions = compiler.status == CS_CONDITION_OK ? realloc(breakpoints->conditions,
+                                                              sizeof *conditions * (breakpoints->conditions_amount + 1))
+                                                    : 0;
+    if (!conditions) {
+        free(condition.code);
+        return compiler.status == CS_CONDITION_OK ? CS_CONDITION_FAILED : compiler.status;
+    }
+    breakpoints->conditions = conditions;
+
+    /* Conditions on fixed RAM addresses only change when those are written */
+    for (i = 0; i < CS_RAM_SIZE / 8 && !compiler.ram[i]; i++)
+        ;
+    condition.on_write = !compiler.uses_registers && !compiler.uses_dynamic_ram && i < CS_RAM_SIZE / 8;
+    if (condition.on_write) {
+        memcpy(condition.write, compiler.ram, sizeof condition.write);
+    } else {
+        for (i = 0; i < CS_ROM_SIZE; i++) {
+            if (cs_condition_may_hold(&condition, i)) {
+                BIT_SET(condition.pc, i);
+            }
+        }
+    }
+
+    condition.id = breakpoints->next_condition_id++;
+    breakpoints->conditions[breakpoints->conditions_amount++] = condition;
+    cs_condition_update(breakpoints);
+    if (id) {
+        *id = condition.id;
+    }
+    return CS_CONDITION_OK;
+}
+
+bool cs_condition_remove(cs_machine *cs, size_t id) {
+    cs_breakpoints *breakpoints = cs->breakpoints;
+    size_t          i;
+
+    if (!breakpoints) {
+        return false;
+    }
+
+    for (i = 0; i < breakpoints->conditions_amount; i++) {
+        if (breakpoints->conditions[i].id == id) {
+            free(breakpoints->conditions[i].code);
+            memmove(&breakpoints->conditions[i], &breakpoints->conditions[i + 1],
+                    sizeof *breakpoints->conditions * (breakpoints->conditions_amount - i - 1));
+            breakpoints->conditions_amount--;
+            cs_condition_update(breakpoints);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cs_condition_get_hit(cs_machine const *cs, size_t *id) {
+    if (!cs->breakpoints || !cs->breakpoints->condition_hit) {
+        return false;
+    }
+    if (id) {
+        *id = cs->breakpoints->condition_hit_id;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+/** @file cs_condition.h */
+
+#ifndef CS_CONDITION_H
+#define CS_CONDITION_H
+
+#include "cs.h"
+
+/** @brief Maximum depth of the evaluation stack */
+#define CS_CONDITION_MAX_STACK 32
+/** @brief Maximum amount of CHANGED terms in a condition */
+#define CS_CONDITION_MAX_CHANGED 16
+
+/* Bytecode. Operands follow the opcode */
+#define CS_CONDITION_OP_CONST   0 /* Pushes a 16-bit little endian operand */
+#define CS_CONDITION_OP_BYTE    1 /* Pushes the byte of the state page at the operand offset */
+#define CS_CONDITION_OP_IR      2 /* Pushes IR */
+#define CS_CONDITION_OP_RAM     3 /* Replaces an address by the RAM content */
+#define CS_CONDITION_OP_CHANGED 4 /* Pushes whether the RAM at the operand changed, with its CHANGED slot next */
+#define CS_CONDITION_OP_NOT     5
+#define CS_CONDITION_OP_AND     6
+#define CS_CONDITION_OP_EQ      7
+#define CS_CONDITION_OP_NE      8
+#define CS_CONDITION_OP_LT      9
+#define CS_CONDITION_OP_LE      10
+#define CS_CONDITION_OP_GT      11
+#define CS_CONDITION_OP_GE      12
+#define CS_CONDITION_OP_LAND    13
+#define CS_CONDITION_OP_LOR     14
+#define CS_CONDITION_OP_ADD     15
+#define CS_CONDITION_OP_SUB     16
+
+typedef struct cs_condition cs_condition;
+
+/** @brief Compiled conditional breakpoint */
+struct cs_condition {
+    /** @brief Identifier returned by cs_condition_add */
+    size_t id;
+    /** @brief Bytecode */
+    unsigned char *code;
+    size_t         code_length;
+    /** @brief Whether the condition only depends on the RAM addresses of
+     *      write, so it's only evaluated after they are written */
+    bool on_write;
+    /** @brief Instruction addresses where the condition may hold */
+    unsigned char pc[CS_ROM_SIZE / 8];
+    /** @brief RAM addresses the condition depends on, if on_write */
+    unsigned char write[CS_RAM_SIZE / 8];
+    /** @brief RAM contents at the last evaluation of each CHANGED term */
+    unsigned char changed[CS_CONDITION_MAX_CHANGED];
+};
+
+/**
+ * @brief Evaluates the conditions relevant at the current instruction
+ *      boundary: the ones that may hold at the instruction address, and
+ *      the ones depending on RAM written since the last check
+ * @param cs Pointer to the emulation instance, with breakpoints
+ * @return true if a condition holds, false otherwise
+ */
+bool cs_condition_check(cs_machine *cs);
+
+/**
+ * @brief Frees the conditions of the breakpoints
+ * @param cs Pointer to the emulation instance, with breakpoints
+ */
+void cs_condition_free_all(cs_machine *cs);
+
+#endif /* CS_CONDITION_H */
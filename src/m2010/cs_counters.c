@@ -0,0 +1,73 @@
+/** @file cs_counters.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_instructions.h"
+
+#include "cs_counters.h"
+
+void cs_counters_tick(cs_machine *cs) {
+    cs_counters  *counters = cs->counters;
+    unsigned char depth    = 0xFFu - cs->registers.sp;
+
+    counters->instructions[CS_GET_OPCODE(cs->registers.ir)]++;
+    if (depth > counters->max_stack_depth) {
+        counters->max_stack_depth = depth;
+    }
+}
+
+void cs_counters_branch(cs_machine *cs, bool taken) {
+    if (taken) {
+        cs->counters->branches_taken[CS_GET_JMP_CONDITION(cs->registers.ir)]++;
+    } else {
+        cs->counters->branches_not_taken[CS_GET_JMP_CONDITION(cs->registers.ir)]++;
+    }
+}
+
+void cs_counters_access(cs_machine *cs, size_t offset, bool is_write, bool is_device) {
+    cs_counters *counters = cs->counters;
+
+    if (is_device && is_write) {
+        counters->io_writes[offset]++;
+    } else if (is_device) {
+        counters->io_reads[offset]++;
+    } else if (is_write) {
+        counters->ram_writes[offset]++;
+    } else {
+        counters->ram_reads[offset]++;
+    }
+}
+
+bool cs_counters_enable(cs_machine *cs) {
+    if (cs->counters) {
+        return true;
+    }
+
+    cs->counters = calloc(1, sizeof *cs->counters);
+    return cs->counters != 0;
+}
+
+void cs_counters_disable(cs_machine *cs) {
+    if (cs->counters) {
+        free(cs->counters);
+        cs->counters = 0;
+    }
+}
+
+void cs_counters_clear(cs_machine *cs) {
+    if (cs->counters) {
+        memset(cs->counters, 0, sizeof *cs->counters);
+    }
+}
+
+bool cs_counters_get(cs_machine const *cs, cs_counters *counters) {
+    if (!cs->counters) {
+        return false;
+    }
+
+    memcpy(counters, cs->counters, sizeof *counters);
+    return true;
+}
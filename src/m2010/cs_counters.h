@@ -0,0 +1,34 @@
+/** @file cs_counters.h */
+
+#ifndef CS_COUNTERS_H
+#define CS_COUNTERS_H
+
+#include "cs.h"
+
+typedef struct cs_counters cs_counters;
+
+/**
+ * @brief Counts the instruction that has just been completed and the
+ *      stack depth it left. Must be called before the next instruction
+ *      is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_counters_tick(cs_machine *cs);
+
+/**
+ * @brief Counts a BRxx instruction
+ * @param cs Pointer to the emulation instance
+ * @param taken Whether the branch was taken
+ */
+void cs_counters_branch(cs_machine *cs, bool taken);
+
+/**
+ * @brief Counts a memory access
+ * @param cs Pointer to the emulation instance
+ * @param offset Address accessed
+ * @param is_write Whether it was a write
+ * @param is_device Whether it was handled by an I/O device instead of RAM
+ */
+void cs_counters_access(cs_machine *cs, size_t offset, bool is_write, bool is_device);
+
+#endif /* CS_COUNTERS_H */
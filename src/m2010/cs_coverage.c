@@ -0,0 +1,164 @@
+/** @file cs_coverage.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_instructions.h"
+#include "cs_report.h"
+
+#include "cs_coverage.h"
+
+/* Source line flags */
+#define CS_COVERAGE_LINE_NOT_EXECUTED (1u << 0)
+#define CS_COVERAGE_LINE_NEVER_TAKEN  (1u << 1)
+#define CS_COVERAGE_LINE_ALWAYS_TAKEN (1u << 2)
+
+/** @brief Report text of each source line flag */
+static struct {
+    unsigned char flag;
+    char const   *reason;
+} const cs_coverage_reasons[] = {
+    {CS_COVERAGE_LINE_NOT_EXECUTED, "not executed"},
+    {CS_COVERAGE_LINE_NEVER_TAKEN, "never taken"},
+    {CS_COVERAGE_LINE_ALWAYS_TAKEN, "always taken"},
+};
+
+void cs_coverage_tick(cs_machine *cs) {
+    BIT_SET(cs->coverage->executed, cs->instruction_address);
+}
+
+void cs_coverage_branch(cs_machine *cs, bool taken) {
+    if (taken) {
+        BIT_SET(cs->coverage->taken, cs->instruction_address);
+    } else {
+        BIT_SET(cs->coverage->not_taken, cs->instruction_address);
+    }
+}
+
+bool cs_coverage_enable(cs_machine *cs) {
+    if (cs->coverage) {
+        return true;
+    }
+
+    cs->coverage = calloc(1, sizeof *cs->coverage);
+    return cs->coverage != 0;
+}
+
+void cs_coverage_disable(cs_machine *cs) {
+    if (cs->coverage) {
+        free(cs->coverage);
+        cs->coverage = 0;
+    }
+}
+
+void cs_coverage_clear(cs_machine *cs) {
+    if (cs->coverage) {
+        memset(cs->coverage, 0, sizeof *cs->coverage);
+    }
+}
+
+bool cs_coverage_get(cs_machine const *cs, cs_coverage *coverage) {
+    if (!cs->coverage) {
+        return false;
+    }
+
+    memcpy(coverage, cs->coverage, sizeof *coverage);
+    return true;
+}
+
+void cs_coverage_merge(cs_coverage *coverage, cs_coverage const *other) {
+    size_t i;
+
+    for (i = 0; i < CS_COVERAGE_BITMAP_SIZE; i++) {
+        coverage->executed[i] |= other->executed[i];
+        coverage->taken[i] |= other->taken[i];
+        coverage->not_taken[i] |= other->not_taken[i];
+    }
+}
+
+char *cs_coverage_report(cs_coverage const *coverage, struct cs_as_machine_code const *machine_code,
+                         char const *source) {
+    cs_report_text text = {0, 0, 0, false};
+    unsigned char *line_flags;
+    char const   **lines;
+    size_t        *line_lengths;
+    size_t         lines_amount;
+    size_t         instructions = 0;
+    size_t         executed     = 0;
+    size_t         outcomes     = 0;
+    size_t         covered      = 0;
+    size_t         line;
+    size_t         i;
+
+    if (!coverage || !machine_code || !source) {
+        return 0;
+    }
+
+    lines_amount = cs_report_split_lines(source, &lines, &line_lengths);
+    if (!lines_amount) {
+        return 0;
+    }
+
+    /* Flag the source lines (1-based, as the assembler reports them) */
+    line_flags = calloc(lines_amount + 1, sizeof *line_flags);
+    if (!line_flags) {
+        free(lines);
+        free(line_lengths);
+        return 0;
+    }
+    for (i = 0; i < machine_code->machine_instructions_amount && i < CS_ROM_SIZE; i++) {
+        line = machine_code->matching_source_assembly_lines[i];
+        if (line > lines_amount) {
+            line = 0;
+        }
+
+        instructions++;
+        if (!BIT_TEST(coverage->executed, i)) {
+            line_flags[line] |= CS_COVERAGE_LINE_NOT_EXECUTED;
+        } else {
+            executed++;
+        }
+
+        if (CS_GET_OPCODE(machine_code->machine_instructions[i]) == CS_INS_I_BRXX) {
+            outcomes += 2;
+            if (BIT_TEST(coverage->taken, i)) {
+                covered++;
+            } else if (BIT_TEST(coverage->executed, i)) {
+                line_flags[line] |= CS_COVERAGE_LINE_NEVER_TAKEN;
+            }
+            if (BIT_TEST(coverage->not_taken, i)) {
+                covered++;
+            } else if (BIT_TEST(coverage->executed, i)) {
+                line_flags[line] |= CS_COVERAGE_LINE_ALWAYS_TAKEN;
+            }
+        }
+    }
+
+    cs_report_printf(&text, "Instructions: %" PRI_SIZET "/%" PRI_SIZET " covered (%.2f%%)\n", executed, instructions,
+                     instructions ? 100.0 * executed / instructions : 100.0);
+    cs_report_printf(&text, "Branch outcomes: %" PRI_SIZET "/%" PRI_SIZET " covered (%.2f%%)\n", covered, outcomes,
+                     outcomes ? 100.0 * covered / outcomes : 100.0);
+
+    /* Uncovered lines */
+    cs_report_printf(&text, "\nUncovered lines:\n%6s  %-14s  %s\n", "line", "reason", "source");
+    for (line = 1; line <= lines_amount; line++) {
+        for (i = 0; i < sizeof cs_coverage_reasons / sizeof *cs_coverage_reasons; i++) {
+            if (line_flags[line] & cs_coverage_reasons[i].flag) {
+                cs_report_printf(&text, "%6" PRI_SIZET "  %-14s  %.*s\n", line, cs_coverage_reasons[i].reason,
+                                 (int)line_lengths[line - 1], lines[line - 1]);
+            }
+        }
+    }
+
+    free(lines);
+    free(line_lengths);
+    free(line_flags);
+
+    return cs_report_finish(&text);
+}
@@ -0,0 +1,24 @@
+/** @file cs_coverage.h */
+
+#ifndef CS_COVERAGE_H
+#define CS_COVERAGE_H
+
+#include "cs.h"
+
+typedef struct cs_coverage cs_coverage;
+
+/**
+ * @brief Marks the instruction that has just been completed as executed.
+ *      Must be called before the next instruction is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_coverage_tick(cs_machine *cs);
+
+/**
+ * @brief Marks the outcome of the BRxx instruction being executed
+ * @param cs Pointer to the emulation instance
+ * @param taken Whether the branch was taken
+ */
+void cs_coverage_branch(cs_machine *cs, bool taken);
+
+#endif /* CS_COVERAGE_H */
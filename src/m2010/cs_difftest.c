@@ -0,0 +1,311 @@
+/** @file cs_difftest.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_instructions.h"
+
+#include "cs_difftest.h"
+
+/** @brief Instruction replacing others while shrinking (MOV R0, R0) */
+#define CS_DIFFTEST_FILLER ((unsigned short)(CS_INS_I_MOV << CS_INS_OPCODE_OFFSET))
+
+static unsigned long long cs_difftest_random(unsigned long long *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+static size_t cs_difftest_random_below(unsigned long long *state, size_t bound) {
+    return (cs_difftest_random(state) >> 32) % bound;
+}
+
+static bool cs_difftest_is_valid(cs_machine const *cs, unsigned short machine_instruction) {
+    cs_instruction_op const *op = &cs->opcodes[CS_GET_OPCODE(machine_instruction)];
+
+    return op->stepper && op->microstepper;
+}
+
+static void cs_difftest_generate(cs_difftest *difftest, cs_difftest_program *program) {
+    unsigned short machine_instruction;
+    unsigned char  opcode;
+    size_t         i;
+
+    memset(program, 0, sizeof *program);
+    program->machine_instructions_amount = 1 + cs_difftest_random_below(&difftest->random, CS_DIFFTEST_MAX_PROGRAM);
+    for (i = 0; i < program->machine_instructions_amount; i++) {
+        do {
+            machine_instruction = cs_difftest_random(&difftest->random) >> 48;
+        } while (!cs_difftest_is_valid(difftest->machines[0], machine_instruction));
+
+        /* Jumps stay inside the program, so that control flow is exercised instead of the zeroed ROM */
+        opcode = CS_GET_OPCODE(machine_instruction);
+        if (opcode == CS_INS_I_JMP || opcode == CS_INS_I_BRXX || opcode == CS_INS_I_CALL) {
+            machine_instruction = (machine_instruction & ~0xFFu) |
+                                  cs_difftest_random_below(&difftest->random, program->machine_instructions_amount);
+        }
+        program->machine_instructions[i] = machine_instruction;
+    }
+    for (i = 0; i < sizeof program->registers; i++) {
+        program->registers[i] = cs_difftest_random(&difftest->random) >> 56;
+    }
+    for (i = 0; i < CS_RAM_SIZE; i++) {
+        program->ram[i] = cs_difftest_random(&difftest->random) >> 56;
+    }
+    program->seed = cs_difftest_random(&difftest->random);
+}
+
+static void cs_difftest_load(cs_machine *cs, cs_difftest_program const *program) {
+    size_t i;
+
+    cs_load_machine_instructions(cs, (unsigned short *)program->machine_instructions,
+                                 program->machine_instructions_amount);
+    for (i = 0; i < sizeof program->registers; i++) {
+        *cs->regfile[i] = program->registers[i];
+    }
+    memcpy(cs->memory.ram, program->ram, CS_RAM_SIZE);
+}
+
+/**
+ * @brief Completes an instruction of the reference with microsteps
+ * @param cs Pointer to the reference machine
+ */
+static void cs_difftest_step_reference(cs_machine *cs) {
+    unsigned long long instructions = cs->instructions;
+    size_t             microsteps   = 0;
+
+    do {
+        cs_microstep(cs);
+    } while (cs->instructions == instructions && !cs->stopped && ++microsteps < CS_DIFFTEST_MAX_MICROSTEPS);
+}
+
+static void cs_difftest_step_engine(cs_difftest *difftest, cs_machine *cs, int engine) {
+    switch (engine) {
+        case CS_DIFFTEST_FULLSTEP:
+            cs_fullstep(cs);
+            break;
+        case CS_DIFFTEST_BLOCKSTEP:
+            cs_blockstep(cs, 1 + cs_difftest_random_below(&difftest->chunk_random, CS_DIFFTEST_MAX_CHUNK));
+            break;
+        case CS_DIFFTEST_RUN:
+        default:
+            cs_run(cs, 1 + cs_difftest_random_below(&difftest->chunk_random, 4 * CS_DIFFTEST_MAX_CHUNK));
+            break;
+    }
+}
+
+static void cs_difftest_diverged(cs_difftest *difftest, int engine, cs_difftest_divergence *divergence) {
+    unsigned char const *reference = cs_get_state_page(difftest->machines[0]);
+    unsigned char const *page      = cs_get_state_page(difftest->machines[1 + engine]);
+    size_t               offset    = 0;
+
+    while (offset < CS_STATE_PAGE_SIZE - 1 && reference[offset] == page[offset]) {
+        offset++;
+    }
+    divergence->engine      = engine;
+    divergence->instruction = difftest->machines[0]->instructions;
+    divergence->offset      = offset;
+}
+
+/**
+ * @brief Runs a program with the reference and every engine in lockstep.
+ *      Each engine runs ahead of the reference, which catches up to it
+ *      one instruction at a time before their states are compared
+ * @param difftest Pointer to the differential tester
+ * @param program Pointer to the program
+ * @param divergence Pointer where the divergence will be stored, if any.
+ *      Its program is left untouched
+ * @return true if an engine diverged, false otherwise
+ */
+static bool cs_difftest_compare(cs_difftest *difftest, cs_difftest_program const *program,
+                                cs_difftest_divergence *divergence) {
+    cs_machine *reference = difftest->machines[0];
+    cs_machine *cs;
+    bool        is_ahead;
+    int         engine;
+
+    for (engine = 0; engine <= CS_DIFFTEST_ENGINES; engine++) {
+        cs_difftest_load(difftest->machines[engine], program);
+    }
+    difftest->chunk_random = program->seed | 1;
+
+    for (;;) {
+        is_ahead = false;
+        for (engine = 0; engine < CS_DIFFTEST_ENGINES; engine++) {
+            cs = difftest->machines[1 + engine];
+            /* Finished at an earlier comparison, while the reference catches up to other engines */
+            if (cs->instructions >= CS_DIFFTEST_MAX_INSTRUCTIONS && cs->instructions < reference->instructions) {
+                continue;
+            }
+            if (cs->instructions == reference->instructions) {
+                if (memcmp(cs_get_state_page(cs), cs_get_state_page(reference), CS_STATE_PAGE_SIZE)) {
+                    cs_difftest_diverged(difftest, engine, divergence);
+                    return true;
+                }
+                if (cs->stopped || cs->instructions >= CS_DIFFTEST_MAX_INSTRUCTIONS) {
+                    continue;
+                }
+                cs_difftest_step_engine(difftest, cs, engine);
+            }
+
+            /* An engine can't fall behind, nor keep going after the reference stopped */
+            if (cs->instructions <= reference->instructions || reference->stopped) {
+                cs_difftest_diverged(difftest, engine, divergence);
+                return true;
+            }
+            is_ahead = true;
+        }
+
+        if (!is_ahead) {
+            return false;
+        }
+        cs_difftest_step_reference(reference);
+    }
+}
+
+/**
+ * @brief Shrinks the program of a divergence, keeping every change that
+ *      still makes an engine diverge, until no change does
+ * @param difftest Pointer to the differential tester
+ * @param divergence Pointer to the divergence
+ */
+static void cs_difftest_shrink(cs_difftest *difftest, cs_difftest_divergence *divergence) {
+    cs_difftest_program candidate;
+    bool                is_shrunk = true;
+    size_t              i;
+
+    while (is_shrunk) {
+        is_shrunk = false;
+
+        /* Fewer instructions */
+        candidate = divergence->program;
+        while (candidate.machine_instructions_amount > 1) {
+            candidate.machine_instructions[--candidate.machine_instructions_amount] = 0;
+            if (!cs_difftest_compare(difftest, &candidate, divergence)) {
+                break;
+            }
+            divergence->program = candidate;
+            is_shrunk           = true;
+        }
+
+        /* Simpler instructions */
+        if (cs_difftest_is_valid(difftest->machines[0], CS_DIFFTEST_FILLER)) {
+            for (i = 0; i < divergence->program.machine_instructions_amount; i++) {
+                if (divergence->program.machine_instructions[i] == CS_DIFFTEST_FILLER) {
+                    continue;
+                }
+                candidate                         = divergence->program;
+                candidate.machine_instructions[i] = CS_DIFFTEST_FILLER;
+                if (cs_difftest_compare(difftest, &candidate, divergence)) {
+                    divergence->program = candidate;
+                    is_shrunk           = true;
+                }
+            }
+        }
+
+        /* Zeroed registers and RAM, all of it first */
+        candidate = divergence->program;
+        memset(candidate.ram, 0, CS_RAM_SIZE);
+        if (memcmp(candidate.ram, divergence->program.ram, CS_RAM_SIZE) &&
+            cs_difftest_compare(difftest, &candidate, divergence)) {
+            divergence->program = candidate;
+            is_shrunk           = true;
+        }
+        for (i = 0; i < sizeof candidate.registers + CS_RAM_SIZE; i++) {
+            candidate = divergence->program;
+            if (i < sizeof candidate.registers) {
+                if (!candidate.registers[i]) {
+                    continue;
+                }
+                candidate.registers[i] = 0;
+            } else {
+                if (!candidate.ram[i - sizeof candidate.registers]) {
+                    continue;
+                }
+                candidate.ram[i - sizeof candidate.registers] = 0;
+            }
+            if (cs_difftest_compare(difftest, &candidate, divergence)) {
+                divergence->program = candidate;
+                is_shrunk           = true;
+            }
+        }
+    }
+
+    /* Leave the details of the shrunk program's own divergence */
+    cs_difftest_compare(difftest, &divergence->program, divergence);
+}
+
+static void cs_difftest_free(cs_difftest *difftest) {
+    size_t i;
+
+    for (i = 0; i <= CS_DIFFTEST_ENGINES; i++) {
+        cs_free(difftest->machines[i]);
+    }
+    free(difftest);
+}
+
+static cs_difftest *cs_difftest_create(unsigned char platform) {
+    cs_difftest *difftest = calloc(1, sizeof *difftest);
+    size_t       i;
+
+    if (!difftest) {
+        return 0;
+    }
+    for (i = 0; i <= CS_DIFFTEST_ENGINES; i++) {
+        difftest->machines[i] = cs_create();
+        if (!difftest->machines[i] || cs_init(difftest->machines[i], platform) != CS_INIT_OK) {
+            cs_difftest_free(difftest);
+            return 0;
+        }
+    }
+    return difftest;
+}
+
+int cs_difftest_run(unsigned char platform, unsigned long long programs, unsigned long long seed,
+                    cs_difftest_divergence *divergence, unsigned long long *instructions) {
+    cs_difftest *difftest = cs_difftest_create(platform);
+    int          result   = CS_DIFFTEST_OK;
+    bool         is_diverged;
+
+    if (!difftest) {
+        return CS_DIFFTEST_FAILED;
+    }
+
+    difftest->random = seed ? seed : 1;
+    while (programs--) {
+        cs_difftest_generate(difftest, &divergence->program);
+        is_diverged = cs_difftest_compare(difftest, &divergence->program, divergence);
+        difftest->instructions += difftest->machines[0]->instructions;
+        if (is_diverged) {
+            cs_difftest_shrink(difftest, divergence);
+            result = CS_DIFFTEST_DIVERGED;
+            break;
+        }
+    }
+
+    if (instructions) {
+        *instructions = difftest->instructions;
+    }
+    cs_difftest_free(difftest);
+    return result;
+}
+
+int cs_difftest_execute(unsigned char platform, cs_difftest_program const *program,
+                        cs_difftest_divergence *divergence) {
+    cs_difftest *difftest = cs_difftest_create(platform);
+    int          result;
+
+    if (!difftest) {
+        return CS_DIFFTEST_FAILED;
+    }
+
+    result = cs_difftest_compare(difftest, program, divergence) ? CS_DIFFTEST_DIVERGED : CS_DIFFTEST_OK;
+    if (result == CS_DIFFTEST_DIVERGED) {
+        divergence->program = *program;
+    }
+    cs_difftest_free(difftest);
+    return result;
+}
@@ -0,0 +1,35 @@
+/** @file cs_difftest.h */
+
+#ifndef CS_DIFFTEST_H
+#define CS_DIFFTEST_H
+
+#include "cs.h"
+
+/** @brief Amount of engines compared with the reference */
+#define CS_DIFFTEST_ENGINES 3
+/** @brief Longest random program */
+#define CS_DIFFTEST_MAX_PROGRAM 32
+/** @brief Instructions after which a program is no longer compared */
+#define CS_DIFFTEST_MAX_INSTRUCTIONS 256
+/** @brief Most instructions of a blockstep, and most cycles of a cs_run divided by 4 */
+#define CS_DIFFTEST_MAX_CHUNK 16
+/** @brief Microsteps after which an instruction of the reference is considered stuck */
+#define CS_DIFFTEST_MAX_MICROSTEPS 64
+
+typedef struct cs_difftest            cs_difftest;
+typedef struct cs_difftest_divergence cs_difftest_divergence;
+typedef struct cs_difftest_program    cs_difftest_program;
+
+/** @brief Differential tester state */
+struct cs_difftest {
+    /** @brief Reference machine, followed by a machine for each engine */
+    cs_machine *machines[1 + CS_DIFFTEST_ENGINES];
+    /** @brief Pseudorandom generator states (xorshift64*) of the programs
+     *      and of the amounts each engine runs at once */
+    unsigned long long random;
+    unsigned long long chunk_random;
+    /** @brief Instructions run by the reference */
+    unsigned long long instructions;
+};
+
+#endif /* CS_DIFFTEST_H */
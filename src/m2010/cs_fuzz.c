@@ -0,0 +1,346 @@
+/** @file cs_fuzz.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_fuzz.h"
+
+/** @brief Bytes likely to reach boundary cases */
+static unsigned char const cs_fuzz_interesting[] = {0x00, 0x01, 0x02, 0x7E, 0x7F, 0x80, 0x81, 0xFE, 0xFF};
+
+static unsigned long long cs_fuzz_random(cs_fuzz *fuzz) {
+    fuzz->random ^= fuzz->random >> 12;
+    fuzz->random ^= fuzz->random << 25;
+    fuzz->random ^= fuzz->random >> 27;
+    return fuzz->random * 2685821657736338717ull;
+}
+
+static size_t cs_fuzz_random_below(cs_fuzz *fuzz, size_t bound) {
+    return (cs_fuzz_random(fuzz) >> 32) % bound;
+}
+
+static void cs_fuzz_mutate(cs_fuzz *fuzz, cs_fuzz_input *input) {
+    cs_fuzz_input const *other;
+    unsigned char       *bytes;
+    size_t               length;
+    size_t               mutations = 1 + cs_fuzz_random_below(fuzz, CS_FUZZ_MAX_MUTATIONS);
+    size_t               position;
+
+    while (mutations--) {
+        /* Each part of the input is picked equally often, regardless of its size */
+        switch (cs_fuzz_random_below(fuzz, 3)) {
+            case 0:
+                bytes  = input->registers;
+                length = sizeof input->registers;
+                break;
+            case 1:
+                bytes  = input->ram;
+                length = sizeof input->ram;
+                break;
+            case 2:
+            default:
+                bytes  = input->tape;
+                length = sizeof input->tape;
+                break;
+        }
+        position = cs_fuzz_random_below(fuzz, length);
+
+        switch (cs_fuzz_random_below(fuzz, 5)) {
+            case 0:
+                bytes[position] ^= 1u << cs_fuzz_random_below(fuzz, 8);
+                break;
+            case 1:
+                bytes[position] = cs_fuzz_random(fuzz) >> 56;
+                break;
+            case 2:
+                bytes[position] = cs_fuzz_interesting[cs_fuzz_random_below(fuzz, sizeof cs_fuzz_interesting)];
+                break;
+            case 3:
+                bytes[position] += (unsigned char)(cs_fuzz_random_below(fuzz, 17) - 8);
+                break;
+            case 4:
+            default:
+                /* Splice the byte at the same offset of another input of the corpus */
+                other           = &fuzz->corpus[cs_fuzz_random_below(fuzz, fuzz->corpus_amount)];
+                bytes[position] = ((unsigned char const *)other)[bytes - (unsigned char *)input + position];
+                break;
+        }
+    }
+}
+
+bool cs_fuzz_read_input(cs_machine *cs, size_t offset, unsigned char *input) {
+    cs_fuzz *fuzz = cs->fuzz;
+
+    if (!fuzz->is_executing || !BIT_TEST(fuzz->input_addresses, offset)) {
+        return false;
+    }
+
+    *input = fuzz->tape_position < CS_FUZZ_TAPE_SIZE ? fuzz->input->tape[fuzz->tape_position++] : 0;
+    return true;
+}
+
+/**
+ * @brief Runs an input from the starting state until the machine stops or fails
+ * @param cs Pointer to the emulation instance
+ * @param input Pointer to the input
+ * @param check Function checking the final state, or null pointer
+ * @return CS_FUZZ_OK if success, or the failure otherwise
+ */
+static int cs_fuzz_execute_input(cs_machine *cs, cs_fuzz_input *input, cs_fuzz_check_fn *check) {
+    cs_fuzz           *fuzz     = cs->fuzz;
+    cs_coverage       *coverage = cs->coverage;
+    unsigned long long end_cycle;
+    int                outcome = CS_FUZZ_OK;
+
+    memcpy(cs_get_state_page(cs), fuzz->page, CS_STATE_PAGE_SIZE);
+    cs->next_event = fuzz->next_event;
+    if (cs->interrupts) {
+        *cs->interrupts = fuzz->interrupts;
+    }
+    cs->registers.r0 = input->registers[0];
+    cs->registers.r1 = input->registers[1];
+    cs->registers.r2 = input->registers[2];
+    cs->registers.r3 = input->registers[3];
+    cs->registers.r4 = input->registers[4];
+    cs->registers.r5 = input->registers[5];
+    cs->registers.r6 = input->registers[6];
+    cs->registers.r7 = input->registers[7];
+    memcpy(cs->memory.ram, input->ram, CS_RAM_SIZE);
+
+    /* Coverage is gathered into the fuzzer's own bitmaps */
+    memset(&fuzz->coverage, 0, sizeof fuzz->coverage);
+    cs->coverage        = &fuzz->coverage;
+    fuzz->input         = input;
+    fuzz->tape_position = 0;
+    fuzz->is_executing  = true;
+
+    end_cycle = cs->cycles + fuzz->max_cycles;
+    while (!cs->stopped) {
+        if (cs->cycles >= end_cycle) {
+            outcome = CS_FUZZ_TIMEOUT;
+            break;
+        }
+        cs_fullstep(cs);
+        if ((unsigned char)(0xFFu - cs->registers.sp) > fuzz->max_stack_depth) {
+            outcome = CS_FUZZ_STACK;
+            break;
+        }
+    }
+
+    fuzz->is_executing = false;
+    cs->coverage       = coverage;
+    if (outcome == CS_FUZZ_OK && check && !check(cs, input)) {
+        outcome = CS_FUZZ_WRONG_OUTPUT;
+    }
+    return outcome;
+}
+
+/**
+ * @brief Merges the coverage of the last execution into the corpus coverage
+ * @param fuzz Pointer to the fuzzer
+ * @return true if it covered anything new, false otherwise
+ */
+static bool cs_fuzz_merge_coverage(cs_fuzz *fuzz) {
+    unsigned char new_bits = 0;
+    size_t        i;
+
+    for (i = 0; i < CS_COVERAGE_BITMAP_SIZE; i++) {
+        new_bits |= fuzz->coverage.executed[i] & ~fuzz->total_coverage.executed[i];
+        new_bits |= fuzz->coverage.taken[i] & ~fuzz->total_coverage.taken[i];
+        new_bits |= fuzz->coverage.not_taken[i] & ~fuzz->total_coverage.not_taken[i];
+    }
+    if (new_bits) {
+        cs_coverage_merge(&fuzz->total_coverage, &fuzz->coverage);
+    }
+    return new_bits != 0;
+}
+
+/**
+ * @brief Hashes the coverage of the last execution (FNV-1a)
+ * @param fuzz Pointer to the fuzzer
+ * @return Hash of the instructions executed and the branches taken and not taken
+ */
+static unsigned long long cs_fuzz_hash_coverage(cs_fuzz const *fuzz) {
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    size_t             i;
+
+    for (i = 0; i < CS_COVERAGE_BITMAP_SIZE; i++) {
+        hash = (hash ^ fuzz->coverage.executed[i]) * 0x100000001B3ull;
+        hash = (hash ^ fuzz->coverage.taken[i]) * 0x100000001B3ull;
+        hash = (hash ^ fuzz->coverage.not_taken[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Records a failing input, unless the same failure was already
+ *      recorded. Wrong outputs all end at a STOP, so they are told apart
+ *      by their coverage instead of their instruction address
+ * @param cs Pointer to the emulation instance
+ * @param input Pointer to the input
+ * @param outcome Failure
+ * @return true if recorded, false otherwise
+ */
+static bool cs_fuzz_record_failure(cs_machine *cs, cs_fuzz_input const *input, int outcome) {
+    cs_fuzz           *fuzz = cs->fuzz;
+    cs_fuzz_failure   *failure;
+    cs_fuzz_failure   *failures;
+    unsigned long long coverage_hash = cs_fuzz_hash_coverage(fuzz);
+    size_t             capacity;
+    size_t             i;
+
+    if (outcome == CS_FUZZ_WRONG_OUTPUT) {
+        for (i = 0; i < fuzz->failures_amount; i++) {
+            if (fuzz->failures[i].outcome == outcome && fuzz->failures[i].coverage_hash == coverage_hash) {
+                return false;
+            }
+        }
+    } else if (BIT_TEST(fuzz->reported[outcome - 1], cs->instruction_address)) {
+        return false;
+    }
+
+    if (fuzz->failures_amount == fuzz->failures_capacity) {
+        capacity = fuzz->failures_capacity ? fuzz->failures_capacity * 2 : 16;
+        failures = realloc(fuzz->failures, sizeof *failures * capacity);
+        if (!failures) {
+            return false;
+        }
+        fuzz->failures          = failures;
+        fuzz->failures_capacity = capacity;
+    }
+    failure = &fuzz->failures[fuzz->failures_amount++];
+    if (outcome != CS_FUZZ_WRONG_OUTPUT) {
+        BIT_SET(fuzz->reported[outcome - 1], cs->instruction_address);
+    }
+    failure->outcome             = outcome;
+    failure->instruction_address = cs->instruction_address;
+    failure->coverage_hash       = coverage_hash;
+    failure->input               = *input;
+    return true;
+}
+
+bool cs_fuzz_enable(cs_machine *cs, unsigned char const *input_addresses, unsigned long long max_cycles,
+                    unsigned char max_stack_depth, unsigned long long seed) {
+    cs_fuzz      *fuzz;
+    cs_fuzz_input input;
+
+    cs_fuzz_disable(cs);
+    /* No stack depth is above 255, so it couldn't catch anything */
+    if (max_stack_depth == 0xFF) {
+        return false;
+    }
+    fuzz = calloc(1, sizeof *fuzz);
+    if (!fuzz) {
+        return false;
+    }
+
+    memcpy(fuzz->page, cs_get_state_page(cs), CS_STATE_PAGE_SIZE);
+    fuzz->next_event = cs->next_event;
+    if (cs->interrupts) {
+        fuzz->interrupts = *cs->interrupts;
+    }
+    if (input_addresses) {
+        memcpy(fuzz->input_addresses, input_addresses, sizeof fuzz->input_addresses);
+    }
+    fuzz->max_cycles      = max_cycles;
+    fuzz->max_stack_depth = max_stack_depth;
+    /* xorshift64* must not start at 0 */
+    fuzz->random = seed * 0x9E3779B97F4A7C15ull + 1;
+
+    /* The starting state itself is the first input */
+    input.registers[0] = cs->registers.r0;
+    input.registers[1] = cs->registers.r1;
+    input.registers[2] = cs->registers.r2;
+    input.registers[3] = cs->registers.r3;
+    input.registers[4] = cs->registers.r4;
+    input.registers[5] = cs->registers.r5;
+    input.registers[6] = cs->registers.r6;
+    input.registers[7] = cs->registers.r7;
+    memcpy(input.ram, cs->memory.ram, CS_RAM_SIZE);
+    memset(input.tape, 0, CS_FUZZ_TAPE_SIZE);
+
+    cs->fuzz = fuzz;
+    if (!cs_fuzz_add_input(cs, &input)) {
+        cs_fuzz_disable(cs);
+        return false;
+    }
+    return true;
+}
+
+void cs_fuzz_disable(cs_machine *cs) {
+    if (cs->fuzz) {
+        free(cs->fuzz->corpus);
+        free(cs->fuzz->failures);
+        free(cs->fuzz);
+        cs->fuzz = 0;
+    }
+}
+
+bool cs_fuzz_add_input(cs_machine *cs, cs_fuzz_input const *input) {
+    cs_fuzz       *fuzz = cs->fuzz;
+    cs_fuzz_input *corpus;
+    size_t         capacity;
+
+    if (!fuzz) {
+        return false;
+    }
+
+    if (fuzz->corpus_amount == fuzz->corpus_capacity) {
+        capacity = fuzz->corpus_capacity ? fuzz->corpus_capacity * 2 : 16;
+        corpus   = realloc(fuzz->corpus, sizeof *corpus * capacity);
+        if (!corpus) {
+            return false;
+        }
+        fuzz->corpus          = corpus;
+        fuzz->corpus_capacity = capacity;
+    }
+    fuzz->corpus[fuzz->corpus_amount++] = *input;
+    return true;
+}
+
+size_t cs_fuzz_run(cs_machine *cs, unsigned long long executions, cs_fuzz_check_fn *check) {
+    cs_fuzz      *fuzz = cs->fuzz;
+    cs_fuzz_input input;
+    size_t        failures = 0;
+    int           outcome;
+
+    if (!fuzz) {
+        return 0;
+    }
+
+    while (executions--) {
+        input = fuzz->corpus[cs_fuzz_random_below(fuzz, fuzz->corpus_amount)];
+        cs_fuzz_mutate(fuzz, &input);
+
+        outcome = cs_fuzz_execute_input(cs, &input, check);
+        if (outcome != CS_FUZZ_OK) {
+            failures += cs_fuzz_record_failure(cs, &input, outcome);
+        } else if (cs_fuzz_merge_coverage(fuzz)) {
+            cs_fuzz_add_input(cs, &input);
+        }
+    }
+    return failures;
+}
+
+int cs_fuzz_execute(cs_machine *cs, cs_fuzz_input const *input, cs_fuzz_check_fn *check) {
+    cs_fuzz_input copy;
+
+    if (!cs->fuzz) {
+        return CS_FUZZ_OK;
+    }
+
+    copy = *input;
+    return cs_fuzz_execute_input(cs, &copy, check);
+}
+
+cs_fuzz_input const *cs_fuzz_get_corpus(cs_machine const *cs, size_t *amount) {
+    *amount = cs->fuzz ? cs->fuzz->corpus_amount : 0;
+    return cs->fuzz ? cs->fuzz->corpus : 0;
+}
+
+cs_fuzz_failure const *cs_fuzz_get_failures(cs_machine const *cs, size_t *amount) {
+    *amount = cs->fuzz ? cs->fuzz->failures_amount : 0;
+    return cs->fuzz ? cs->fuzz->failures : 0;
+}
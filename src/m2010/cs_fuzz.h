@@ -0,0 +1,63 @@
+/** @file cs_fuzz.h */
+
+#ifndef CS_FUZZ_H
+#define CS_FUZZ_H
+
+#include "cs.h"
+#include "cs_coverage.h"
+#include "cs_interrupts.h"
+
+/** @brief Stacked mutations applied to an input, at most */
+#define CS_FUZZ_MAX_MUTATIONS 4
+/** @brief Amount of outcomes that are failures at an instruction address (CS_FUZZ_TIMEOUT and CS_FUZZ_STACK) */
+#define CS_FUZZ_FAILURE_KINDS 2
+
+typedef struct cs_fuzz         cs_fuzz;
+typedef struct cs_fuzz_failure cs_fuzz_failure;
+typedef struct cs_fuzz_input   cs_fuzz_input;
+
+/** @brief Coverage-guided fuzzer state */
+struct cs_fuzz {
+    /** @brief Machine state every execution starts from: state page,
+     *      cs_machine.next_event and interrupt controller */
+    unsigned char      page[CS_STATE_PAGE_SIZE];
+    unsigned long long next_event;
+    cs_interrupts      interrupts;
+    /** @brief RAM addresses whose reads are served from the input tape */
+    unsigned char input_addresses[CS_RAM_SIZE / 8];
+    /** @brief Clock cycles after which an execution times out */
+    unsigned long long max_cycles;
+    /** @brief Stack depth, in bytes, above which an execution fails, below 255 */
+    unsigned char max_stack_depth;
+    /** @brief Pseudorandom generator state (xorshift64*) */
+    unsigned long long random;
+    /** @brief Whether an execution is running, so reads use the tape */
+    bool is_executing;
+    /** @brief Input being executed and position of the next tape read */
+    cs_fuzz_input *input;
+    size_t         tape_position;
+    /** @brief Coverage of the execution, and of the whole corpus */
+    cs_coverage coverage;
+    cs_coverage total_coverage;
+    /** @brief Inputs that reached new coverage */
+    cs_fuzz_input *corpus;
+    size_t         corpus_amount;
+    size_t         corpus_capacity;
+    /** @brief Failing inputs, one for each kind and instruction address,
+     *      or for each coverage hash of the wrong outputs */
+    cs_fuzz_failure *failures;
+    size_t           failures_amount;
+    size_t           failures_capacity;
+    unsigned char    reported[CS_FUZZ_FAILURE_KINDS][CS_ROM_SIZE / 8];
+};
+
+/**
+ * @brief Serves a read from the input tape while fuzzing
+ * @param cs Pointer to the emulation instance
+ * @param offset Address to read from
+ * @param input Pointer where the input will be stored
+ * @return true if the input comes from the tape, false otherwise
+ */
+bool cs_fuzz_read_input(cs_machine *cs, size_t offset, unsigned char *input);
+
+#endif /* CS_FUZZ_H */
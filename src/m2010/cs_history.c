@@ -0,0 +1,422 @@
+/** @file cs_history.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_call_graph.h"
+#include "cs_profiler.h"
+
+#include "cs_history.h"
+
+static void cs_history_take_checkpoint(cs_machine *cs) {
+    cs_history            *history    = cs->history;
+    cs_history_checkpoint *checkpoint = &history->checkpoints[history->checkpoints_amount++];
+
+    checkpoint->instruction     = history->instruction;
+    checkpoint->io_position     = history->io_position;
+    checkpoint->change_position = history->change_position;
+    checkpoint->next_event      = cs->next_event;
+    if (cs->interrupts) {
+        checkpoint->interrupts = *cs->interrupts;
+    }
+    memcpy(checkpoint->page, cs_get_state_page(cs), CS_STATE_PAGE_SIZE);
+}
+
+/**
+ * @brief Doubles the checkpoint interval, dropping every checkpoint that
+ *      doesn't fall on it. The start of the history is always kept
+ * @param history Pointer to the history
+ */
+static void cs_history_thin(cs_history *history) {
+    size_t kept = 0;
+    size_t i;
+
+    history->interval *= 2;
+    for (i = 0; i < history->checkpoints_amount; i++) {
+        if (i == 0 || history->checkpoints[i].instruction % history->interval == 0) {
+            history->checkpoints[kept++] = history->checkpoints[i];
+        }
+    }
+    history->checkpoints_amount = kept;
+}
+
+/** @brief Gets the memory taken by the logs */
+static size_t cs_history_logs_usage(cs_history const *history) {
+    return history->io_amount * sizeof *history->io + history->changes_amount * sizeof *history->changes;
+}
+
+/** @brief Gets the memory taken by the checkpoints and the logs, charged against the budget */
+static size_t cs_history_usage(cs_history const *history) {
+    return history->checkpoints_amount * sizeof *history->checkpoints + cs_history_logs_usage(history);
+}
+
+/**
+ * @brief Moves the start of the history to its second checkpoint, dropping
+ *      the first one and the log entries only it needed
+ * @param history Pointer to the history, with at least two checkpoints
+ */
+static void cs_history_slide(cs_history *history) {
+    size_t io_dropped      = history->checkpoints[1].io_position;
+    size_t changes_dropped = history->checkpoints[1].change_position;
+    size_t i;
+
+    memmove(history->io, history->io + io_dropped, (history->io_amount - io_dropped) * sizeof *history->io);
+    history->io_amount -= io_dropped;
+    history->io_position -= io_dropped;
+    memmove(history->changes, history->changes + changes_dropped,
+            (history->changes_amount - changes_dropped) * sizeof *history->changes);
+    history->changes_amount -= changes_dropped;
+    history->change_position -= changes_dropped;
+
+    memmove(history->checkpoints, history->checkpoints + 1,
+            --history->checkpoints_amount * sizeof *history->checkpoints);
+    for (i = 0; i < history->checkpoints_amount; i++) {
+        history->checkpoints[i].io_position -= io_dropped;
+        history->checkpoints[i].change_position -= changes_dropped;
+    }
+}
+
+/**
+ * @brief Keeps the checkpoints and the logs within the budget, sliding the
+ *      start of the history forward. Must be called at the live head
+ * @param cs Pointer to the emulation instance
+ */
+static void cs_history_trim(cs_machine *cs) {
+    cs_history *history = cs->history;
+    size_t      limit   = history->budget * sizeof *history->checkpoints;
+    size_t      amount;
+
+    while (cs_history_usage(history) > limit && history->checkpoints_amount > 1) {
+        /* Sparser checkpoints keep the whole history while the logs are small */
+        amount = history->checkpoints_amount;
+        if (cs_history_logs_usage(history) <= limit / 2 && amount > 2) {
+            cs_history_thin(history);
+        }
+        if (history->checkpoints_amount == amount) {
+            cs_history_slide(history);
+        }
+    }
+
+    /* The log since the only checkpoint left exceeds the budget alone, so the history starts here */
+    if (cs_history_usage(history) > limit && history->checkpoints[0].instruction != history->instruction) {
+        cs_history_take_checkpoint(cs);
+        cs_history_slide(history);
+    }
+}
+
+/**
+ * @brief Applies the logged interrupt changes requested by the host right
+ *      after the current instruction, when replaying
+ * @param cs Pointer to the emulation instance
+ */
+static void cs_history_replay_changes(cs_machine *cs) {
+    cs_history *history = cs->history;
+
+    while (history->change_position < history->changes_amount &&
+           history->changes[history->change_position].instruction == history->instruction) {
+        cs_interrupts_apply(cs, &history->changes[history->change_position++].change);
+    }
+}
+
+static void cs_history_restore(cs_machine *cs, cs_history_checkpoint const *checkpoint) {
+    cs_history *history = cs->history;
+
+    memcpy(cs_get_state_page(cs), checkpoint->page, CS_STATE_PAGE_SIZE);
+    cs->next_event = checkpoint->next_event;
+    if (cs->interrupts) {
+        *cs->interrupts = checkpoint->interrupts;
+    }
+    history->instruction     = checkpoint->instruction;
+    history->io_position     = checkpoint->io_position;
+    history->change_position = checkpoint->change_position;
+    cs_history_replay_changes(cs);
+}
+
+/**
+ * @brief Restores the state right after a given amount of instructions
+ *      had been completed, from the nearest checkpoint before it
+ * @param cs Pointer to the emulation instance
+ * @param instruction Amount of completed instructions, not before the
+ *      start of the history
+ */
+static void cs_history_goto(cs_machine *cs, unsigned long long instruction) {
+    cs_history *history = cs->history;
+    size_t      low     = 0;
+    size_t      high    = history->checkpoints_amount;
+    size_t      middle;
+
+    while (high - low > 1) {
+        middle = low + (high - low) / 2;
+        if (history->checkpoints[middle].instruction <= instruction) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    cs_history_restore(cs, &history->checkpoints[low]);
+    while (history->instruction < instruction && !cs->stopped) {
+        cs_fullstep(cs);
+    }
+}
+
+/**
+ * @brief Drops the history after the current instruction, once the host
+ *      made it diverge from what was logged
+ * @param cs Pointer to the emulation instance
+ */
+static void cs_history_drop_future(cs_machine *cs) {
+    cs_history *history = cs->history;
+
+    /* The observers followed the execution up to the dropped head */
+    if (history->instruction < history->head) {
+        if (cs->profiler) {
+            cs_profiler_restart(cs);
+        }
+        if (cs->call_graph) {
+            cs_call_graph_restart(cs);
+        }
+    }
+
+    history->head           = history->instruction;
+    history->io_amount      = history->io_position;
+    history->changes_amount = history->change_position;
+    while (history->checkpoints_amount > 1 &&
+           history->checkpoints[history->checkpoints_amount - 1].instruction > history->instruction) {
+        history->checkpoints_amount--;
+    }
+}
+
+void cs_history_tick(cs_machine *cs) {
+    cs_history *history = cs->history;
+
+    history->instruction++;
+    cs_history_replay_changes(cs);
+    if (history->instruction < history->head) {
+        return;
+    }
+    history->head = history->instruction;
+
+    if (history->instruction % history->interval == 0 &&
+        history->instruction > history->checkpoints[history->checkpoints_amount - 1].instruction) {
+        if (history->checkpoints_amount == history->budget) {
+            cs_history_thin(history);
+        }
+        if (history->instruction % history->interval == 0) {
+            cs_history_take_checkpoint(cs);
+        }
+    }
+    cs_history_trim(cs);
+}
+
+void cs_history_restart(cs_machine *cs) {
+    cs_history *history = cs->history;
+
+    history->checkpoints_amount = 0;
+    history->interval           = history->checkpoint_interval;
+    history->instruction        = 0;
+    history->head               = 0;
+    history->io_amount          = 0;
+    history->io_position        = 0;
+    history->changes_amount     = 0;
+    history->change_position    = 0;
+    history->failed             = false;
+    cs_history_take_checkpoint(cs);
+}
+
+/**
+ * @brief Appends an entry to the I/O log
+ * @param history Pointer to the history
+ * @param entry Input value, or whether an output was claimed by a device
+ */
+static void cs_history_log_io(cs_history *history, unsigned char entry) {
+    unsigned char *io;
+    size_t         capacity;
+
+    if (history->failed) {
+        return;
+    }
+
+    if (history->io_amount == history->io_capacity) {
+        capacity = history->io_capacity ? history->io_capacity * 2 : 256;
+        io       = realloc(history->io, capacity * sizeof *io);
+        if (!io) {
+            history->failed = true;
+            return;
+        }
+        history->io          = io;
+        history->io_capacity = capacity;
+    }
+    history->io[history->io_amount++] = entry;
+    history->io_position++;
+}
+
+bool cs_history_replay_input(cs_machine *cs, unsigned char *input) {
+    cs_history *history = cs->history;
+
+    if (history->io_position == history->io_amount) {
+        return false;
+    }
+    *input = history->io[history->io_position++];
+    return true;
+}
+
+void cs_history_log_input(cs_machine *cs, unsigned char input) {
+    cs_history_log_io(cs->history, input);
+}
+
+bool cs_history_replay_output(cs_machine *cs, bool *is_device) {
+    cs_history *history = cs->history;
+
+    if (history->io_position == history->io_amount) {
+        return false;
+    }
+    *is_device = history->io[history->io_position++];
+    return true;
+}
+
+void cs_history_log_output(cs_machine *cs, bool is_device) {
+    cs_history_log_io(cs->history, is_device);
+}
+
+void cs_history_log_interrupts(cs_machine *cs, cs_interrupts_change const *change) {
+    cs_history        *history = cs->history;
+    cs_history_change *changes;
+    size_t             capacity;
+
+    if (history->failed) {
+        return;
+    }
+
+    if (history->instruction < history->head || history->io_position < history->io_amount ||
+        history->change_position < history->changes_amount) {
+        cs_history_drop_future(cs);
+    }
+
+    if (history->changes_amount == history->changes_capacity) {
+        capacity = history->changes_capacity ? history->changes_capacity * 2 : 16;
+        changes  = realloc(history->changes, capacity * sizeof *changes);
+        if (!changes) {
+            history->failed = true;
+            return;
+        }
+        history->changes          = changes;
+        history->changes_capacity = capacity;
+    }
+    history->changes[history->changes_amount].instruction = history->instruction;
+    history->changes[history->changes_amount].change      = *change;
+    history->changes_amount++;
+    history->change_position++;
+}
+
+bool cs_history_enable(cs_machine *cs, unsigned long interval, size_t budget) {
+    cs_history *history;
+
+    if (!interval || budget < 2) {
+        return false;
+    }
+
+    cs_history_disable(cs);
+    history = calloc(1, sizeof *history);
+    if (!history) {
+        return false;
+    }
+
+    history->checkpoints = malloc(sizeof *history->checkpoints * budget);
+    if (!history->checkpoints) {
+        free(history);
+        return false;
+    }
+    history->budget              = budget;
+    history->checkpoint_interval = interval;
+
+    cs->history = history;
+    cs_history_restart(cs);
+    return true;
+}
+
+void cs_history_disable(cs_machine *cs) {
+    if (cs->history) {
+        free(cs->history->checkpoints);
+        free(cs->history->io);
+        free(cs->history->changes);
+        free(cs->history);
+        cs->history = 0;
+    }
+}
+
+unsigned long long cs_history_get_instruction(cs_machine const *cs) {
+    return cs->history ? cs->history->instruction : 0;
+}
+
+bool cs_reverse_step(cs_machine *cs) {
+    cs_history *history = cs->history;
+
+    if (!history || history->failed) {
+        return false;
+    }
+
+    /* A partially executed instruction goes back to its start */
+    if (cs->microop) {
+        cs_history_goto(cs, history->instruction);
+        return true;
+    }
+
+    if (history->instruction == history->checkpoints[0].instruction) {
+        return false;
+    }
+    cs_history_goto(cs, history->instruction - 1);
+    return true;
+}
+
+bool cs_reverse_continue(cs_machine *cs, unsigned char const *breakpoints) {
+    cs_history        *history = cs->history;
+    unsigned long long limit;
+    unsigned long long end;
+    unsigned long long found;
+    bool               is_found;
+    size_t             i;
+
+    if (!history || history->failed) {
+        return false;
+    }
+
+    /* Instruction boundaries before the current position */
+    limit = history->instruction + (cs->microop ? 1 : 0);
+
+    /* Search each checkpoint interval backwards, replaying it forward */
+    for (i = history->checkpoints_amount; breakpoints && i-- > 0;) {
+        if (history->checkpoints[i].instruction >= limit) {
+            continue;
+        }
+
+        end = limit;
+        if (i + 1 < history->checkpoints_amount && history->checkpoints[i + 1].instruction < end) {
+            end = history->checkpoints[i + 1].instruction;
+        }
+
+        is_found = false;
+        found    = 0;
+        cs_history_restore(cs, &history->checkpoints[i]);
+        while (true) {
+            if (BIT_TEST(breakpoints, cs->instruction_address)) {
+                found    = history->instruction;
+                is_found = true;
+            }
+            if (history->instruction + 1 >= end || cs->stopped) {
+                break;
+            }
+            cs_fullstep(cs);
+        }
+
+        if (is_found) {
+            cs_history_goto(cs, found);
+            return true;
+        }
+    }
+
+    cs_history_restore(cs, &history->checkpoints[0]);
+    return false;
+}
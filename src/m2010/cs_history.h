@@ -0,0 +1,135 @@
+/** @file cs_history.h */
+
+#ifndef CS_HISTORY_H
+#define CS_HISTORY_H
+
+#include "cs.h"
+#include "cs_interrupts.h"
+
+/**
+ * @brief Whether the instruction in progress was already executed before
+ *      going back, so its observers (profiler, counters, tracer, trace and
+ *      VCD files...) must not see it again
+ */
+#define CS_HISTORY_IS_REPLAYING(cs) ((cs)->history && (cs)->history->instruction < (cs)->history->head)
+
+typedef struct cs_history            cs_history;
+typedef struct cs_history_change     cs_history_change;
+typedef struct cs_history_checkpoint cs_history_checkpoint;
+
+/** @brief Architectural state at an instruction boundary */
+struct cs_history_checkpoint {
+    /** @brief Instructions completed since the history started */
+    unsigned long long instruction;
+    /** @brief Position of the next entry of the I/O log */
+    size_t io_position;
+    /** @brief Position of the next entry of the interrupt change log */
+    size_t change_position;
+    /** @brief Value of cs_machine.next_event */
+    unsigned long long next_event;
+    /** @brief Interrupt controller, if the machine has one */
+    cs_interrupts interrupts;
+    /** @brief Copy of the state page */
+    unsigned char page[CS_STATE_PAGE_SIZE];
+};
+
+/** @brief Change of the interrupt controller requested by the host */
+struct cs_history_change {
+    /** @brief Instructions completed when it was requested */
+    unsigned long long instruction;
+    cs_interrupts_change change;
+};
+
+/** @brief Execution history for reverse execution */
+struct cs_history {
+    /** @brief Checkpoints in increasing instruction order. The first one
+     *      is the start of the history */
+    cs_history_checkpoint *checkpoints;
+    size_t                 checkpoints_amount;
+    /** @brief Maximum amount of checkpoints. The logs are charged against
+     *      it too, in checkpoint sized units */
+    size_t budget;
+    /** @brief Instructions between checkpoints when the history starts */
+    unsigned long long checkpoint_interval;
+    /** @brief Current instructions between checkpoints, doubled whenever
+     *      the budget is exhausted */
+    unsigned long long interval;
+    /** @brief Instructions completed since the history started */
+    unsigned long long instruction;
+    /** @brief Instructions completed when going back for the first time,
+     *      which are replayed without side effects up to this point */
+    unsigned long long head;
+    /** @brief Every input read from a device, and whether each output was
+     *      claimed by a device, in execution order since the first checkpoint */
+    unsigned char *io;
+    size_t         io_amount;
+    size_t         io_capacity;
+    /** @brief Position of the next I/O entry, which is replayed from the
+     *      log while behind io_amount */
+    size_t io_position;
+    /** @brief Interrupt changes requested by the host since the first checkpoint */
+    cs_history_change *changes;
+    size_t             changes_amount;
+    size_t             changes_capacity;
+    /** @brief Position of the next interrupt change to replay */
+    size_t change_position;
+    /** @brief Whether a log entry could not be stored, so the history can't be replayed */
+    bool failed;
+};
+
+/**
+ * @brief Notifies the history that an instruction has been completed,
+ *      taking a checkpoint if the interval elapsed. Must be called after
+ *      the next instruction is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_history_tick(cs_machine *cs);
+
+/**
+ * @brief Drops the history and starts it over from the current state,
+ *      after it has been changed by a reset or a load
+ * @param cs Pointer to the emulation instance
+ */
+void cs_history_restart(cs_machine *cs);
+
+/**
+ * @brief Gets the next input from the log when replaying
+ * @param cs Pointer to the emulation instance
+ * @param input Pointer where the input will be stored
+ * @return true if replaying, false if the input must be read from the device
+ */
+bool cs_history_replay_input(cs_machine *cs, unsigned char *input);
+
+/**
+ * @brief Appends an input read from the device to the log
+ * @param cs Pointer to the emulation instance
+ * @param input Input read
+ */
+void cs_history_log_input(cs_machine *cs, unsigned char input);
+
+/**
+ * @brief Gets from the log whether an output was claimed by a device when
+ *      replaying, in which case it must not reach the device again
+ * @param cs Pointer to the emulation instance
+ * @param is_device Pointer where whether a device claimed it will be stored
+ * @return true if replaying, false if the output must reach the device
+ */
+bool cs_history_replay_output(cs_machine *cs, bool *is_device);
+
+/**
+ * @brief Appends whether an output was claimed by a device to the log
+ * @param cs Pointer to the emulation instance
+ * @param is_device Whether a device claimed it
+ */
+void cs_history_log_output(cs_machine *cs, bool is_device);
+
+/**
+ * @brief Appends an interrupt change requested by the host to the log.
+ *      Requested while going back, it drops the history after the
+ *      current instruction, which no longer is what will happen
+ * @param cs Pointer to the emulation instance
+ * @param change Change requested
+ */
+void cs_history_log_interrupts(cs_machine *cs, cs_interrupts_change const *change);
+
+#endif /* CS_HISTORY_H */
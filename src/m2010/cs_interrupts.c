@@ -0,0 +1,279 @@
+/** @file cs_interrupts.c */
+
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_call_graph.h"
+#include "cs_history.h"
+#include "cs_instructions.h"
+
+#include "cs_interrupts.h"
+#include "cs_opcodes.h"
+
+static void cs_interrupts_sift_down(cs_interrupts *interrupts, size_t i) {
+    cs_event event = interrupts->events[i];
+    size_t   child;
+
+    while ((child = 2 * i + 1) < interrupts->events_amount) {
+        if (child + 1 < interrupts->events_amount &&
+            interrupts->events[child + 1].due < interrupts->events[child].due) {
+            child++;
+        }
+        if (event.due <= interrupts->events[child].due) {
+            break;
+        }
+        interrupts->events[i] = interrupts->events[child];
+        i                     = child;
+    }
+    interrupts->events[i] = event;
+}
+
+static void cs_interrupts_sift_up(cs_interrupts *interrupts, size_t i) {
+    cs_event event = interrupts->events[i];
+    size_t   parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (interrupts->events[parent].due <= event.due) {
+            break;
+        }
+        interrupts->events[i] = interrupts->events[parent];
+        i                     = parent;
+    }
+    interrupts->events[i] = event;
+}
+
+static void cs_interrupts_remove_at(cs_interrupts *interrupts, size_t i) {
+    interrupts->events[i] = interrupts->events[--interrupts->events_amount];
+    if (i < interrupts->events_amount) {
+        cs_interrupts_sift_down(interrupts, i);
+        cs_interrupts_sift_up(interrupts, i);
+    }
+}
+
+static bool cs_interrupts_schedule(cs_interrupts *interrupts, cs_event const *event) {
+    if (interrupts->events_amount == CS_INTERRUPTS_MAX_EVENTS) {
+        return false;
+    }
+    interrupts->events[interrupts->events_amount] = *event;
+    cs_interrupts_sift_up(interrupts, interrupts->events_amount++);
+    return true;
+}
+
+static void cs_interrupts_request(cs_interrupts *interrupts, unsigned char vector) {
+    if (!BIT_TEST(interrupts->pending, vector)) {
+        BIT_SET(interrupts->pending, vector);
+        interrupts->pending_amount++;
+    }
+}
+
+/**
+ * @brief Recomputes the cycle at which the dispatcher must run next.
+ *      Pending interrupts and running handlers need it to run at
+ *      every instruction boundary
+ * @param cs Pointer to the emulation instance
+ */
+static void cs_interrupts_update_next_event(cs_machine *cs) {
+    cs_interrupts *interrupts = cs->interrupts;
+
+    if (interrupts->in_service || (interrupts->enabled && interrupts->pending_amount)) {
+        cs->next_event = 0;
+    } else if (interrupts->events_amount) {
+        cs->next_event = interrupts->events[0].due;
+    } else {
+        cs->next_event = CS_INTERRUPTS_NO_EVENT;
+    }
+}
+
+static void cs_interrupts_enter(cs_machine *cs, unsigned char vector) {
+    cs_interrupts *interrupts = cs->interrupts;
+
+    /* Behave like a CALL to the vector issued right before the fetched instruction */
+    cs_write_memory(cs, cs->registers.sp--, cs->registers.pc - 1);
+    cs->registers.pc = vector;
+    cs->cycles += cs->opcode_cycles[CS_INS_I_CALL];
+    if (cs->call_graph && !CS_HISTORY_IS_REPLAYING(cs)) {
+        cs_call_graph_enter(cs, vector);
+    }
+
+    interrupts->in_service = true;
+    interrupts->service_sp = cs->registers.sp;
+    interrupts->service_sr = cs->registers.sr;
+}
+
+bool cs_interrupts_dispatch(cs_machine *cs) {
+    cs_interrupts *interrupts = cs->interrupts;
+    cs_event      *event;
+    unsigned char  vector;
+    bool           entered = false;
+
+    /* The handler returns when its own return address is popped */
+    if (interrupts->in_service && cs->registers.sp == (unsigned char)(interrupts->service_sp + 1)) {
+        interrupts->in_service = false;
+        cs->registers.sr       = interrupts->service_sr;
+    }
+
+    while (interrupts->events_amount && interrupts->events[0].due <= cs->cycles) {
+        event = &interrupts->events[0];
+        cs_interrupts_request(interrupts, event->vector);
+        if (event->period) {
+            /* Missed requests are merged into the pending one */
+            event->due += event->period;
+            if (event->due <= cs->cycles) {
+                event->due = cs->cycles + event->period;
+            }
+            cs_interrupts_sift_down(interrupts, 0);
+        } else {
+            cs_interrupts_remove_at(interrupts, 0);
+        }
+    }
+
+    if (interrupts->enabled && !interrupts->in_service && interrupts->pending_amount) {
+        /* Lower vectors have priority */
+        for (vector = 0; !BIT_TEST(interrupts->pending, vector); vector++)
+            ;
+        BIT_CLEAR(interrupts->pending, vector);
+        interrupts->pending_amount--;
+        cs_interrupts_enter(cs, vector);
+        entered = true;
+    }
+
+    cs_interrupts_update_next_event(cs);
+    return entered;
+}
+
+void cs_interrupts_reset(cs_machine *cs) {
+    cs_interrupts *interrupts = cs->interrupts;
+    size_t         i          = 0;
+
+    while (i < interrupts->events_amount) {
+        if (interrupts->events[i].is_timer) {
+            interrupts->events[i].due = cs->cycles + interrupts->events[i].period;
+            i++;
+        } else {
+            cs_interrupts_remove_at(interrupts, i);
+        }
+    }
+    /* Timer dues changed in place, so the heap has to be rebuilt */
+    for (i = interrupts->events_amount / 2; i-- > 0;) {
+        cs_interrupts_sift_down(interrupts, i);
+    }
+
+    memset(interrupts->pending, 0, sizeof interrupts->pending);
+    interrupts->pending_amount = 0;
+    interrupts->in_service     = false;
+    cs_interrupts_update_next_event(cs);
+}
+
+/** @brief Stops the timer device, if it is running */
+static void cs_interrupts_stop_timer(cs_interrupts *interrupts) {
+    size_t i;
+
+    for (i = 0; i < interrupts->events_amount; i++) {
+        if (interrupts->events[i].is_timer) {
+            cs_interrupts_remove_at(interrupts, i);
+            break;
+        }
+    }
+}
+
+bool cs_interrupts_apply(cs_machine *cs, cs_interrupts_change const *change) {
+    cs_interrupts *interrupts = cs->interrupts;
+    cs_event       event      = {0};
+    bool           success    = true;
+
+    switch (change->kind) {
+        case CS_INTERRUPTS_RAISE:
+            cs_interrupts_request(interrupts, change->vector);
+            break;
+        case CS_INTERRUPTS_SCHEDULE:
+            event.due    = change->due;
+            event.vector = change->vector;
+            success      = cs_interrupts_schedule(interrupts, &event);
+            break;
+        case CS_INTERRUPTS_TIMER_START:
+            cs_interrupts_stop_timer(interrupts);
+            event.due      = change->due;
+            event.period   = change->period;
+            event.vector   = change->vector;
+            event.is_timer = true;
+            success        = cs_interrupts_schedule(interrupts, &event);
+            break;
+        case CS_INTERRUPTS_TIMER_STOP:
+            cs_interrupts_stop_timer(interrupts);
+            break;
+        case CS_INTERRUPTS_SET_ENABLED:
+            interrupts->enabled = change->vector;
+            break;
+        default:
+            break;
+    }
+    cs_interrupts_update_next_event(cs);
+    return success;
+}
+
+/** @brief Applies a change requested by the host, logging it first so the history can replay it */
+static bool cs_interrupts_change_by_host(cs_machine *cs, cs_interrupts_change const *change) {
+    if (cs->history) {
+        cs_history_log_interrupts(cs, change);
+    }
+    return cs_interrupts_apply(cs, change);
+}
+
+void cs_set_interrupts_enabled(cs_machine *cs, bool enabled) {
+    cs_interrupts_change change = {0};
+
+    if (!cs->interrupts) {
+        return;
+    }
+    change.kind   = CS_INTERRUPTS_SET_ENABLED;
+    change.vector = !!enabled;
+    cs_interrupts_change_by_host(cs, &change);
+}
+
+bool cs_raise_interrupt(cs_machine *cs, unsigned char vector) {
+    cs_interrupts_change change = {0};
+
+    if (!cs->interrupts) {
+        return false;
+    }
+    change.kind   = CS_INTERRUPTS_RAISE;
+    change.vector = vector;
+    return cs_interrupts_change_by_host(cs, &change);
+}
+
+bool cs_schedule_interrupt(cs_machine *cs, unsigned long long delay, unsigned char vector) {
+    cs_interrupts_change change = {0};
+
+    if (!cs->interrupts) {
+        return false;
+    }
+    change.kind   = CS_INTERRUPTS_SCHEDULE;
+    change.vector = vector;
+    change.due    = cs->cycles + delay;
+    return cs_interrupts_change_by_host(cs, &change);
+}
+
+bool cs_timer_start(cs_machine *cs, unsigned long long period, unsigned char vector) {
+    cs_interrupts_change change = {0};
+
+    if (!cs->interrupts || !period) {
+        return false;
+    }
+    change.kind   = CS_INTERRUPTS_TIMER_START;
+    change.vector = vector;
+    change.due    = cs->cycles + period;
+    change.period = period;
+    return cs_interrupts_change_by_host(cs, &change);
+}
+
+void cs_timer_stop(cs_machine *cs) {
+    cs_interrupts_change change = {0};
+
+    if (!cs->interrupts) {
+        return;
+    }
+    change.kind = CS_INTERRUPTS_TIMER_STOP;
+    cs_interrupts_change_by_host(cs, &change);
+}
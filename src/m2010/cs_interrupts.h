@@ -0,0 +1,94 @@
+/** @file cs_interrupts.h */
+
+#ifndef CS_INTERRUPTS_H
+#define CS_INTERRUPTS_H
+
+#include "cs.h"
+
+/** @brief Maximum amount of simultaneously scheduled events */
+#define CS_INTERRUPTS_MAX_EVENTS 32
+
+/** @brief Value of cs_machine.next_event when nothing is scheduled */
+#define CS_INTERRUPTS_NO_EVENT (~0ull)
+
+/* Kinds of cs_interrupts_change */
+#define CS_INTERRUPTS_RAISE       0
+#define CS_INTERRUPTS_SCHEDULE    1
+#define CS_INTERRUPTS_TIMER_START 2
+#define CS_INTERRUPTS_TIMER_STOP  3
+#define CS_INTERRUPTS_SET_ENABLED 4
+
+typedef struct cs_event             cs_event;
+typedef struct cs_interrupts        cs_interrupts;
+typedef struct cs_interrupts_change cs_interrupts_change;
+
+/** @brief Scheduled interrupt request */
+struct cs_event {
+    /** @brief Cycle at which the interrupt is requested */
+    unsigned long long due;
+    /** @brief Cycles between requests, or 0 for one-shot events */
+    unsigned long long period;
+    /** @brief Interrupt vector (ROM address of the handler) */
+    unsigned char vector;
+    /** @brief Whether this is the timer device event */
+    bool is_timer;
+};
+
+/** @brief Interrupt controller and event scheduler state */
+struct cs_interrupts {
+    /** @brief Min-heap of scheduled events, keyed by due cycle */
+    cs_event events[CS_INTERRUPTS_MAX_EVENTS];
+    /** @brief Amount of scheduled events */
+    size_t events_amount;
+    /** @brief Bitmap of pending interrupt vectors */
+    unsigned char pending[CS_ROM_SIZE / 8];
+    /** @brief Amount of pending interrupt vectors */
+    size_t pending_amount;
+    /** @brief Whether interrupts are accepted */
+    bool enabled;
+    /** @brief Whether an interrupt handler is running */
+    bool in_service;
+    /** @brief SP right after pushing the return address of the handler */
+    unsigned char service_sp;
+    /** @brief SR when the handler was entered, restored on return */
+    unsigned char service_sr;
+};
+
+/** @brief Change of the interrupt controller requested by the host, logged by the history to replay it */
+struct cs_interrupts_change {
+    /** @brief One of CS_INTERRUPTS_RAISE, CS_INTERRUPTS_SCHEDULE... */
+    unsigned char kind;
+    /** @brief Interrupt vector, or whether interrupts are accepted for CS_INTERRUPTS_SET_ENABLED */
+    unsigned char vector;
+    /** @brief Cycle of the first request of a scheduled event or timer */
+    unsigned long long due;
+    /** @brief Cycles between requests of a timer */
+    unsigned long long period;
+};
+
+/**
+ * @brief Applies a change requested by the host to the interrupt controller
+ * @param cs Pointer to the emulation instance, which must have an interrupt controller
+ * @param change Change to apply
+ * @return true if success, false if too many events are scheduled
+ */
+bool cs_interrupts_apply(cs_machine *cs, cs_interrupts_change const *change);
+
+/**
+ * @brief Fires due events, delivers pending interrupts and tracks the
+ *      end of the running handler. Must be called at instruction
+ *      boundaries once cs_machine.next_event has been reached
+ * @param cs Pointer to the emulation instance
+ * @return true if a handler was entered and the next instruction
+ *         must be fetched again, false otherwise
+ */
+bool cs_interrupts_dispatch(cs_machine *cs);
+
+/**
+ * @brief Drops one-shot events, pending interrupts and the running
+ *      handler, and restarts the timer from the current cycle
+ * @param cs Pointer to the emulation instance
+ */
+void cs_interrupts_reset(cs_machine *cs);
+
+#endif /* CS_INTERRUPTS_H */
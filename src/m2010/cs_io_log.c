@@ -0,0 +1,132 @@
+/** @file cs_io_log.c */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_io_log.h"
+
+unsigned short cs_io_log_read(cs_machine *cs, size_t offset) {
+    return cs->io_log->shadow[offset];
+}
+
+bool cs_io_log_write(cs_machine *cs, size_t offset, unsigned char content) {
+    cs_io_log    *io_log = cs->io_log;
+    cs_io_record *record;
+
+    if (!CS_IO_LOG_IS_WRITE_CONTROLLED(io_log, offset)) {
+        cs->memory.ram[offset] = content;
+        return false;
+    }
+
+    if (io_log->head - io_log->tail < io_log->capacity) {
+        record          = &io_log->records[io_log->head++ & (io_log->capacity - 1)];
+        record->cycle   = cs->cycles;
+        record->address = offset;
+        record->value   = content;
+    } else {
+        io_log->dropped++;
+    }
+    return true;
+}
+
+bool cs_io_log_enable(cs_machine *cs, size_t capacity) {
+    cs_io_log *io_log;
+    size_t     i;
+    size_t     rounded_capacity = 1;
+
+    /* No power of two above it fits a size_t, nor can its records be allocated */
+    if (capacity > SIZE_MAX / 2 + 1 || capacity > SIZE_MAX / sizeof *io_log->records) {
+        return false;
+    }
+    while (rounded_capacity < capacity) {
+        rounded_capacity <<= 1;
+    }
+
+    io_log = malloc(sizeof *io_log);
+    if (!io_log) {
+        return false;
+    }
+
+    io_log->records = malloc(sizeof *io_log->records * rounded_capacity);
+    if (!io_log->records) {
+        free(io_log);
+        return false;
+    }
+
+    io_log->capacity = rounded_capacity;
+    io_log->head     = 0;
+    io_log->tail     = 0;
+    io_log->dropped  = 0;
+    for (i = 0; i < CS_RAM_SIZE; i++) {
+        io_log->shadow[i] = CS_IO_READ_NOT_CONTROLLED;
+    }
+    memset(io_log->write_controlled, 0, sizeof io_log->write_controlled);
+
+    cs_io_log_disable(cs);
+    cs->io_log = io_log;
+    return true;
+}
+
+void cs_io_log_disable(cs_machine *cs) {
+    if (cs->io_log) {
+        free(cs->io_log->records);
+        free(cs->io_log);
+        cs->io_log = 0;
+    }
+}
+
+unsigned short *cs_io_log_get_shadow(cs_machine *cs) {
+    if (!cs->io_log) {
+        return 0;
+    }
+    return cs->io_log->shadow;
+}
+
+void cs_io_log_set_write_controlled(cs_machine *cs, unsigned char address, bool controlled) {
+    if (!cs->io_log) {
+        return;
+    }
+    if (controlled) {
+        BIT_SET(cs->io_log->write_controlled, address);
+    } else {
+        BIT_CLEAR(cs->io_log->write_controlled, address);
+    }
+}
+
+size_t cs_io_log_drain(cs_machine *cs, cs_io_record *records, size_t max_records) {
+    cs_io_log *io_log = cs->io_log;
+    size_t     amount;
+    size_t     first;
+    size_t     chunk;
+
+    if (!io_log) {
+        return 0;
+    }
+
+    amount = io_log->head - io_log->tail;
+    if (amount > max_records) {
+        amount = max_records;
+    }
+
+    /* Copy in two chunks when the records wrap around the ring buffer */
+    first = io_log->tail & (io_log->capacity - 1);
+    chunk = io_log->capacity - first;
+    if (chunk > amount) {
+        chunk = amount;
+    }
+    memcpy(records, &io_log->records[first], chunk * sizeof *records);
+    memcpy(records + chunk, io_log->records, (amount - chunk) * sizeof *records);
+
+    io_log->tail += amount;
+    return amount;
+}
+
+size_t cs_io_log_get_dropped(cs_machine *cs) {
+    if (!cs->io_log) {
+        return 0;
+    }
+    return cs->io_log->dropped;
+}
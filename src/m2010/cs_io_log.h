@@ -0,0 +1,51 @@
+/** @file cs_io_log.h */
+
+#ifndef CS_IO_LOG_H
+#define CS_IO_LOG_H
+
+#include "cs.h"
+
+/** @brief Checks whether outputs to a RAM address are controlled by the host */
+#define CS_IO_LOG_IS_WRITE_CONTROLLED(io_log, address) BIT_TEST((io_log)->write_controlled, address)
+
+typedef struct cs_io_log    cs_io_log;
+typedef struct cs_io_record cs_io_record;
+
+/** @brief Batched I/O state, replacing the I/O handlers while enabled */
+struct cs_io_log {
+    /** @brief Ring buffer of output records */
+    cs_io_record *records;
+    /** @brief Ring buffer capacity (power of two) */
+    size_t capacity;
+    /** @brief Total amount of records appended */
+    size_t head;
+    /** @brief Total amount of records drained */
+    size_t tail;
+    /** @brief Amount of records dropped because the ring buffer was full */
+    size_t dropped;
+    /** @brief Input values by address, updated by the host */
+    unsigned short shadow[CS_RAM_SIZE];
+    /** @brief Bitmap of addresses whose writes are recorded instead of reaching RAM */
+    unsigned char write_controlled[CS_RAM_SIZE / 8];
+};
+
+/**
+ * @brief Reads an input from the shadow page
+ * @param cs Pointer to the emulation instance
+ * @param offset Address to read from
+ * @return Value provided by the host, or a value greater than UINT8_MAX
+ *         if the address is not controlled (as cs_io_read_fn does)
+ */
+unsigned short cs_io_log_read(cs_machine *cs, size_t offset);
+
+/**
+ * @brief Appends an output record to the ring buffer if the address is
+ *      controlled by the host, or writes it to RAM otherwise
+ * @param cs Pointer to the emulation instance
+ * @param offset Address to write to
+ * @param content Value to write
+ * @return true if the address is controlled by the host, false otherwise
+ */
+bool cs_io_log_write(cs_machine *cs, size_t offset, unsigned char content);
+
+#endif /* CS_IO_LOG_H */
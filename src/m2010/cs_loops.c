@@ -0,0 +1,235 @@
+/** @file cs_loops.c */
+
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_accesses.h"
+#include "cs_instructions.h"
+#include "cs_io_log.h"
+#include "cs_opcodes.h"
+
+#include "cs_loops.h"
+
+/** @brief Register index standing for a constant operand */
+#define CS_LOOPS_CONSTANT 8
+
+typedef struct cs_loops_store cs_loops_store;
+
+/** @brief Store performed by every iteration of a loop */
+struct cs_loops_store {
+    /** @brief Address and content stored by the first iteration */
+    unsigned char address;
+    unsigned char content;
+    /** @brief Registers the address and content come from, or CS_LOOPS_CONSTANT */
+    unsigned char address_register;
+    unsigned char content_register;
+};
+
+/**
+ * @brief Checks whether the instructions from a loop head up to its JMP
+ *      form a counted loop. Registers may only be written by ADD, SUB,
+ *      ADDI and SUBI, adding the same amount on every iteration
+ * @param cs Pointer to the emulation instance
+ * @param head ROM address of the loop head
+ * @param jmp_address ROM address of the JMP
+ * @return true if it is a counted loop, false otherwise
+ */
+static bool cs_loops_is_counted(cs_machine const *cs, unsigned char head, unsigned char jmp_address) {
+    unsigned short machine_instruction;
+    unsigned char  opcode;
+    unsigned char  written = 0;
+    unsigned char  sources = 0;
+    size_t         address;
+
+    if (jmp_address < head + 2u || jmp_address - head >= CS_LOOPS_MAX_LENGTH) {
+        return false;
+    }
+
+    machine_instruction = cs->memory.rom[jmp_address - 1];
+    if (CS_GET_OPCODE(machine_instruction) != CS_INS_I_BRXX ||
+        CS_GET_JMP_CONDITION(machine_instruction) != CS_JMP_COND_EQUAL) {
+        return false;
+    }
+
+    /* The counter sets the flags tested by BRZS */
+    machine_instruction = cs->memory.rom[jmp_address - 2];
+    opcode              = CS_GET_OPCODE(machine_instruction);
+    if (cs->opcodes[opcode].stepper == cs_op_noop_stepper ||
+        (opcode != CS_INS_I_ADDI && opcode != CS_INS_I_SUBI && opcode != CS_INS_I_CPI)) {
+        return false;
+    }
+
+    for (address = head; address < jmp_address - 1u; address++) {
+        machine_instruction = cs->memory.rom[address];
+        opcode              = CS_GET_OPCODE(machine_instruction);
+        if (cs->opcodes[opcode].stepper == cs_op_noop_stepper) {
+            continue;
+        }
+        switch (opcode) {
+            case CS_INS_I_ADD:
+            case CS_INS_I_SUB:
+                /* Doubling a register isn't a constant step */
+                if (CS_GET_REG_A(machine_instruction) == CS_GET_REG_B(machine_instruction)) {
+                    return false;
+                }
+                sources |= 1u << CS_GET_REG_B(machine_instruction);
+                written |= 1u << CS_GET_REG_A(machine_instruction);
+                break;
+            case CS_INS_I_ADDI:
+            case CS_INS_I_SUBI:
+                written |= 1u << CS_GET_REG_A(machine_instruction);
+                break;
+            case CS_INS_I_ST:
+            case CS_INS_I_STS:
+            case CS_INS_I_CP:
+            case CS_INS_I_CPI:
+            case CS_INS_I_CLC:
+            case CS_INS_I_SEC:
+                break;
+            default:
+                return false;
+        }
+    }
+
+    /* Amounts added from registers must not change between iterations */
+    return !(sources & written);
+}
+
+void cs_loops_forward(cs_machine *cs, unsigned char jmp_address, unsigned long long end_cycle) {
+    cs_loops_store     stores[CS_LOOPS_MAX_LENGTH];
+    size_t             stores_amount = 0;
+    unsigned char      values[8];
+    unsigned char      deltas[CS_LOOPS_CONSTANT + 1];
+    unsigned short     machine_instruction;
+    unsigned char      head = CS_GET_ARG_B(cs->memory.rom[jmp_address]);
+    unsigned char      counter;
+    unsigned char      target;
+    unsigned char      address;
+    unsigned long long cycles = 0;
+    unsigned long long iterations;
+    unsigned long long limit;
+    unsigned long long i;
+    size_t             position;
+    size_t             j;
+
+    /* Observers need every instruction, and an interrupt may have been entered instead of the head */
+    if (cs->vcd || cs->tracer || cs->call_graph || cs->counters || cs->coverage || cs->profiler || cs->snapshot ||
+        cs->trace_file || cs->history || cs->fuzz || cs->trace_record || cs->stopped || cs->microop ||
+        cs->instruction_address != head || BIT_TEST(cs->loops->rejected, jmp_address)) {
+        return;
+    }
+    if (!cs_loops_is_counted(cs, head, jmp_address)) {
+        BIT_SET(cs->loops->rejected, jmp_address);
+        return;
+    }
+
+    /* Follow the registers through the first iteration */
+    for (j = 0; j < 8; j++) {
+        values[j] = *cs->regfile[j];
+        deltas[j] = 0;
+    }
+    deltas[CS_LOOPS_CONSTANT] = 0;
+    for (position = head; position <= jmp_address; position++) {
+        machine_instruction = cs->memory.rom[position];
+        cycles += cs->opcode_cycles[CS_GET_OPCODE(machine_instruction)];
+        if (cs->opcodes[CS_GET_OPCODE(machine_instruction)].stepper == cs_op_noop_stepper) {
+            continue;
+        }
+        switch (CS_GET_OPCODE(machine_instruction)) {
+            case CS_INS_I_ADD:
+                deltas[CS_GET_REG_A(machine_instruction)] += values[CS_GET_REG_B(machine_instruction)];
+                values[CS_GET_REG_A(machine_instruction)] += values[CS_GET_REG_B(machine_instruction)];
+                break;
+            case CS_INS_I_SUB:
+                deltas[CS_GET_REG_A(machine_instruction)] -= values[CS_GET_REG_B(machine_instruction)];
+                values[CS_GET_REG_A(machine_instruction)] -= values[CS_GET_REG_B(machine_instruction)];
+                break;
+            case CS_INS_I_ADDI:
+                deltas[CS_GET_REG_A(machine_instruction)] += CS_GET_ARG_B(machine_instruction);
+                values[CS_GET_REG_A(machine_instruction)] += CS_GET_ARG_B(machine_instruction);
+                break;
+            case CS_INS_I_SUBI:
+                deltas[CS_GET_REG_A(machine_instruction)] -= CS_GET_ARG_B(machine_instruction);
+                values[CS_GET_REG_A(machine_instruction)] -= CS_GET_ARG_B(machine_instruction);
+                break;
+            case CS_INS_I_ST:
+                stores[stores_amount].address_register = CS_GET_REG_B(machine_instruction);
+                stores[stores_amount].address          = values[CS_GET_REG_B(machine_instruction)];
+                stores[stores_amount].content_register = CS_GET_REG_A(machine_instruction);
+                stores[stores_amount].content          = values[CS_GET_REG_A(machine_instruction)];
+                stores_amount++;
+                break;
+            case CS_INS_I_STS:
+                stores[stores_amount].address_register = CS_LOOPS_CONSTANT;
+                stores[stores_amount].address          = CS_GET_ARG_B(machine_instruction);
+                stores[stores_amount].content_register = CS_GET_ARG_A(machine_instruction);
+                stores[stores_amount].content          = values[CS_GET_ARG_A(machine_instruction)];
+                stores_amount++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* The loop exits on the first iteration whose counter equals the target
+     * when checked. It is checked after its last change, so the sequence of
+     * checked values repeats within 256 iterations */
+    machine_instruction = cs->memory.rom[jmp_address - 2];
+    counter             = CS_GET_REG_A(machine_instruction);
+    target = CS_GET_OPCODE(machine_instruction) == CS_INS_I_CPI ? CS_GET_ARG_B(machine_instruction) : 0;
+    for (iterations = 0; iterations < 256; iterations++) {
+        if ((unsigned char)(*cs->regfile[counter] + (iterations + 1) * deltas[counter]) == target) {
+            break;
+        }
+    }
+    if (iterations == 256) {
+        iterations = ~0ull;
+    }
+
+    /* The iteration after the skipped ones must fit before the end of the run and the next event */
+    if (cs->cycles >= end_cycle || cs->cycles >= cs->next_event) {
+        return;
+    }
+    limit = (end_cycle - cs->cycles) / cycles;
+    if (limit > (cs->next_event - cs->cycles - 1) / cycles) {
+        limit = (cs->next_event - cs->cycles - 1) / cycles;
+    }
+    if (limit) {
+        limit--;
+    }
+    if (iterations > limit) {
+        iterations = limit;
+    }
+
+    /* Stores repeat with a period of 256 iterations, so only the first ones may reach the I/O handlers */
+    for (i = 0; i < iterations && i < 256; i++) {
+        for (j = 0; j < stores_amount; j++) {
+            address = (unsigned char)(stores[j].address + i * deltas[stores[j].address_register]);
+            if (CS_ACCESSES_IS_IO(cs->accesses, address) ||
+                (cs->io_log && CS_IO_LOG_IS_WRITE_CONTROLLED(cs->io_log, address))) {
+                iterations = i;
+            }
+        }
+    }
+    if (!iterations) {
+        return;
+    }
+
+    /* Only the last 256 iterations decide the RAM contents */
+    for (i = iterations > 256 ? iterations - 256 : 0; i < iterations; i++) {
+        for (j = 0; j < stores_amount; j++) {
+            cs_write_memory(cs, (unsigned char)(stores[j].address + i * deltas[stores[j].address_register]),
+                            (unsigned char)(stores[j].content + i * deltas[stores[j].content_register]));
+        }
+    }
+    for (j = 0; j < 8; j++) {
+        *cs->regfile[j] += (unsigned char)(iterations * deltas[j]);
+    }
+    cs->cycles += iterations * cycles;
+    cs->instructions += iterations * (jmp_address - head + 1u);
+}
+
+void cs_loops_restart(cs_machine *cs) {
+    memset(cs->loops->rejected, 0, sizeof cs->loops->rejected);
+}
@@ -0,0 +1,39 @@
+/** @file cs_loops.h */
+
+#ifndef CS_LOOPS_H
+#define CS_LOOPS_H
+
+#include "cs.h"
+
+/** @brief Maximum amount of instructions of a fast-forwarded loop, including its BRZS and JMP */
+#define CS_LOOPS_MAX_LENGTH 32
+
+typedef struct cs_loops cs_loops;
+
+/** @brief Counted loops found while running */
+struct cs_loops {
+    /** @brief JMP addresses closing a loop which isn't a counted loop */
+    unsigned char rejected[CS_ROM_SIZE / 8];
+};
+
+/**
+ * @brief Fast-forwards the counted loop closed by the JMP just executed,
+ *      if any. A counted loop is made of register arithmetic and stores,
+ *      followed by the ADDI, SUBI or CPI of its counter, a BRZS leaving
+ *      the loop and the JMP back to its head. Its iterations are skipped
+ *      in closed form, leaving at least one to be stepped before the loop
+ *      exits, the run ends or an event is due, so that the registers only
+ *      written by the steppers (such as AC and SR) are the same as well
+ * @param cs Pointer to the emulation instance, with the loop head fetched
+ * @param jmp_address ROM address of the JMP
+ * @param end_cycle Cycle at which the run ends
+ */
+void cs_loops_forward(cs_machine *cs, unsigned char jmp_address, unsigned long long end_cycle);
+
+/**
+ * @brief Forgets the rejected loops, after the ROM changes
+ * @param cs Pointer to the emulation instance
+ */
+void cs_loops_restart(cs_machine *cs);
+
+#endif /* CS_LOOPS_H */
@@ -7,21 +7,168 @@
 #include "../utils.h"
 
 #include "cs_instructions.h"
+#include "cs_accesses.h"
+#include "cs_breakpoints.h"
+#include "cs_call_graph.h"
+#include "cs_counters.h"
+#include "cs_coverage.h"
+#include "cs_fuzz.h"
+#include "cs_history.h"
+#include "cs_io_log.h"
+#include "cs_profiler.h"
+#include "cs_trace_file.h"
+#include "cs_tracer.h"
+#include "cs_trace.h"
+#include "cs_uninit.h"
 
 #include "cs_opcodes.h"
 
 /* Shared I/O helpers */
 unsigned char cs_read_input(cs_machine *cs, size_t offset) {
-    size_t value = cs->io_read_fn(offset);
-    if (value > UINT8_MAX) {
-        value = cs->memory.ram[offset];
+    size_t        value;
+    unsigned char input;
+
+    if (cs->breakpoints) {
+        cs_breakpoints_watch(cs, offset, CS_WATCH_READ);
+    }
+
+    /* A replayed input was observed when it was first read */
+    if (cs->history && cs_history_replay_input(cs, &input)) {
+        return input;
+    }
+
+    if (!cs->fuzz || !cs_fuzz_read_input(cs, offset, &input)) {
+        value = cs->io_log ? cs_io_log_read(cs, offset) : cs->io_read_fn(offset);
+        input = value > UINT8_MAX ? cs->memory.ram[offset] : value;
+        if (cs->counters) {
+            cs_counters_access(cs, offset, false, value <= UINT8_MAX);
+        }
+        if (cs->uninit && value > UINT8_MAX) {
+            cs_uninit_read_check(cs, offset);
+        }
+
+        if (cs->history) {
+            cs_history_log_input(cs, input);
+        }
+    }
+
+#ifdef CS_TRACER
+    if (cs->tracer) {
+        cs_tracer_access(cs, offset, input);
     }
-    return value;
+#endif /* CS_TRACER */
+    return input;
 }
 
 void cs_write_output(cs_machine *cs, size_t offset, unsigned char content) {
-    if (!cs->io_write_fn(offset, content)) {
-        cs->memory.ram[offset] = content;
+    bool is_device;
+
+    if (cs->trace_record) {
+        cs_trace_write(cs, offset, content);
+    }
+    if (cs->breakpoints) {
+        cs_breakpoints_watch(cs, offset, CS_WATCH_WRITE);
+    }
+
+    /* A replayed output already reached its device, so only RAM is written again as it was the first time */
+    if (cs->history && cs_history_replay_output(cs, &is_device)) {
+        if (!is_device) {
+            cs->memory.ram[offset] = content;
+        }
+        return;
+    }
+
+#ifdef CS_TRACER
+    if (cs->tracer) {
+        cs_tracer_access(cs, offset, content);
+    }
+#endif /* CS_TRACER */
+    if (cs->io_log) {
+        is_device = cs_io_log_write(cs, offset, content);
+    } else {
+        is_device = cs->io_write_fn(offset, content);
+        if (!is_device) {
+            cs->memory.ram[offset] = content;
+        }
+    }
+
+    if (cs->counters) {
+        cs_counters_access(cs, offset, true, is_device);
+    }
+    if (cs->uninit && !is_device) {
+        cs_uninit_write(cs, offset);
+    }
+
+    if (cs->history) {
+        cs_history_log_output(cs, is_device);
+    }
+}
+
+unsigned char cs_read_memory(cs_machine *cs, size_t offset) {
+    if (cs->breakpoints) {
+        cs_breakpoints_watch(cs, offset, CS_WATCH_READ);
+    }
+    if (CS_HISTORY_IS_REPLAYING(cs)) {
+        return cs->memory.ram[offset];
+    }
+
+    if (cs->counters) {
+        cs_counters_access(cs, offset, false, false);
+    }
+    if (cs->uninit) {
+        cs_uninit_read_check(cs, offset);
+    }
+#ifdef CS_TRACER
+    if (cs->tracer) {
+        cs_tracer_access(cs, offset, cs->memory.ram[offset]);
+    }
+#endif /* CS_TRACER */
+
+    return cs->memory.ram[offset];
+}
+
+void cs_write_memory(cs_machine *cs, size_t offset, unsigned char content) {
+    if (cs->trace_record) {
+        cs_trace_write(cs, offset, content);
+    }
+    if (cs->breakpoints) {
+        cs_breakpoints_watch(cs, offset, CS_WATCH_WRITE);
+    }
+
+    if (!CS_HISTORY_IS_REPLAYING(cs)) {
+#ifdef CS_TRACER
+        if (cs->tracer) {
+            cs_tracer_access(cs, offset, content);
+        }
+#endif /* CS_TRACER */
+        if (cs->counters) {
+            cs_counters_access(cs, offset, true, false);
+        }
+        if (cs->uninit) {
+            cs_uninit_write(cs, offset);
+        }
+    }
+
+    cs->memory.ram[offset] = content;
+}
+
+/*
+ * Replayed, fuzzed and batched inputs may be served for any address, so they bypass RAM.
+ * Batched outputs only bypass it for the addresses controlled by the host
+ */
+unsigned char cs_read_data(cs_machine *cs, size_t offset) {
+    if (cs->accesses->addresses[cs->instruction_address] == offset && !cs->history && !cs->fuzz && !cs->io_log) {
+        return cs_read_memory(cs, offset);
+    }
+    return cs_read_input(cs, offset);
+}
+
+void cs_write_data(cs_machine *cs, size_t offset, unsigned char content) {
+    if (cs->accesses->addresses[cs->instruction_address] == offset &&
+        (!cs->io_log || !CS_IO_LOG_IS_WRITE_CONTROLLED(cs->io_log, offset))) {
+        cs_write_memory(cs, offset, content);
+    } else {
+        cs_write_output(cs, offset, content);
     }
 }
 
@@ -48,17 +195,40 @@ static bool cs_op_is_jmp_condition_met(cs_machine *cs) {
 }
 
 int cs_op_brxx_stepper(cs_machine *cs) {
-    if (cs_op_is_jmp_condition_met(cs)) {
+    bool is_taken = cs_op_is_jmp_condition_met(cs);
+
+    if (!CS_HISTORY_IS_REPLAYING(cs)) {
+        if (cs->counters) {
+            cs_counters_branch(cs, is_taken);
+        }
+        if (cs->coverage) {
+            cs_coverage_branch(cs, is_taken);
+        }
+    }
+    if (is_taken) {
         cs->registers.ac = CS_GET_ARG_B(cs->registers.ir);
         cs->registers.pc = cs->registers.ac;
+        /* Taking the branch needs an extra microoperation to write PC */
+        cs->cycles++;
     }
     return CS_OP_DO_FETCH;
 }
 
 int cs_op_brxx_microstepper(cs_machine *cs) {
+    bool is_taken;
+
     switch (cs->microop) {
         case 0:
-            if (cs_op_is_jmp_condition_met(cs)) {
+            is_taken = cs_op_is_jmp_condition_met(cs);
+            if (!CS_HISTORY_IS_REPLAYING(cs)) {
+                if (cs->counters) {
+                    cs_counters_branch(cs, is_taken);
+                }
+                if (cs->coverage) {
+                    cs_coverage_branch(cs, is_taken);
+                }
+            }
+            if (is_taken) {
                 cs->registers.ac = CS_GET_ARG_B(cs->registers.ir);
                 return CS_OP_DO_MICROFETCH;
             } else {
@@ -141,73 +311,108 @@ int cs_op_arithmetic_microstepper(cs_machine *cs, unsigned char *dst_register, u
 
 /* Shared ADD */
 int cs_op_add_stepper(cs_machine *cs) {
-    return cs_op_arithmetic_stepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
-                                    *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)], false);
+    return cs_op_arithmetic_stepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
+                                    *cs->regfile[CS_GET_REG_B(cs->registers.ir)], false);
 }
 
 int cs_op_add_microstepper(cs_machine *cs) {
-    return cs_op_arithmetic_microstepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
-                                         *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)], false);
+    return cs_op_arithmetic_microstepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
+                                         *cs->regfile[CS_GET_REG_B(cs->registers.ir)], false);
 }
 
 /* Shared SUB */
 int cs_op_sub_stepper(cs_machine *cs) {
-    return cs_op_arithmetic_stepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
-                                    *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)], true);
+    return cs_op_arithmetic_stepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
+                                    *cs->regfile[CS_GET_REG_B(cs->registers.ir)], true);
 }
 
 int cs_op_sub_microstepper(cs_machine *cs) {
-    return cs_op_arithmetic_microstepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
-                                         *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)], true);
+    return cs_op_arithmetic_microstepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
+                                         *cs->regfile[CS_GET_REG_B(cs->registers.ir)], true);
 }
 
 /* Shared CP */
 int cs_op_cp_stepper(cs_machine *cs) {
-    unsigned char a = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
-    unsigned char b = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+    unsigned char a = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char b = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
     cs_op_perform_arithmetic(cs, a, b, true);
     return CS_OP_DO_FETCH;
 }
 
 /* Shared MOV */
 int cs_op_mov_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
+    cs->registers.ac                             = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
     return CS_OP_DO_FETCH;
 }
 
 int cs_op_mov_microstepper(cs_machine *cs) {
     switch (cs->microop) {
         case 0:
-            cs->registers.ac = *cs->registers.regfile[CS_GET_REG_B(cs->registers.ir)];
+            cs->registers.ac = *cs->regfile[CS_GET_REG_B(cs->registers.ir)];
             return CS_OP_DO_MICROFETCH;
         case 1:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
             return CS_OP_DO_FETCH;
     }
 }
 
 /* Shared STOP */
 int cs_op_stop_stepper(cs_machine *cs) {
+    bool is_observed;
+
+    /* No fetch follows STOP, so it completes here */
+    if (!cs->stopped) {
+        is_observed = !CS_HISTORY_IS_REPLAYING(cs);
+        if (is_observed) {
+#ifdef CS_TRACER
+            if (cs->tracer) {
+                cs_tracer_record_instruction(cs);
+            }
+#endif /* CS_TRACER */
+            if (cs->call_graph) {
+                cs_call_graph_tick(cs);
+            }
+            if (cs->counters) {
+                cs_counters_tick(cs);
+            }
+            if (cs->coverage) {
+                cs_coverage_tick(cs);
+            }
+            if (cs->profiler) {
+                cs_profiler_tick(cs);
+            }
+        }
+        cs->instructions++;
+
+        /* The state after STOP is the stopped machine */
+        cs->stopped = true;
+        if (cs->trace_file && is_observed) {
+            cs_trace_file_record(cs);
+        }
+        if (cs->history) {
+            cs_history_tick(cs);
+        }
+    }
     cs->stopped = true;
     return CS_OP_DO_NOTHING;
 }
 
 /* Shared SUBI */
 int cs_op_subi_stepper(cs_machine *cs) {
-    return cs_op_arithmetic_stepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
+    return cs_op_arithmetic_stepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
                                     CS_GET_ARG_B(cs->registers.ir), true);
 }
 
 int cs_op_subi_microstepper(cs_machine *cs) {
-    return cs_op_arithmetic_microstepper(cs, cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)],
+    return cs_op_arithmetic_microstepper(cs, cs->regfile[CS_GET_REG_A(cs->registers.ir)],
                                          CS_GET_ARG_B(cs->registers.ir), true);
 }
 
 /* Shared CPI */
 int cs_op_cpi_stepper(cs_machine *cs) {
-    unsigned char a = *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)];
+    unsigned char a = *cs->regfile[CS_GET_REG_A(cs->registers.ir)];
     unsigned char b = CS_GET_ARG_B(cs->registers.ir);
     cs_op_perform_arithmetic(cs, a, b, true);
     return CS_OP_DO_FETCH;
@@ -215,8 +420,8 @@ int cs_op_cpi_stepper(cs_machine *cs) {
 
 /* Shared LDI */
 int cs_op_ldi_stepper(cs_machine *cs) {
-    cs->registers.ac                                       = CS_GET_ARG_B(cs->registers.ir);
-    *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
+    cs->registers.ac                             = CS_GET_ARG_B(cs->registers.ir);
+    *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
     return CS_OP_DO_FETCH;
 }
 
@@ -227,7 +432,7 @@ int cs_op_ldi_microstepper(cs_machine *cs) {
             return CS_OP_DO_MICROFETCH;
         case 1:
         default:
-            *cs->registers.regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
+            *cs->regfile[CS_GET_REG_A(cs->registers.ir)] = cs->registers.ac;
             return CS_OP_DO_FETCH;
     }
 }
@@ -237,3 +442,27 @@ int cs_op_noop_stepper(cs_machine *cs) {
     (void)cs;
     return CS_OP_DO_FETCH;
 }
+
+/* Shared cycle count */
+unsigned char cs_op_cycles(cs_instruction_op const *op) {
+    unsigned char cycles = 0;
+    size_t        i;
+
+    for (i = 0; i < sizeof op->signals / sizeof *op->signals; i++) {
+        /* A fetch on its own is performed along with the previous microoperation */
+        if (op->signals[i] == CS_SIGNALS_NONE || op->signals[i] == CS_SIGNALS_FETCH) {
+            break;
+        }
+        cycles++;
+        if (op->signals[i] & CS_SIGNAL_WIR) {
+            break;
+        }
+    }
+
+    /* BRxx signals describe a taken branch, whose extra microoperation the stepper adds */
+    if (op->stepper == cs_op_brxx_stepper) {
+        cycles--;
+    }
+    /* STOP and the no-ops still take a cycle */
+    return cycles ? cycles : 1;
+}
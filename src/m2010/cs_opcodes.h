@@ -20,6 +20,10 @@
 /* Shared I/O helpers */
 unsigned char cs_read_input(cs_machine *cs, size_t offset);
 void          cs_write_output(cs_machine *cs, size_t offset, unsigned char content);
+unsigned char cs_read_memory(cs_machine *cs, size_t offset);
+void          cs_write_memory(cs_machine *cs, size_t offset, unsigned char content);
+unsigned char cs_read_data(cs_machine *cs, size_t offset);
+void          cs_write_data(cs_machine *cs, size_t offset, unsigned char content);
 
 /* Shared arithmetic helpers */
 int cs_op_arithmetic_stepper(cs_machine *cs, unsigned char *dst_register, unsigned char b, bool is_substracting);
@@ -47,4 +51,12 @@ int cs_op_ldi_microstepper(cs_machine *cs);
 /* Shared no-op */
 int cs_op_noop_stepper(cs_machine *cs);
 
+/**
+ * @brief Counts the clock cycles an opcode's stepper takes from its signals
+ * @param op Pointer to the opcode data
+ * @return Microoperations up to the one fetching the next instruction. A
+ *      taken BRxx takes one more
+ */
+unsigned char cs_op_cycles(cs_instruction_op const *op);
+
 #endif /* CS_OPCODES_H */
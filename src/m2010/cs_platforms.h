@@ -5,6 +5,11 @@
 
 #define CS_PLATFORM_ALL (CS_PLATFORM_2010 | CS_PLATFORM_3)
 
+/* Opt-in features that can be combined with a platform */
+#define CS_PLATFORM_FLAGS (CS_PLATFORM_INTERRUPTS)
+
+#define CS_PLATFORM_BASE(platform) (platform & ~CS_PLATFORM_FLAGS)
+
 #define CS_PLATFORM_IS_AVAILABLE(platforms, platform) (platforms & platform)
 #define CS_PLATFORM_IS_VALID(platform)                (platform == CS_PLATFORM_2010 || platform == CS_PLATFORM_3)
 
@@ -0,0 +1,318 @@
+/** @file cs_profiler.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_report.h"
+
+#include "cs_profiler.h"
+
+#define CS_PROFILER_LABEL_MARK ':'
+
+/** @brief Counters aggregated by source line */
+struct cs_profiler_line {
+    size_t             line;
+    unsigned long long instructions;
+    unsigned long long cycles;
+};
+typedef struct cs_profiler_line cs_profiler_line;
+
+void cs_profiler_tick(cs_machine *cs) {
+    cs_profiler *profiler = cs->profiler;
+
+    profiler->instructions[profiler->address]++;
+    profiler->cycles[profiler->address] += cs->cycles - profiler->start_cycle;
+    profiler->address     = cs->registers.pc - 1;
+    profiler->start_cycle = cs->cycles;
+}
+
+void cs_profiler_restart(cs_machine *cs) {
+    cs->profiler->address     = cs->registers.pc;
+    cs->profiler->start_cycle = cs->cycles;
+}
+
+bool cs_profiler_enable(cs_machine *cs) {
+    if (!cs->profiler) {
+        cs->profiler = calloc(1, sizeof *cs->profiler);
+        if (!cs->profiler) {
+            return false;
+        }
+        /* Attribute the instruction in progress from this point on */
+        cs->profiler->address     = cs->registers.pc - 1;
+        cs->profiler->start_cycle = cs->cycles;
+    }
+    return true;
+}
+
+void cs_profiler_disable(cs_machine *cs) {
+    if (cs->profiler) {
+        free(cs->profiler);
+        cs->profiler = 0;
+    }
+}
+
+void cs_profiler_clear(cs_machine *cs) {
+    if (cs->profiler) {
+        memset(cs->profiler->instructions, 0, sizeof cs->profiler->instructions);
+        memset(cs->profiler->cycles, 0, sizeof cs->profiler->cycles);
+    }
+}
+
+unsigned long long const *cs_profiler_get_instructions(cs_machine const *cs) {
+    return cs->profiler ? cs->profiler->instructions : 0;
+}
+
+unsigned long long const *cs_profiler_get_cycles(cs_machine const *cs) {
+    return cs->profiler ? cs->profiler->cycles : 0;
+}
+
+static int cs_profiler_compare_lines(void const *a, void const *b) {
+    cs_profiler_line const *line_a = a;
+    cs_profiler_line const *line_b = b;
+
+    if (line_a->cycles != line_b->cycles) {
+        return line_a->cycles < line_b->cycles ? 1 : -1;
+    }
+    if (line_a->instructions != line_b->instructions) {
+        return line_a->instructions < line_b->instructions ? 1 : -1;
+    }
+    return line_a->line < line_b->line ? -1 : line_a->line > line_b->line;
+}
+
+/**
+ * @brief Finds the label defined at the start of a source line
+ * @param line Pointer to the start of the line
+ * @param line_length Length of the line
+ * @param label Pointer where the start of the label will be stored
+ * @return Length of the label, or 0 if the line doesn't define a label
+ */
+static size_t cs_profiler_find_label(char const *line, size_t line_length, char const **label) {
+    size_t i = 0;
+    size_t label_length;
+
+    while (i < line_length && isspace((unsigned char)line[i])) {
+        i++;
+    }
+    if (i == line_length || !isalpha((unsigned char)line[i])) {
+        return 0;
+    }
+
+    *label = line + i;
+    while (i < line_length && (isalnum((unsigned char)line[i]) || line[i] == '_')) {
+        i++;
+    }
+    label_length = line + i - *label;
+
+    while (i < line_length && (line[i] == ' ' || line[i] == '\t')) {
+        i++;
+    }
+    return i < line_length && line[i] == CS_PROFILER_LABEL_MARK ? label_length : 0;
+}
+
+/**
+ * @brief Gets the ROM address a label defined at a given line points to,
+ *      which is the first instruction assembled at or after that line
+ * @param machine_code Pointer to the machine code
+ * @param line Source line of the label (1-based)
+ * @return ROM address, or the amount of instructions if none follows
+ */
+static size_t cs_profiler_label_address(struct cs_as_machine_code const *machine_code, size_t line) {
+    size_t address = 0;
+
+    while (address < machine_code->machine_instructions_amount &&
+           machine_code->matching_source_assembly_lines[address] < line) {
+        address++;
+    }
+    return address;
+}
+
+size_t cs_profiler_find_label_at(struct cs_as_machine_code const *machine_code, char const *source, size_t address,
+                                  char const **label) {
+    char const *line_start = source;
+    char const *line_end;
+    size_t      line = 1;
+    size_t      label_length;
+
+    while (*line_start) {
+        line_end = strchr(line_start, '\n');
+        if (!line_end) {
+            line_end = line_start + strlen(line_start);
+        }
+        label_length = cs_profiler_find_label(line_start, line_end - line_start, label);
+        if (label_length && cs_profiler_label_address(machine_code, line) == address) {
+            return label_length;
+        }
+        line_start = *line_end ? line_end + 1 : line_end;
+        line++;
+    }
+    return 0;
+}
+
+bool cs_profiler_find_label_address(struct cs_as_machine_code const *machine_code, char const *source,
+                                    char const *name, size_t name_length, size_t *address) {
+    char const *line_start = source;
+    char const *line_end;
+    char const *label;
+    size_t      line = 1;
+    size_t      label_length;
+    size_t      i;
+
+    while (*line_start) {
+        line_end = strchr(line_start, '\n');
+        if (!line_end) {
+            line_end = line_start + strlen(line_start);
+        }
+        label_length = cs_profiler_find_label(line_start, line_end - line_start, &label);
+        if (label_length == name_length) {
+            for (i = 0; i < name_length && toupper((unsigned char)label[i]) == toupper((unsigned char)name[i]); i++)
+                ;
+            if (i == name_length) {
+                *address = cs_profiler_label_address(machine_code, line);
+                return true;
+            }
+        }
+        line_start = *line_end ? line_end + 1 : line_end;
+        line++;
+    }
+    return false;
+}
+
+static void cs_profiler_print_labels(cs_machine const *cs, struct cs_as_machine_code const *machine_code,
+                                     char const **lines, size_t const *line_lengths, size_t lines_amount,
+                                     cs_report_text *text) {
+    char const        *label;
+    char const        *next_label;
+    size_t             label_length;
+    size_t             line;
+    size_t             next_line;
+    size_t             next_address;
+    size_t             start;
+    size_t             end;
+    size_t             i;
+    unsigned long long instructions;
+    unsigned long long cycles;
+
+    cs_report_printf(text, "\nLabels:\n%20s %20s  %s\n", "cycles", "instructions", "label");
+    for (line = 1; line <= lines_amount; line++) {
+        label_length = cs_profiler_find_label(lines[line - 1], line_lengths[line - 1], &label);
+        if (!label_length) {
+            continue;
+        }
+
+        start = cs_profiler_label_address(machine_code, line);
+        if (start == machine_code->machine_instructions_amount) {
+            continue;
+        }
+
+        /* The label extends until the next one pointing to a later instruction */
+        end = machine_code->machine_instructions_amount;
+        for (next_line = line + 1; next_line <= lines_amount; next_line++) {
+            if (!cs_profiler_find_label(lines[next_line - 1], line_lengths[next_line - 1], &next_label)) {
+                continue;
+            }
+            next_address = cs_profiler_label_address(machine_code, next_line);
+            if (next_address > start) {
+                end = next_address;
+                break;
+            }
+        }
+
+        instructions = 0;
+        cycles       = 0;
+        for (i = start; i < end && i < CS_ROM_SIZE; i++) {
+            instructions += cs->profiler->instructions[i];
+            cycles += cs->profiler->cycles[i];
+        }
+        cs_report_printf(text, "%20llu %20llu  %.*s\n", cycles, instructions, (int)label_length, label);
+    }
+}
+
+char *cs_profiler_report(cs_machine const *cs, struct cs_as_machine_code const *machine_code, char const *source,
+                         size_t max_hottest_lines) {
+    cs_report_text     text = {0, 0, 0, false};
+    cs_profiler_line  *line_counters;
+    cs_profiler_line  *hottest_lines;
+    char const       **lines;
+    size_t            *line_lengths;
+    size_t             lines_amount;
+    size_t             line;
+    size_t             i;
+    unsigned long long total_instructions = 0;
+    unsigned long long total_cycles       = 0;
+
+    if (!cs->profiler || !machine_code || !source) {
+        return 0;
+    }
+
+    lines_amount = cs_report_split_lines(source, &lines, &line_lengths);
+    if (!lines_amount) {
+        return 0;
+    }
+    line_counters = calloc(lines_amount + 1, sizeof *line_counters);
+    hottest_lines = malloc(sizeof *hottest_lines * lines_amount);
+    if (!line_counters || !hottest_lines) {
+        free(lines);
+        free(line_lengths);
+        free(line_counters);
+        free(hottest_lines);
+        return 0;
+    }
+
+    /* Aggregate the counters by source line (1-based, as the assembler reports them) */
+    for (line = 0; line <= lines_amount; line++) {
+        line_counters[line].line = line;
+    }
+    for (i = 0; i < machine_code->machine_instructions_amount && i < CS_ROM_SIZE; i++) {
+        line = machine_code->matching_source_assembly_lines[i];
+        if (line <= lines_amount) {
+            line_counters[line].instructions += cs->profiler->instructions[i];
+            line_counters[line].cycles += cs->profiler->cycles[i];
+        }
+    }
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        total_instructions += cs->profiler->instructions[i];
+        total_cycles += cs->profiler->cycles[i];
+    }
+
+    cs_report_printf(&text, "Total: %llu instructions, %llu cycles\n", total_instructions, total_cycles);
+
+    /* Hottest lines */
+    cs_report_printf(&text, "\nHottest lines:\n%20s %20s %7s %6s  %s\n", "cycles", "instructions", "%", "line",
+                     "source");
+    memcpy(hottest_lines, line_counters + 1, sizeof *hottest_lines * lines_amount);
+    qsort(hottest_lines, lines_amount, sizeof *hottest_lines, cs_profiler_compare_lines);
+    for (i = 0; i < lines_amount && i < max_hottest_lines && hottest_lines[i].instructions; i++) {
+        line = hottest_lines[i].line;
+        cs_report_printf(&text, "%20llu %20llu %6.2f%% %6" PRI_SIZET "  %.*s\n", hottest_lines[i].cycles,
+                         hottest_lines[i].instructions,
+                         total_cycles ? 100.0 * hottest_lines[i].cycles / total_cycles : 0.0, line,
+                         (int)line_lengths[line - 1], lines[line - 1]);
+    }
+
+    cs_profiler_print_labels(cs, machine_code, lines, line_lengths, lines_amount, &text);
+
+    /* Annotated listing */
+    cs_report_printf(&text, "\nListing:\n%20s %20s  %s\n", "cycles", "instructions", "source");
+    for (line = 1; line <= lines_amount; line++) {
+        if (line_counters[line].instructions) {
+            cs_report_printf(&text, "%20llu %20llu  %.*s\n", line_counters[line].cycles,
+                             line_counters[line].instructions, (int)line_lengths[line - 1], lines[line - 1]);
+        } else {
+            cs_report_printf(&text, "%20s %20s  %.*s\n", "", "", (int)line_lengths[line - 1], lines[line - 1]);
+        }
+    }
+
+    free(lines);
+    free(line_lengths);
+    free(line_counters);
+    free(hottest_lines);
+
+    return cs_report_finish(&text);
+}
@@ -0,0 +1,60 @@
+/** @file cs_profiler.h */
+
+#ifndef CS_PROFILER_H
+#define CS_PROFILER_H
+
+#include "cs.h"
+
+typedef struct cs_profiler cs_profiler;
+
+/** @brief Per-PC execution counters */
+struct cs_profiler {
+    /** @brief Completed instructions by ROM address */
+    unsigned long long instructions[CS_ROM_SIZE];
+    /** @brief Clock cycles by ROM address */
+    unsigned long long cycles[CS_ROM_SIZE];
+    /** @brief ROM address of the instruction being executed */
+    unsigned char address;
+    /** @brief Value of the cycle counter when that instruction was fetched */
+    unsigned long long start_cycle;
+};
+
+/**
+ * @brief Notifies the profiler that an instruction has been completed
+ *      and the next one fetched. Cycles spent entering an interrupt are
+ *      attributed to the completed instruction
+ * @param cs Pointer to the emulation instance
+ */
+void cs_profiler_tick(cs_machine *cs);
+
+/**
+ * @brief Resynchronizes the profiler after the PC or the cycle counter
+ *      have been reset
+ * @param cs Pointer to the emulation instance
+ */
+void cs_profiler_restart(cs_machine *cs);
+
+/**
+ * @brief Finds the first label of the source pointing to a given ROM address
+ * @param machine_code Machine code assembled from the source
+ * @param source Assembly source
+ * @param address ROM address
+ * @param label Pointer where the start of the label will be stored
+ * @return Length of the label, or 0 if no label points to the address
+ */
+size_t cs_profiler_find_label_at(struct cs_as_machine_code const *machine_code, char const *source, size_t address,
+                                 char const **label);
+
+/**
+ * @brief Finds the ROM address a label of the source points to
+ * @param machine_code Machine code assembled from the source
+ * @param source Assembly source
+ * @param name Label name, compared case-insensitively
+ * @param name_length Length of the label name
+ * @param address Pointer where the ROM address will be stored
+ * @return true if the label was found, false otherwise
+ */
+bool cs_profiler_find_label_address(struct cs_as_machine_code const *machine_code, char const *source,
+                                    char const *name, size_t name_length, size_t *address);
+
+#endif /* CS_PROFILER_H */
@@ -0,0 +1,95 @@
+/** @file cs_report.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cs_report.h"
+
+void cs_report_printf(cs_report_text *text, char const *format, ...) {
+    va_list va;
+    int     length;
+    size_t  capacity;
+    char   *buffer;
+
+    if (text->failed) {
+        return;
+    }
+
+    va_start(va, format);
+    length = vsnprintf(0, 0, format, va);
+    va_end(va);
+    if (length < 0) {
+        text->failed = true;
+        return;
+    }
+
+    if (text->length + length + 1 > text->capacity) {
+        capacity = text->capacity ? text->capacity : 1024;
+        while (text->length + length + 1 > capacity) {
+            capacity <<= 1;
+        }
+        buffer = realloc(text->buffer, capacity);
+        if (!buffer) {
+            text->failed = true;
+            return;
+        }
+        text->buffer   = buffer;
+        text->capacity = capacity;
+    }
+
+    va_start(va, format);
+    vsnprintf(text->buffer + text->length, text->capacity - text->length, format, va);
+    va_end(va);
+    text->length += length;
+}
+
+char *cs_report_finish(cs_report_text *text) {
+    if (text->failed) {
+        free(text->buffer);
+        text->buffer = 0;
+    }
+    return text->buffer;
+}
+
+size_t cs_report_split_lines(char const *source, char const ***lines, size_t **line_lengths) {
+    size_t      lines_amount = 1;
+    size_t      line;
+    char const *tracker;
+
+    for (tracker = source; *tracker; tracker++) {
+        if (*tracker == '\n') {
+            lines_amount++;
+        }
+    }
+
+    *lines        = malloc(sizeof **lines * lines_amount);
+    *line_lengths = malloc(sizeof **line_lengths * lines_amount);
+    if (!*lines || !*line_lengths) {
+        free(*lines);
+        free(*line_lengths);
+        *lines        = 0;
+        *line_lengths = 0;
+        return 0;
+    }
+
+    tracker = source;
+    for (line = 0; line < lines_amount; line++) {
+        (*lines)[line] = tracker;
+        while (*tracker && *tracker != '\n') {
+            tracker++;
+        }
+        (*line_lengths)[line] = tracker - (*lines)[line];
+        if ((*line_lengths)[line] && (*lines)[line][(*line_lengths)[line] - 1] == '\r') {
+            (*line_lengths)[line]--;
+        }
+        if (*tracker) {
+            tracker++;
+        }
+    }
+    return lines_amount;
+}
@@ -0,0 +1,48 @@
+/** @file cs_report.h */
+
+#ifndef CS_REPORT_H
+#define CS_REPORT_H
+
+#include <stddef.h>
+
+#include "../utils.h"
+
+typedef struct cs_report_text cs_report_text;
+
+/** @brief Growable report text */
+struct cs_report_text {
+    /** @brief Null-terminated text, or null pointer while empty */
+    char *buffer;
+    /** @brief Text length */
+    size_t length;
+    /** @brief Allocated buffer size */
+    size_t capacity;
+    /** @brief Whether an allocation failed, discarding further output */
+    bool failed;
+};
+
+/**
+ * @brief Appends a formatted string to a report text
+ * @param text Pointer to the report text
+ * @param format Format of the string
+ * @param ... Parameters to be passed to printf function
+ */
+void cs_report_printf(cs_report_text *text, char const *format, ...);
+
+/**
+ * @brief Ends a report text, freeing it if an allocation failed
+ * @param text Pointer to the report text
+ * @return Text, or null pointer if it's empty or an allocation failed
+ */
+char *cs_report_finish(cs_report_text *text);
+
+/**
+ * @brief Splits an assembly source into lines, dropping line terminators
+ * @param source Assembly source
+ * @param lines Pointer where the start of each line will be stored. It must be freed
+ * @param line_lengths Pointer where the length of each line will be stored. It must be freed
+ * @return Amount of lines, at least 1, or 0 if no enough memory is available
+ */
+size_t cs_report_split_lines(char const *source, char const ***lines, size_t **line_lengths);
+
+#endif /* CS_REPORT_H */
@@ -3,6 +3,6 @@
 #ifndef CS_SIGNALS_H
 #define CS_SIGNALS_H
 
-typedef unsigned long cs_signals;
+typedef unsigned int cs_signals;
 
 #endif /* CS_SIGNALS_H */
@@ -0,0 +1,106 @@
+/** @file cs_snapshot.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_snapshot.h"
+
+/* Memory ordering primitives. Targets without threads (such as WASI)
+   only need the compiler not to reorder accesses around them */
+#if defined(__GNUC__) || defined(__clang__)
+#define CS_SNAPSHOT_LOAD_ACQUIRE(x)     __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define CS_SNAPSHOT_STORE_RELEASE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define CS_SNAPSHOT_FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define CS_SNAPSHOT_FENCE_RELEASE()     __atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define CS_SNAPSHOT_LOAD_ACQUIRE(x)     ((x))
+#define CS_SNAPSHOT_STORE_RELEASE(x, v) ((x) = (v))
+#define CS_SNAPSHOT_FENCE_ACQUIRE()     _ReadWriteBarrier()
+#define CS_SNAPSHOT_FENCE_RELEASE()     _ReadWriteBarrier()
+#else
+#define CS_SNAPSHOT_LOAD_ACQUIRE(x)     ((x))
+#define CS_SNAPSHOT_STORE_RELEASE(x, v) ((x) = (v))
+#define CS_SNAPSHOT_FENCE_ACQUIRE()
+#define CS_SNAPSHOT_FENCE_RELEASE()
+#endif
+
+static void cs_snapshot_capture(cs_machine *cs, cs_snapshot_state *state, unsigned long publication) {
+    state->publication = publication;
+    state->registers   = cs->registers;
+    state->signals     = cs->signals;
+    state->microop     = cs->microop;
+    state->stopped     = cs->stopped;
+    memcpy(state->ram, cs->memory.ram, CS_RAM_SIZE * sizeof *cs->memory.ram);
+}
+
+bool cs_snapshot_enable(cs_machine *cs, size_t interval) {
+    if (!cs->snapshot) {
+        cs->snapshot = malloc(sizeof *cs->snapshot);
+        if (!cs->snapshot) {
+            return false;
+        }
+        cs->snapshot->sequence = 0;
+        cs_snapshot_capture(cs, &cs->snapshot->buffers[0], 0);
+        cs_snapshot_capture(cs, &cs->snapshot->buffers[1], 0);
+    }
+
+    cs->snapshot->interval  = interval;
+    cs->snapshot->countdown = interval;
+    return true;
+}
+
+void cs_snapshot_disable(cs_machine *cs) {
+    if (cs->snapshot) {
+        free(cs->snapshot);
+        cs->snapshot = 0;
+    }
+}
+
+void cs_snapshot_publish(cs_machine *cs) {
+    cs_snapshot  *snapshot = cs->snapshot;
+    unsigned long sequence;
+
+    if (!snapshot) {
+        return;
+    }
+
+    /* Only the emulator thread writes the sequence, so a plain read is enough */
+    sequence = snapshot->sequence;
+    CS_SNAPSHOT_STORE_RELEASE(snapshot->sequence, sequence + 1);
+    CS_SNAPSHOT_FENCE_RELEASE();
+    cs_snapshot_capture(cs, &snapshot->buffers[((sequence >> 1) + 1) & 1], (sequence >> 1) + 1);
+    CS_SNAPSHOT_STORE_RELEASE(snapshot->sequence, sequence + 2);
+}
+
+void cs_snapshot_tick(cs_machine *cs) {
+    if (!cs->snapshot->interval || --cs->snapshot->countdown) {
+        return;
+    }
+
+    cs->snapshot->countdown = cs->snapshot->interval;
+    cs_snapshot_publish(cs);
+}
+
+bool cs_snapshot_read(cs_machine const *cs, cs_snapshot_state *state) {
+    cs_snapshot const *snapshot = cs->snapshot;
+    unsigned long      start;
+    unsigned long      end;
+
+    if (!snapshot) {
+        return false;
+    }
+
+    do {
+        start = CS_SNAPSHOT_LOAD_ACQUIRE(snapshot->sequence);
+        memcpy(state, &snapshot->buffers[(start >> 1) & 1], sizeof *state);
+        CS_SNAPSHOT_FENCE_ACQUIRE();
+        end = CS_SNAPSHOT_LOAD_ACQUIRE(snapshot->sequence);
+        /* The buffer being read is only rewritten after the writer has
+           completed the publication of the other one */
+    } while (end - (start & ~1ul) > 2);
+
+    return true;
+}
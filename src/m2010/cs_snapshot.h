@@ -0,0 +1,36 @@
+/** @file cs_snapshot.h */
+
+#ifndef CS_SNAPSHOT_H
+#define CS_SNAPSHOT_H
+
+#include "cs.h"
+
+typedef struct cs_snapshot       cs_snapshot;
+typedef struct cs_snapshot_state cs_snapshot_state;
+
+/**
+ * @brief Double-buffered seqlock protecting the published state.
+ *      The emulator thread is the only writer. It always fills the
+ *      buffer that is not currently published, so readers only retry
+ *      when two publications overlap a single copy
+ */
+struct cs_snapshot {
+    /** @brief Sequence counter. Odd while a publication is in progress.
+     *      The published buffer is (sequence >> 1) & 1 */
+    volatile unsigned long sequence;
+    /** @brief Instructions between automatic publications (0 = on demand only) */
+    size_t interval;
+    /** @brief Instructions left until the next automatic publication */
+    size_t countdown;
+    /** @brief Published buffers */
+    cs_snapshot_state buffers[2];
+};
+
+/**
+ * @brief Notifies the snapshot that an instruction has been completed,
+ *      publishing the machine state if the configured interval elapsed
+ * @param cs Pointer to the emulation instance
+ */
+void cs_snapshot_tick(cs_machine *cs);
+
+#endif /* CS_SNAPSHOT_H */
@@ -0,0 +1,62 @@
+/** @file cs_trace.c */
+
+#include "../../include/asm2010.h"
+
+#include "cs_trace.h"
+
+/* Hosts rely on the records being tightly packed */
+typedef char cs_trace_record_check_size[sizeof(cs_trace_record) == 12 ? 1 : -1];
+
+void cs_trace_write(cs_machine *cs, size_t offset, unsigned char content) {
+    cs->trace_record->ram_address = offset;
+    cs->trace_record->ram_value   = content;
+    cs->trace_record->flags |= CS_TRACE_RAM_WRITE;
+}
+
+size_t cs_run_traced(cs_machine *cs, size_t steps, bool microsteps, cs_trace_record *records) {
+    cs_trace_record *record;
+    unsigned char    previous[8];
+    size_t           i;
+    size_t           j;
+
+    for (i = 0; i < steps && !cs->stopped; i++) {
+        record = &records[i];
+        for (j = 0; j < 8; j++) {
+            previous[j] = *cs->regfile[j];
+        }
+
+        record->changed_register       = CS_TRACE_NO_REGISTER;
+        record->changed_register_value = 0;
+        record->ram_address            = 0;
+        record->ram_value              = 0;
+        record->flags                  = 0;
+        record->reserved               = 0;
+
+        cs->trace_record = record;
+        if (microsteps) {
+            cs_microstep(cs);
+        } else {
+            cs_fullstep(cs);
+        }
+        cs->trace_record = 0;
+
+        for (j = 0; j < 8; j++) {
+            if (*cs->regfile[j] != previous[j]) {
+                record->changed_register       = j;
+                record->changed_register_value = *cs->regfile[j];
+                break;
+            }
+        }
+
+        record->ir      = cs->registers.ir;
+        record->pc      = cs->registers.pc;
+        record->sr      = cs->registers.sr;
+        record->ac      = cs->registers.ac;
+        record->microop = cs->microop;
+        if (cs->stopped) {
+            record->flags |= CS_TRACE_STOPPED;
+        }
+    }
+
+    return i;
+}
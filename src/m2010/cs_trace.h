@@ -0,0 +1,18 @@
+/** @file cs_trace.h */
+
+#ifndef CS_TRACE_H
+#define CS_TRACE_H
+
+#include "cs.h"
+
+typedef struct cs_trace_record cs_trace_record;
+
+/**
+ * @brief Notes a memory write in the record of the step being traced
+ * @param cs Pointer to the emulation instance
+ * @param offset Address written to
+ * @param content Value written
+ */
+void cs_trace_write(cs_machine *cs, size_t offset, unsigned char content);
+
+#endif /* CS_TRACE_H */
@@ -0,0 +1,520 @@
+/** @file cs_trace_file.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_accesses.h"
+#include "cs_call_graph.h"
+#include "cs_instructions.h"
+#include "cs_interrupts.h"
+#include "cs_loops.h"
+#include "cs_platforms.h"
+#include "cs_profiler.h"
+
+#include "cs_trace_file.h"
+
+#define CS_TRACE_FILE_MAGIC_LENGTH   4
+#define CS_TRACE_FILE_TRAILER_LENGTH (8 + CS_TRACE_FILE_MAGIC_LENGTH)
+
+/** @brief Architectural state rebuilt while reading a trace */
+struct cs_trace_file_state {
+    unsigned char      registers[CS_TRACE_FILE_REGISTERS];
+    unsigned char      ram[CS_RAM_SIZE];
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned char      stopped;
+};
+typedef struct cs_trace_file_state cs_trace_file_state;
+
+static void cs_trace_file_pack_registers(cs_machine const *cs, unsigned char *registers) {
+    registers[0]  = cs->registers.ir & 0xFFu;
+    registers[1]  = cs->registers.ir >> 8;
+    registers[2]  = cs->registers.r0;
+    registers[3]  = cs->registers.r1;
+    registers[4]  = cs->registers.r2;
+    registers[5]  = cs->registers.r3;
+    registers[6]  = cs->registers.r4;
+    registers[7]  = cs->registers.r5;
+    registers[8]  = cs->registers.r6;
+    registers[9]  = cs->registers.r7;
+    registers[10] = cs->registers.sp;
+    registers[11] = cs->registers.pc;
+    registers[12] = cs->registers.ac;
+    registers[13] = cs->registers.sr;
+    registers[14] = cs->registers.mdr;
+    registers[15] = cs->registers.mar;
+}
+
+static void cs_trace_file_unpack_registers(cs_machine *cs, unsigned char const *registers) {
+    cs->registers.ir  = registers[0] | (unsigned short)(registers[1] << 8);
+    cs->registers.r0  = registers[2];
+    cs->registers.r1  = registers[3];
+    cs->registers.r2  = registers[4];
+    cs->registers.r3  = registers[5];
+    cs->registers.r4  = registers[6];
+    cs->registers.r5  = registers[7];
+    cs->registers.r6  = registers[8];
+    cs->registers.r7  = registers[9];
+    cs->registers.sp  = registers[10];
+    cs->registers.pc  = registers[11];
+    cs->registers.ac  = registers[12];
+    cs->registers.sr  = registers[13];
+    cs->registers.mdr = registers[14];
+    cs->registers.mar = registers[15];
+}
+
+/**
+ * @brief Fills in the register bytes a delta doesn't need to store:
+ *      PC advanced by one and IR holding the ROM word before PC
+ * @param registers Register bytes of the previous entry, updated in place
+ * @param rom ROM contents
+ */
+static void cs_trace_file_expect_registers(unsigned char *registers, unsigned short const *rom) {
+    unsigned short ir;
+
+    registers[CS_TRACE_FILE_REGISTER_PC]++;
+    ir           = rom[(unsigned char)(registers[CS_TRACE_FILE_REGISTER_PC] - 1)];
+    registers[0] = ir & 0xFFu;
+    registers[1] = ir >> 8;
+}
+
+/* Writing */
+static void cs_trace_file_put(cs_trace_file *trace_file, void const *data, size_t size) {
+    if (fwrite(data, 1, size, trace_file->file) != size) {
+        trace_file->failed = true;
+    }
+    trace_file->offset += size;
+}
+
+static void cs_trace_file_put_byte(cs_trace_file *trace_file, unsigned char byte) {
+    cs_trace_file_put(trace_file, &byte, 1);
+}
+
+static void cs_trace_file_put_varint(cs_trace_file *trace_file, unsigned long long value) {
+    unsigned char buffer[10];
+    size_t        length = 0;
+
+    do {
+        buffer[length] = value & 0x7Fu;
+        value >>= 7;
+        buffer[length++] |= value ? 0x80u : 0;
+    } while (value);
+    cs_trace_file_put(trace_file, buffer, length);
+}
+
+static void cs_trace_file_put_keyframe(cs_machine *cs) {
+    cs_trace_file          *trace_file = cs->trace_file;
+    cs_trace_file_keyframe *keyframes;
+    size_t                  capacity;
+
+    if (trace_file->keyframes_amount == trace_file->keyframes_capacity) {
+        capacity  = trace_file->keyframes_capacity ? trace_file->keyframes_capacity * 2 : 64;
+        keyframes = realloc(trace_file->keyframes, sizeof *keyframes * capacity);
+        if (!keyframes) {
+            trace_file->failed = true;
+            return;
+        }
+        trace_file->keyframes          = keyframes;
+        trace_file->keyframes_capacity = capacity;
+    }
+    trace_file->keyframes[trace_file->keyframes_amount].instruction = trace_file->instruction;
+    trace_file->keyframes[trace_file->keyframes_amount].offset      = trace_file->offset;
+    trace_file->keyframes_amount++;
+
+    cs_trace_file_pack_registers(cs, trace_file->registers);
+    memcpy(trace_file->ram, cs->memory.ram, CS_RAM_SIZE);
+    trace_file->cycles  = cs->cycles;
+    trace_file->stopped = cs->stopped;
+
+    cs_trace_file_put_byte(trace_file, CS_TRACE_FILE_TAG_KEYFRAME);
+    cs_trace_file_put_varint(trace_file, trace_file->instruction);
+    cs_trace_file_put_varint(trace_file, trace_file->cycles);
+    cs_trace_file_put_varint(trace_file, cs->instructions);
+    cs_trace_file_put(trace_file, trace_file->registers, CS_TRACE_FILE_REGISTERS);
+    cs_trace_file_put_byte(trace_file, trace_file->stopped);
+    cs_trace_file_put(trace_file, trace_file->ram, CS_RAM_SIZE);
+}
+
+void cs_trace_file_record(cs_machine *cs) {
+    cs_trace_file *trace_file = cs->trace_file;
+    unsigned char  registers[CS_TRACE_FILE_REGISTERS];
+    unsigned long  mask = 0;
+    size_t         ram_writes = 0;
+    size_t         i;
+    unsigned char  tag = 0;
+
+    trace_file->instruction++;
+
+    /* Resets can't be expressed as deltas */
+    if (trace_file->instruction % trace_file->keyframe_interval == 0 || cs->cycles < trace_file->cycles ||
+        (trace_file->stopped && !cs->stopped)) {
+        cs_trace_file_put_keyframe(cs);
+        return;
+    }
+
+    cs_trace_file_expect_registers(trace_file->registers, cs->memory.rom);
+    cs_trace_file_pack_registers(cs, registers);
+    for (i = 0; i < CS_TRACE_FILE_REGISTERS; i++) {
+        if (registers[i] != trace_file->registers[i]) {
+            mask |= 1ul << i;
+        }
+    }
+
+    if (memcmp(cs->memory.ram, trace_file->ram, CS_RAM_SIZE)) {
+        for (i = 0; i < CS_RAM_SIZE; i++) {
+            ram_writes += cs->memory.ram[i] != trace_file->ram[i];
+        }
+    }
+
+    tag |= mask ? CS_TRACE_FILE_DELTA_REGISTERS : 0;
+    tag |= ram_writes ? CS_TRACE_FILE_DELTA_RAM : 0;
+    tag |= cs->stopped && !trace_file->stopped ? CS_TRACE_FILE_DELTA_STOPPED : 0;
+    cs_trace_file_put_byte(trace_file, tag);
+    cs_trace_file_put_varint(trace_file, cs->cycles - trace_file->cycles);
+
+    if (mask) {
+        cs_trace_file_put_varint(trace_file, mask);
+        for (i = 0; i < CS_TRACE_FILE_REGISTERS; i++) {
+            if (mask & (1ul << i)) {
+                cs_trace_file_put_byte(trace_file, registers[i]);
+            }
+        }
+        memcpy(trace_file->registers, registers, CS_TRACE_FILE_REGISTERS);
+    }
+
+    if (ram_writes) {
+        cs_trace_file_put_varint(trace_file, ram_writes);
+        for (i = 0; i < CS_RAM_SIZE; i++) {
+            if (cs->memory.ram[i] != trace_file->ram[i]) {
+                cs_trace_file_put_byte(trace_file, i);
+                cs_trace_file_put_byte(trace_file, cs->memory.ram[i]);
+                trace_file->ram[i] = cs->memory.ram[i];
+            }
+        }
+    }
+
+    trace_file->cycles  = cs->cycles;
+    trace_file->stopped = cs->stopped;
+}
+
+bool cs_trace_file_open(cs_machine *cs, char const *path, unsigned long keyframe_interval) {
+    cs_trace_file *trace_file;
+    size_t         i;
+
+    cs_trace_file_close(cs);
+    if (!keyframe_interval) {
+        return false;
+    }
+
+    trace_file = calloc(1, sizeof *trace_file);
+    if (!trace_file) {
+        return false;
+    }
+
+    trace_file->file = fopen(path, "wb");
+    if (!trace_file->file) {
+        free(trace_file);
+        return false;
+    }
+
+    cs->trace_file                = trace_file;
+    trace_file->keyframe_interval = keyframe_interval;
+
+    cs_trace_file_put(trace_file, CS_TRACE_FILE_MAGIC, CS_TRACE_FILE_MAGIC_LENGTH);
+    cs_trace_file_put_byte(trace_file, CS_TRACE_FILE_VERSION);
+    cs_trace_file_put_byte(trace_file, CS_PLATFORM_BASE(cs->platform));
+    cs_trace_file_put_varint(trace_file, keyframe_interval);
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        cs_trace_file_put_byte(trace_file, cs->memory.rom[i] & 0xFFu);
+        cs_trace_file_put_byte(trace_file, cs->memory.rom[i] >> 8);
+    }
+    cs_trace_file_put_keyframe(cs);
+
+    if (trace_file->failed) {
+        cs_trace_file_close(cs);
+        return false;
+    }
+    return true;
+}
+
+bool cs_trace_file_close(cs_machine *cs) {
+    cs_trace_file     *trace_file = cs->trace_file;
+    unsigned long long index_offset;
+    size_t             i;
+    bool               success;
+
+    if (!trace_file) {
+        return false;
+    }
+
+    index_offset = trace_file->offset;
+    cs_trace_file_put_byte(trace_file, CS_TRACE_FILE_TAG_INDEX);
+    cs_trace_file_put_varint(trace_file, trace_file->keyframes_amount);
+    for (i = 0; i < trace_file->keyframes_amount; i++) {
+        cs_trace_file_put_varint(trace_file, trace_file->keyframes[i].instruction);
+        cs_trace_file_put_varint(trace_file, trace_file->keyframes[i].offset);
+    }
+    for (i = 0; i < 8; i++) {
+        cs_trace_file_put_byte(trace_file, (index_offset >> (8 * i)) & 0xFFu);
+    }
+    cs_trace_file_put(trace_file, CS_TRACE_FILE_INDEX_MAGIC, CS_TRACE_FILE_MAGIC_LENGTH);
+
+    success = !trace_file->failed;
+    if (fclose(trace_file->file)) {
+        success = false;
+    }
+    free(trace_file->keyframes);
+    free(trace_file);
+    cs->trace_file = 0;
+    return success;
+}
+
+/* Reading */
+static bool cs_trace_file_get(FILE *file, void *data, size_t size) {
+    return fread(data, 1, size, file) == size;
+}
+
+/**
+ * @brief Moves to an absolute offset of a trace file. MSVC's fseek takes a
+ *      32-bit long, so it uses _fseeki64 instead
+ * @param file Trace file
+ * @param offset Offset from the beginning of the file
+ * @return true if success, false if the offset doesn't fit or it failed
+ */
+static bool cs_trace_file_set_offset(FILE *file, unsigned long long offset) {
+#ifdef _MSC_VER
+    return offset <= LLONG_MAX && !_fseeki64(file, (long long)offset, SEEK_SET);
+#else
+    return offset <= LONG_MAX && !fseek(file, (long)offset, SEEK_SET);
+#endif /* _MSC_VER */
+}
+
+static bool cs_trace_file_get_varint(FILE *file, unsigned long long *value) {
+    int    byte;
+    size_t shift = 0;
+
+    *value = 0;
+    do {
+        byte = fgetc(file);
+        if (byte == EOF || shift > 63) {
+            return false;
+        }
+        *value |= (unsigned long long)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return true;
+}
+
+static bool cs_trace_file_get_keyframe(FILE *file, cs_trace_file_state *state, unsigned long long *instruction) {
+    int stopped;
+
+    if (!cs_trace_file_get_varint(file, instruction) || !cs_trace_file_get_varint(file, &state->cycles) ||
+        !cs_trace_file_get_varint(file, &state->instructions) ||
+        !cs_trace_file_get(file, state->registers, CS_TRACE_FILE_REGISTERS)) {
+        return false;
+    }
+    stopped = fgetc(file);
+    if (stopped == EOF) {
+        return false;
+    }
+    state->stopped = stopped;
+    return cs_trace_file_get(file, state->ram, CS_RAM_SIZE);
+}
+
+static bool cs_trace_file_get_delta(FILE *file, unsigned char tag, cs_trace_file_state *state,
+                                    unsigned short const *rom) {
+    unsigned long long value;
+    unsigned long long mask;
+    unsigned long long ram_writes;
+    unsigned char      ram_write[2];
+    size_t             i;
+    int                byte;
+
+    if (!cs_trace_file_get_varint(file, &value)) {
+        return false;
+    }
+    state->cycles += value;
+    state->instructions++;
+
+    cs_trace_file_expect_registers(state->registers, rom);
+    if (tag & CS_TRACE_FILE_DELTA_REGISTERS) {
+        if (!cs_trace_file_get_varint(file, &mask)) {
+            return false;
+        }
+        for (i = 0; i < CS_TRACE_FILE_REGISTERS; i++) {
+            if (mask & (1ull << i)) {
+                byte = fgetc(file);
+                if (byte == EOF) {
+                    return false;
+                }
+                state->registers[i] = byte;
+            }
+        }
+    }
+
+    if (tag & CS_TRACE_FILE_DELTA_RAM) {
+        if (!cs_trace_file_get_varint(file, &ram_writes)) {
+            return false;
+        }
+        while (ram_writes--) {
+            if (!cs_trace_file_get(file, ram_write, 2)) {
+                return false;
+            }
+            state->ram[ram_write[0]] = ram_write[1];
+        }
+    }
+
+    if (tag & CS_TRACE_FILE_DELTA_STOPPED) {
+        state->stopped = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the keyframe index of a closed trace, finding the last
+ *      keyframe at or before a given instruction
+ * @param file Trace file
+ * @param instruction Instruction number
+ * @param keyframe Pointer where the keyframe position will be stored
+ * @return CS_TRACE_FILE_OK if found, or the error code otherwise
+ */
+static int cs_trace_file_find_keyframe(FILE *file, unsigned long long instruction, cs_trace_file_keyframe *keyframe) {
+    unsigned char          trailer[CS_TRACE_FILE_TRAILER_LENGTH];
+    unsigned long long     index_offset = 0;
+    unsigned long long     keyframes_amount;
+    cs_trace_file_keyframe current;
+    bool                   found = false;
+    size_t                 i;
+
+    if (fseek(file, -CS_TRACE_FILE_TRAILER_LENGTH, SEEK_END) || !cs_trace_file_get(file, trailer, sizeof trailer)) {
+        return CS_TRACE_FILE_INVALID;
+    }
+    if (memcmp(trailer + 8, CS_TRACE_FILE_INDEX_MAGIC, CS_TRACE_FILE_MAGIC_LENGTH)) {
+        return CS_TRACE_FILE_INVALID;
+    }
+    for (i = 0; i < 8; i++) {
+        index_offset |= (unsigned long long)trailer[i] << (8 * i);
+    }
+
+    if (!cs_trace_file_set_offset(file, index_offset)) {
+        return CS_TRACE_FILE_FAILED;
+    }
+    if (fgetc(file) != CS_TRACE_FILE_TAG_INDEX ||
+        !cs_trace_file_get_varint(file, &keyframes_amount)) {
+        return CS_TRACE_FILE_INVALID;
+    }
+
+    /* Keyframes are indexed in increasing instruction order */
+    while (keyframes_amount--) {
+        if (!cs_trace_file_get_varint(file, &current.instruction) ||
+            !cs_trace_file_get_varint(file, &current.offset)) {
+            return CS_TRACE_FILE_INVALID;
+        }
+        if (current.instruction > instruction) {
+            break;
+        }
+        *keyframe = current;
+        found     = true;
+    }
+    return found ? CS_TRACE_FILE_OK : CS_TRACE_FILE_OUT_OF_RANGE;
+}
+
+static int cs_trace_file_replay(FILE *file, cs_machine *cs, unsigned long long instruction, unsigned short *rom,
+                                cs_trace_file_state *state) {
+    unsigned char          header[CS_TRACE_FILE_MAGIC_LENGTH + 2];
+    unsigned char          rom_bytes[2 * CS_ROM_SIZE];
+    unsigned long long     keyframe_interval;
+    unsigned long long     current;
+    cs_trace_file_keyframe keyframe;
+    int                    tag;
+    int                    status;
+    size_t                 i;
+
+    if (!cs_trace_file_get(file, header, sizeof header) ||
+        memcmp(header, CS_TRACE_FILE_MAGIC, CS_TRACE_FILE_MAGIC_LENGTH) ||
+        header[CS_TRACE_FILE_MAGIC_LENGTH] != CS_TRACE_FILE_VERSION ||
+        header[CS_TRACE_FILE_MAGIC_LENGTH + 1] != CS_PLATFORM_BASE(cs->platform) ||
+        !cs_trace_file_get_varint(file, &keyframe_interval) || !cs_trace_file_get(file, rom_bytes, sizeof rom_bytes)) {
+        return CS_TRACE_FILE_INVALID;
+    }
+    for (i = 0; i < CS_ROM_SIZE; i++) {
+        rom[i] = rom_bytes[2 * i] | (unsigned short)(rom_bytes[2 * i + 1] << 8);
+    }
+
+    status = cs_trace_file_find_keyframe(file, instruction, &keyframe);
+    if (status != CS_TRACE_FILE_OK) {
+        return status;
+    }
+
+    if (!cs_trace_file_set_offset(file, keyframe.offset)) {
+        return CS_TRACE_FILE_FAILED;
+    }
+    if (fgetc(file) != CS_TRACE_FILE_TAG_KEYFRAME || !cs_trace_file_get_keyframe(file, state, &current)) {
+        return CS_TRACE_FILE_INVALID;
+    }
+
+    /* Replay forward, one entry per instruction */
+    while (current < instruction) {
+        tag = fgetc(file);
+        if (tag == CS_TRACE_FILE_TAG_INDEX) {
+            return CS_TRACE_FILE_OUT_OF_RANGE;
+        }
+        if (tag == CS_TRACE_FILE_TAG_KEYFRAME) {
+            if (!cs_trace_file_get_keyframe(file, state, &current)) {
+                return CS_TRACE_FILE_INVALID;
+            }
+        } else if (tag == EOF || !cs_trace_file_get_delta(file, tag, state, rom)) {
+            return CS_TRACE_FILE_INVALID;
+        } else {
+            current++;
+        }
+    }
+    return CS_TRACE_FILE_OK;
+}
+
+int cs_trace_file_seek(cs_machine *cs, char const *path, unsigned long long instruction) {
+    FILE               *file;
+    unsigned short      rom[CS_ROM_SIZE];
+    cs_trace_file_state state;
+    int                 status;
+
+    file = fopen(path, "rb");
+    if (!file) {
+        return CS_TRACE_FILE_FAILED;
+    }
+    status = cs_trace_file_replay(file, cs, instruction, rom, &state);
+    fclose(file);
+    if (status != CS_TRACE_FILE_OK) {
+        return status;
+    }
+
+    memcpy(cs->memory.rom, rom, sizeof rom);
+    cs_accesses_analyze(cs);
+    cs_loops_restart(cs);
+    memcpy(cs->memory.ram, state.ram, CS_RAM_SIZE);
+    cs_trace_file_unpack_registers(cs, state.registers);
+    cs->cycles              = state.cycles;
+    cs->instructions        = state.instructions;
+    cs->stopped             = state.stopped;
+    cs->microop             = 0;
+    cs->signals             = cs->opcodes[CS_GET_OPCODE(cs->registers.ir)].signals[0];
+    cs->instruction_address = cs->registers.pc - 1;
+
+    if (cs->interrupts) {
+        cs_interrupts_reset(cs);
+    }
+    if (cs->profiler) {
+        cs_profiler_restart(cs);
+    }
+    if (cs->call_graph) {
+        cs_call_graph_restart(cs);
+    }
+    return CS_TRACE_FILE_OK;
+}
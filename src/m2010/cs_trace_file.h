@@ -0,0 +1,81 @@
+/** @file cs_trace_file.h */
+
+#ifndef CS_TRACE_FILE_H
+#define CS_TRACE_FILE_H
+
+#include <stdio.h>
+
+#include "cs.h"
+
+/*
+ * Trace file layout. Integers are unsigned LEB128 varints unless noted.
+ *   Header:   "CSTR", version byte, platform byte, keyframe interval,
+ *             ROM (CS_ROM_SIZE little endian words)
+ *   Entries:  keyframes and deltas, one delta per completed instruction
+ *   Index:    CS_TRACE_FILE_TAG_INDEX, amount of keyframes, and the
+ *             instruction number and file offset of each one
+ *   Trailer:  file offset of the index (8 bytes, little endian), "CSTX"
+ *
+ * A keyframe is CS_TRACE_FILE_TAG_KEYFRAME, the instruction number, the
+ * cycle and instruction counters of the machine, the registers (ir little
+ * endian, then one byte each), the stop signal and the RAM.
+ *
+ * A delta is a tag byte made of CS_TRACE_FILE_DELTA_* flags, the cycles
+ * elapsed (the instruction counter advances by one), and then the parts flagged by the tag:
+ *   - REGISTERS: mask of the register bytes (in keyframe order) that
+ *     differ from their expected value, followed by those bytes. PC is
+ *     expected to advance by one, and IR to hold the ROM word before PC
+ *   - RAM: amount of RAM writes, followed by address and value bytes
+ *   - STOPPED: the machine stopped
+ */
+#define CS_TRACE_FILE_MAGIC           "CSTR"
+#define CS_TRACE_FILE_INDEX_MAGIC     "CSTX"
+#define CS_TRACE_FILE_VERSION         2
+#define CS_TRACE_FILE_TAG_KEYFRAME    0x80
+#define CS_TRACE_FILE_TAG_INDEX       0x81
+#define CS_TRACE_FILE_REGISTERS       16
+#define CS_TRACE_FILE_REGISTER_PC     11
+#define CS_TRACE_FILE_DELTA_REGISTERS (1u << 0)
+#define CS_TRACE_FILE_DELTA_RAM       (1u << 1)
+#define CS_TRACE_FILE_DELTA_STOPPED   (1u << 2)
+
+typedef struct cs_trace_file          cs_trace_file;
+typedef struct cs_trace_file_keyframe cs_trace_file_keyframe;
+
+/** @brief Position of a keyframe */
+struct cs_trace_file_keyframe {
+    unsigned long long instruction;
+    unsigned long long offset;
+};
+
+/** @brief Streaming trace writer */
+struct cs_trace_file {
+    FILE *file;
+    /** @brief Current file offset */
+    unsigned long long offset;
+    /** @brief Whether any write failed */
+    bool failed;
+    /** @brief Instructions between keyframes */
+    unsigned long keyframe_interval;
+    /** @brief Completed instructions since the trace started */
+    unsigned long long instruction;
+    /** @brief Keyframe index, written when the trace is closed */
+    cs_trace_file_keyframe *keyframes;
+    size_t                  keyframes_amount;
+    size_t                  keyframes_capacity;
+    /** @brief State at the last written entry */
+    unsigned char      registers[CS_TRACE_FILE_REGISTERS];
+    unsigned char      ram[CS_RAM_SIZE];
+    unsigned long long cycles;
+    unsigned char      stopped;
+};
+
+/**
+ * @brief Appends the delta of the instruction that has just been completed
+ *      (and a keyframe if the interval elapsed). Must be called after the
+ *      next instruction is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_trace_file_record(cs_machine *cs);
+
+#endif /* CS_TRACE_FILE_H */
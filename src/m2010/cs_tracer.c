@@ -0,0 +1,121 @@
+/** @file cs_tracer.c */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_tracer.h"
+
+/* Hosts rely on the records being tightly packed */
+typedef char cs_tracer_record_check_size[sizeof(cs_tracer_record) == 8 ? 1 : -1];
+
+void cs_tracer_access(cs_machine *cs, size_t offset, unsigned char content) {
+    cs->tracer->address = (unsigned char)offset;
+    cs->tracer->value   = content;
+}
+
+void cs_tracer_record_instruction(cs_machine *cs) {
+    cs_tracer        *tracer = cs->tracer;
+    cs_tracer_record *record = &tracer->records[tracer->head++ & tracer->mask];
+
+    record->ir    = cs->registers.ir;
+    record->pc    = cs->instruction_address;
+    record->sr    = cs->registers.sr;
+    record->flags = tracer->access_flags[CS_GET_OPCODE(cs->registers.ir)];
+    /* Every instruction flagged accesses memory once, so the last access is its own */
+    record->address  = record->flags ? tracer->address : 0;
+    record->value    = record->flags ? tracer->value : 0;
+    record->reserved = 0;
+}
+
+bool cs_tracer_enable(cs_machine *cs, size_t capacity) {
+#ifdef CS_TRACER
+    cs_tracer *tracer;
+    size_t     rounded_capacity = 1;
+    size_t     opcode;
+    size_t     microop;
+    cs_signals signals;
+
+    /* No power of two above it fits a size_t, nor can its records be allocated */
+    if (capacity > SIZE_MAX / 2 + 1 || capacity > SIZE_MAX / sizeof *tracer->records) {
+        return false;
+    }
+    while (rounded_capacity < capacity) {
+        rounded_capacity <<= 1;
+    }
+
+    tracer = malloc(sizeof *tracer);
+    if (!tracer) {
+        return false;
+    }
+
+    tracer->records = malloc(sizeof *tracer->records * rounded_capacity);
+    if (!tracer->records) {
+        free(tracer);
+        return false;
+    }
+
+    tracer->mask    = rounded_capacity - 1;
+    tracer->head    = 0;
+    tracer->address = 0;
+    tracer->value   = 0;
+    for (opcode = 0; opcode < CS_INS_LENGTH; opcode++) {
+        signals = 0;
+        for (microop = 0; microop < 5; microop++) {
+            signals |= cs->opcodes[opcode].signals[microop];
+        }
+        tracer->access_flags[opcode] = (signals & CS_SIGNAL_RMEM ? CS_TRACER_READ : 0) |
+                                       (signals & CS_SIGNAL_WMEM ? CS_TRACER_WRITE : 0);
+    }
+
+    cs_tracer_disable(cs);
+    cs->tracer = tracer;
+    return true;
+#else
+    (void)cs;
+    (void)capacity;
+    return false;
+#endif /* CS_TRACER */
+}
+
+void cs_tracer_disable(cs_machine *cs) {
+    if (cs->tracer) {
+        free(cs->tracer->records);
+        free(cs->tracer);
+        cs->tracer = 0;
+    }
+}
+
+void cs_tracer_clear(cs_machine *cs) {
+    if (cs->tracer) {
+        cs->tracer->head = 0;
+    }
+}
+
+unsigned long long cs_tracer_get_total(cs_machine const *cs) {
+    return cs->tracer ? cs->tracer->head : 0;
+}
+
+size_t cs_tracer_get_records(cs_machine const *cs, cs_tracer_record *records, size_t max_records) {
+    cs_tracer const   *tracer = cs->tracer;
+    unsigned long long first;
+    size_t             amount;
+    size_t             i;
+
+    if (!tracer) {
+        return 0;
+    }
+
+    /* Only the last capacity records are still in the ring buffer */
+    amount = tracer->head < tracer->mask + 1 ? tracer->head : tracer->mask + 1;
+    if (amount > max_records) {
+        amount = max_records;
+    }
+
+    first = tracer->head - amount;
+    for (i = 0; i < amount; i++) {
+        records[i] = tracer->records[(first + i) & tracer->mask];
+    }
+    return amount;
+}
@@ -0,0 +1,43 @@
+/** @file cs_tracer.h */
+
+#ifndef CS_TRACER_H
+#define CS_TRACER_H
+
+#include "cs.h"
+#include "cs_instructions.h"
+
+typedef struct cs_tracer        cs_tracer;
+typedef struct cs_tracer_record cs_tracer_record;
+
+/** @brief Execution trace ring buffer */
+struct cs_tracer {
+    /** @brief Ring buffer of records, overwriting the oldest ones when full */
+    cs_tracer_record *records;
+    /** @brief Ring buffer capacity minus one (capacity is a power of two) */
+    size_t mask;
+    /** @brief Total amount of records written */
+    unsigned long long head;
+    /** @brief Memory access flags by opcode, derived from its signals */
+    unsigned char access_flags[CS_INS_LENGTH];
+    /** @brief Address and byte of the last RAM or I/O access */
+    unsigned char address;
+    unsigned char value;
+};
+
+/**
+ * @brief Notifies the tracer of a RAM or I/O access, so that the record of
+ *      the instruction holds the byte transferred rather than the RAM contents
+ * @param cs Pointer to the emulation instance
+ * @param offset Address accessed
+ * @param content Value read or written
+ */
+void cs_tracer_access(cs_machine *cs, size_t offset, unsigned char content);
+
+/**
+ * @brief Appends a record of the instruction that has just been completed.
+ *      Must be called before the next instruction is fetched
+ * @param cs Pointer to the emulation instance
+ */
+void cs_tracer_record_instruction(cs_machine *cs);
+
+#endif /* CS_TRACER_H */
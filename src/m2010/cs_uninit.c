@@ -0,0 +1,118 @@
+/** @file cs_uninit.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_report.h"
+
+#include "cs_uninit.h"
+
+void cs_uninit_write(cs_machine *cs, size_t offset) {
+    BIT_SET(cs->uninit->initialized, offset);
+}
+
+void cs_uninit_read_check(cs_machine *cs, size_t offset) {
+    cs_uninit      *uninit = cs->uninit;
+    cs_uninit_read *reads;
+    size_t          capacity;
+
+    if (BIT_TEST(uninit->initialized, offset) ||
+        BIT_TEST(uninit->reported[cs->instruction_address], offset)) {
+        return;
+    }
+
+    if (uninit->reads_amount == uninit->reads_capacity) {
+        capacity = uninit->reads_capacity ? uninit->reads_capacity * 2 : 16;
+        reads    = realloc(uninit->reads, sizeof *reads * capacity);
+        if (!reads) {
+            return;
+        }
+        uninit->reads          = reads;
+        uninit->reads_capacity = capacity;
+    }
+    BIT_SET(uninit->reported[cs->instruction_address], offset);
+    uninit->reads[uninit->reads_amount].instruction_address = cs->instruction_address;
+    uninit->reads[uninit->reads_amount].address             = offset;
+    uninit->reads[uninit->reads_amount].instruction         = cs->instructions;
+    uninit->reads_amount++;
+}
+
+void cs_uninit_restart(cs_machine *cs) {
+    memset(cs->uninit->initialized, 0, sizeof cs->uninit->initialized);
+}
+
+bool cs_uninit_enable(cs_machine *cs) {
+    if (cs->uninit) {
+        return true;
+    }
+
+    cs->uninit = calloc(1, sizeof *cs->uninit);
+    return cs->uninit != 0;
+}
+
+void cs_uninit_disable(cs_machine *cs) {
+    if (cs->uninit) {
+        free(cs->uninit->reads);
+        free(cs->uninit);
+        cs->uninit = 0;
+    }
+}
+
+cs_uninit_read const *cs_uninit_get_reads(cs_machine const *cs, size_t *amount) {
+    if (!cs->uninit) {
+        *amount = 0;
+        return 0;
+    }
+
+    *amount = cs->uninit->reads_amount;
+    return cs->uninit->reads;
+}
+
+char *cs_uninit_report(cs_machine const *cs, struct cs_as_machine_code const *machine_code, char const *source) {
+    cs_report_text        text = {0, 0, 0, false};
+    cs_uninit_read const *read;
+    char const          **lines;
+    size_t               *line_lengths;
+    size_t                lines_amount;
+    size_t                line;
+    size_t                i;
+
+    if (!cs->uninit || !machine_code || !source) {
+        return 0;
+    }
+
+    lines_amount = cs_report_split_lines(source, &lines, &line_lengths);
+    if (!lines_amount) {
+        return 0;
+    }
+
+    cs_report_printf(&text, "Uninitialized reads: %" PRI_SIZET "\n", cs->uninit->reads_amount);
+    if (cs->uninit->reads_amount) {
+        cs_report_printf(&text, "\n%4s  %4s  %20s %6s  %s\n", "ROM", "RAM", "instruction", "line", "source");
+    }
+    for (i = 0; i < cs->uninit->reads_amount; i++) {
+        read = &cs->uninit->reads[i];
+        cs_report_printf(&text, HEX8_X_FORMAT "  " HEX8_X_FORMAT "  %20llu ", read->instruction_address, read->address,
+                         read->instruction);
+
+        line = read->instruction_address < machine_code->machine_instructions_amount
+                   ? machine_code->matching_source_assembly_lines[read->instruction_address]
+                   : 0;
+        if (line && line <= lines_amount) {
+            cs_report_printf(&text, "%6" PRI_SIZET "  %.*s\n", line, (int)line_lengths[line - 1], lines[line - 1]);
+        } else {
+            cs_report_printf(&text, "%6s\n", "");
+        }
+    }
+
+    free(lines);
+    free(line_lengths);
+
+    return cs_report_finish(&text);
+}
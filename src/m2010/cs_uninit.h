@@ -0,0 +1,44 @@
+/** @file cs_uninit.h */
+
+#ifndef CS_UNINIT_H
+#define CS_UNINIT_H
+
+#include "cs.h"
+
+typedef struct cs_uninit      cs_uninit;
+typedef struct cs_uninit_read cs_uninit_read;
+
+/** @brief Shadow memory of initialized RAM addresses */
+struct cs_uninit {
+    /** @brief RAM addresses written since the RAM was last cleared */
+    unsigned char initialized[CS_RAM_SIZE / 8];
+    /** @brief RAM addresses already reported by each instruction address */
+    unsigned char reported[CS_ROM_SIZE][CS_RAM_SIZE / 8];
+    /** @brief Reported reads, in the order they first happened */
+    cs_uninit_read *reads;
+    size_t          reads_amount;
+    size_t          reads_capacity;
+};
+
+/**
+ * @brief Marks a RAM address as initialized
+ * @param cs Pointer to the emulation instance
+ * @param offset Address written
+ */
+void cs_uninit_write(cs_machine *cs, size_t offset);
+
+/**
+ * @brief Reports a read of a RAM address never written before by the
+ *      instruction being executed
+ * @param cs Pointer to the emulation instance
+ * @param offset Address read
+ */
+void cs_uninit_read_check(cs_machine *cs, size_t offset);
+
+/**
+ * @brief Marks every RAM address as uninitialized, after the RAM is cleared
+ * @param cs Pointer to the emulation instance
+ */
+void cs_uninit_restart(cs_machine *cs);
+
+#endif /* CS_UNINIT_H */
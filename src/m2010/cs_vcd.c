@@ -0,0 +1,267 @@
+/** @file cs_vcd.c */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif /* _MSC_VER */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/asm2010.h"
+
+#include "cs_platforms.h"
+
+#include "cs_vcd.h"
+
+/* Identifier codes are printable characters, one per variable */
+#define CS_VCD_ID_FIRST_SIGNAL '!'
+#define CS_VCD_ID_ALUOP        'A'
+#define CS_VCD_ID_PC           'B'
+#define CS_VCD_ID_IR           'C'
+#define CS_VCD_ID_AC           'D'
+#define CS_VCD_ID_MAR          'E'
+#define CS_VCD_ID_MDR          'F'
+
+/** @brief One-bit control signal */
+struct cs_vcd_signal {
+    char const   *name;
+    unsigned long mask;
+};
+typedef struct cs_vcd_signal cs_vcd_signal;
+
+static cs_vcd_signal const cs_vcd_signals[] = {
+    {"WMAR", CS_SIGNAL_WMAR}, {"WMDR", CS_SIGNAL_WMDR}, {"IOMDR", CS_SIGNAL_IOMDR}, {"WMEM", CS_SIGNAL_WMEM},
+    {"RMEM", CS_SIGNAL_RMEM}, {"WIR", CS_SIGNAL_WIR},   {"WPC", CS_SIGNAL_WPC},     {"RPC", CS_SIGNAL_RPC},
+    {"CPC", CS_SIGNAL_CPC},   {"IPC", CS_SIGNAL_IPC},   {"ISP", CS_SIGNAL_ISP},     {"DSP", CS_SIGNAL_DSP},
+    {"CSP", CS_SIGNAL_CSP},   {"RSP", CS_SIGNAL_RSP},   {"INM", CS_SIGNAL_INM},     {"SRW", CS_SIGNAL_SRW},
+    {"WAC", CS_SIGNAL_WAC},   {"RAC", CS_SIGNAL_RAC},   {"WREG", CS_SIGNAL_WREG},
+};
+
+/* CS3 has separate ALU control signals instead of an operation field */
+static cs_vcd_signal const cs_vcd_cs3_signals[] = {
+    {"ALU_TB", CS3_SIGNAL_ALU_TB},
+    {"ALU_TA", CS3_SIGNAL_ALU_TA},
+    {"ALU_R", CS3_SIGNAL_ALU_R},
+    {"ALU_S", CS3_SIGNAL_ALU_S},
+};
+
+#define CS_VCD_SIGNALS     (sizeof cs_vcd_signals / sizeof *cs_vcd_signals)
+#define CS_VCD_CS3_SIGNALS (sizeof cs_vcd_cs3_signals / sizeof *cs_vcd_cs3_signals)
+
+static void cs_vcd_flush(cs_vcd *vcd) {
+    if (fwrite(vcd->buffer, 1, vcd->buffer_length, vcd->file) != vcd->buffer_length) {
+        vcd->failed = true;
+    }
+    vcd->buffer_length = 0;
+}
+
+static void cs_vcd_put(cs_vcd *vcd, char const *text) {
+    size_t length = strlen(text);
+
+    if (vcd->buffer_length + length > CS_VCD_BUFFER_SIZE) {
+        cs_vcd_flush(vcd);
+    }
+    memcpy(vcd->buffer + vcd->buffer_length, text, length);
+    vcd->buffer_length += length;
+}
+
+/* Value changes reserve CS_VCD_MAX_LINE bytes and write into the buffer directly */
+static char *cs_vcd_reserve(cs_vcd *vcd) {
+    if (vcd->buffer_length + CS_VCD_MAX_LINE > CS_VCD_BUFFER_SIZE) {
+        cs_vcd_flush(vcd);
+    }
+    return vcd->buffer + vcd->buffer_length;
+}
+
+static void cs_vcd_put_bit(cs_vcd *vcd, char id, bool value) {
+    char *line = cs_vcd_reserve(vcd);
+
+    line[0] = value ? '1' : '0';
+    line[1] = id;
+    line[2] = '\n';
+    vcd->buffer_length += 3;
+}
+
+static void cs_vcd_put_vector(cs_vcd *vcd, char id, unsigned int value, size_t width) {
+    char  *line   = cs_vcd_reserve(vcd);
+    size_t length = 0;
+
+    line[length++] = 'b';
+    while (width--) {
+        line[length++] = (value >> width) & 1u ? '1' : '0';
+    }
+    line[length++] = ' ';
+    line[length++] = id;
+    line[length++] = '\n';
+    vcd->buffer_length += length;
+}
+
+static void cs_vcd_put_time(cs_vcd *vcd, unsigned long long time) {
+    char  *line = cs_vcd_reserve(vcd);
+    char   digits[20];
+    size_t digits_length = 0;
+    size_t length        = 0;
+
+    do {
+        digits[digits_length++] = '0' + time % 10;
+        time /= 10;
+    } while (time);
+
+    line[length++] = '#';
+    while (digits_length) {
+        line[length++] = digits[--digits_length];
+    }
+    line[length++] = '\n';
+    vcd->buffer_length += length;
+}
+
+static void cs_vcd_put_var(cs_vcd *vcd, char id, size_t width, char const *name) {
+    char line[64];
+
+    if (width > 1) {
+        sprintf(line, "$var wire %u %c %s [%u:0] $end\n", (unsigned int)width, id, name, (unsigned int)width - 1);
+    } else {
+        sprintf(line, "$var wire 1 %c %s $end\n", id, name);
+    }
+    cs_vcd_put(vcd, line);
+}
+
+/**
+ * @brief Writes the values of the variables that differ from the last
+ *      record, or every value if requested
+ * @param cs Pointer to the emulation instance
+ * @param is_full Whether every value is written
+ */
+static void cs_vcd_put_changes(cs_machine *cs, bool is_full) {
+    cs_vcd      *vcd     = cs->vcd;
+    unsigned int changed = is_full ? ~0u : cs->signals ^ vcd->signals;
+    size_t       i;
+
+    for (i = 0; i < CS_VCD_SIGNALS; i++) {
+        if (changed & cs_vcd_signals[i].mask) {
+            cs_vcd_put_bit(vcd, CS_VCD_ID_FIRST_SIGNAL + i, !!(cs->signals & cs_vcd_signals[i].mask));
+        }
+    }
+    if (CS_PLATFORM_BASE(cs->platform) == CS_PLATFORM_2010) {
+        if (changed & CS2010_SIGNALS_ALUOP) {
+            cs_vcd_put_vector(vcd, CS_VCD_ID_ALUOP, (cs->signals & CS2010_SIGNALS_ALUOP) / CS2010_SIGNAL_ALUOP0, 4);
+        }
+    } else {
+        for (i = 0; i < CS_VCD_CS3_SIGNALS; i++) {
+            if (changed & cs_vcd_cs3_signals[i].mask) {
+                cs_vcd_put_bit(vcd, CS_VCD_ID_FIRST_SIGNAL + CS_VCD_SIGNALS + i,
+                               !!(cs->signals & cs_vcd_cs3_signals[i].mask));
+            }
+        }
+    }
+
+    if (is_full || cs->registers.pc != vcd->pc) {
+        cs_vcd_put_vector(vcd, CS_VCD_ID_PC, cs->registers.pc, 8);
+    }
+    if (is_full || cs->registers.ir != vcd->ir) {
+        cs_vcd_put_vector(vcd, CS_VCD_ID_IR, cs->registers.ir, 16);
+    }
+    if (is_full || cs->registers.ac != vcd->ac) {
+        cs_vcd_put_vector(vcd, CS_VCD_ID_AC, cs->registers.ac, 8);
+    }
+    if (is_full || cs->registers.mar != vcd->mar) {
+        cs_vcd_put_vector(vcd, CS_VCD_ID_MAR, cs->registers.mar, 8);
+    }
+    if (is_full || cs->registers.mdr != vcd->mdr) {
+        cs_vcd_put_vector(vcd, CS_VCD_ID_MDR, cs->registers.mdr, 8);
+    }
+
+    vcd->signals = cs->signals;
+    vcd->pc      = cs->registers.pc;
+    vcd->ir      = cs->registers.ir;
+    vcd->ac      = cs->registers.ac;
+    vcd->mar     = cs->registers.mar;
+    vcd->mdr     = cs->registers.mdr;
+}
+
+void cs_vcd_record(cs_machine *cs) {
+    cs_vcd *vcd = cs->vcd;
+
+    /* A reset restarts the cycle counter, but the dump time keeps going */
+    vcd->time += cs->cycles >= vcd->cycles ? cs->cycles - vcd->cycles : cs->cycles;
+    vcd->cycles = cs->cycles;
+
+    if (cs->signals == vcd->signals && cs->registers.pc == vcd->pc && cs->registers.ir == vcd->ir &&
+        cs->registers.ac == vcd->ac && cs->registers.mar == vcd->mar && cs->registers.mdr == vcd->mdr) {
+        return;
+    }
+
+    if (vcd->time != vcd->dumped_time) {
+        cs_vcd_put_time(vcd, vcd->time);
+        vcd->dumped_time = vcd->time;
+    }
+    cs_vcd_put_changes(cs, false);
+}
+
+bool cs_vcd_open(cs_machine *cs, char const *path) {
+    cs_vcd *vcd;
+    size_t  i;
+
+    cs_vcd_close(cs);
+    vcd = calloc(1, sizeof *vcd);
+    if (!vcd) {
+        return false;
+    }
+
+    vcd->file = fopen(path, "wb");
+    if (!vcd->file) {
+        free(vcd);
+        return false;
+    }
+    vcd->cycles = cs->cycles;
+    cs->vcd     = vcd;
+
+    cs_vcd_put(vcd, "$version ASM2010 $end\n");
+    cs_vcd_put(vcd, "$comment One time unit per clock cycle $end\n");
+    cs_vcd_put(vcd, "$timescale 1 ns $end\n");
+    cs_vcd_put(vcd, CS_PLATFORM_BASE(cs->platform) == CS_PLATFORM_2010 ? "$scope module CS2010 $end\n"
+                                                                          : "$scope module CS3 $end\n");
+    for (i = 0; i < CS_VCD_SIGNALS; i++) {
+        cs_vcd_put_var(vcd, CS_VCD_ID_FIRST_SIGNAL + i, 1, cs_vcd_signals[i].name);
+    }
+    if (CS_PLATFORM_BASE(cs->platform) == CS_PLATFORM_2010) {
+        cs_vcd_put_var(vcd, CS_VCD_ID_ALUOP, 4, "ALUOP");
+    } else {
+        for (i = 0; i < CS_VCD_CS3_SIGNALS; i++) {
+            cs_vcd_put_var(vcd, CS_VCD_ID_FIRST_SIGNAL + CS_VCD_SIGNALS + i, 1, cs_vcd_cs3_signals[i].name);
+        }
+    }
+    cs_vcd_put_var(vcd, CS_VCD_ID_PC, 8, "PC");
+    cs_vcd_put_var(vcd, CS_VCD_ID_IR, 16, "IR");
+    cs_vcd_put_var(vcd, CS_VCD_ID_AC, 8, "AC");
+    cs_vcd_put_var(vcd, CS_VCD_ID_MAR, 8, "MAR");
+    cs_vcd_put_var(vcd, CS_VCD_ID_MDR, 8, "MDR");
+    cs_vcd_put(vcd, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+    cs_vcd_put_changes(cs, true);
+    cs_vcd_put(vcd, "$end\n");
+
+    cs_vcd_flush(vcd);
+    if (vcd->failed) {
+        cs_vcd_close(cs);
+        return false;
+    }
+    return true;
+}
+
+bool cs_vcd_close(cs_machine *cs) {
+    cs_vcd *vcd = cs->vcd;
+    bool    success;
+
+    if (!vcd) {
+        return false;
+    }
+
+    cs_vcd_flush(vcd);
+    success = !vcd->failed;
+    if (fclose(vcd->file)) {
+        success = false;
+    }
+    free(vcd);
+    cs->vcd = 0;
+    return success;
+}
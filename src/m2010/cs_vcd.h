@@ -0,0 +1,47 @@
+/** @file cs_vcd.h */
+
+#ifndef CS_VCD_H
+#define CS_VCD_H
+
+#include <stdio.h>
+
+#include "cs.h"
+
+/** @brief Size of the output buffer */
+#define CS_VCD_BUFFER_SIZE 65536
+/** @brief Longest line written for a value change */
+#define CS_VCD_MAX_LINE 32
+
+typedef struct cs_vcd cs_vcd;
+
+/** @brief Streaming Value Change Dump writer */
+struct cs_vcd {
+    FILE *file;
+    /** @brief Whether any write failed */
+    bool failed;
+    /** @brief Output not written to the file yet */
+    char   buffer[CS_VCD_BUFFER_SIZE];
+    size_t buffer_length;
+    /** @brief Dump time, one unit per clock cycle. Resets don't make it go back */
+    unsigned long long time;
+    /** @brief Time of the last timestamp written */
+    unsigned long long dumped_time;
+    /** @brief Cycle counter at the last record */
+    unsigned long long cycles;
+    /** @brief Values at the last record */
+    unsigned int   signals;
+    unsigned short ir;
+    unsigned char  pc;
+    unsigned char  ac;
+    unsigned char  mar;
+    unsigned char  mdr;
+};
+
+/**
+ * @brief Appends the values that changed in the microoperation that has
+ *      just been performed
+ * @param cs Pointer to the emulation instance
+ */
+void cs_vcd_record(cs_machine *cs);
+
+#endif /* CS_VCD_H */
@@ -18,6 +18,11 @@
 
 #define BIT_AT(a, n) (!!(a & (1u << n)))
 
+/* Bitmaps of bytes, with a bit for each index */
+#define BIT_SET(bitmap, index)   ((bitmap)[(index) / 8] |= 1u << ((index) % 8))
+#define BIT_CLEAR(bitmap, index) ((bitmap)[(index) / 8] &= ~(1u << ((index) % 8)))
+#define BIT_TEST(bitmap, index)  ((bitmap)[(index) / 8] & (1u << ((index) % 8)))
+
 #ifdef _WIN32
 #ifdef _WIN64
 #define PRI_SIZET PRIu64